@@ -1,8 +1,19 @@
-#include <iostream>
+#include <stdio.h>
+#include <string.h>
 
 #include "Cube.h"
+#include "Lanes.h"
+#include "Permutation.h"
 #include "Util.h"
 
+constexpr uint64_t Cube::upMask;
+constexpr uint64_t Cube::rightMask;
+constexpr uint64_t Cube::downMask;
+constexpr uint64_t Cube::leftMask;
+constexpr uint64_t Cube::middleColMask;
+constexpr uint64_t Cube::middleRowMask;
+constexpr uint8_t Cube::NUM_STICKERS;
+
 Cube::Cube() { reset(); }
 
 /**
@@ -50,6 +61,274 @@ bool Cube::isSolved()
 	return true;
 }
 
+/**
+ * Find the parity of the given permutation, by counting the pairs of
+ * pieces that are out of order.
+ */
+bool permutationParity(const uint8_t* permutation, uint8_t count)
+{
+	bool parity = false;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		for (uint8_t j = i + 1; j < count; j++)
+			parity ^= permutation[i] > permutation[j];
+	}
+	return parity;
+}
+
+/**
+ * Get the colors of the corner with the given sticker on the up or
+ * down face, going clockwise around it from that sticker.
+ */
+void cornerColors(Cube& cube, Cube::LOCATION corner, uint8_t colors[3])
+{
+	std::pair<Cube::LOCATION, Cube::LOCATION> sides = cube.getAdjacentCorner(corner);
+	// the first side is clockwise from the up or down face on every other corner
+	bool firstClockwise = corner.idx % 4 == 2;
+	colors[0] = (uint8_t)cube.getSticker(corner);
+	colors[1] = (uint8_t)cube.getSticker(firstClockwise ? sides.first : sides.second);
+	colors[2] = (uint8_t)cube.getSticker(firstClockwise ? sides.second : sides.first);
+}
+
+/**
+ * Check if the cube can be solved.
+ *
+ * With the colors normalized, each piece belongs where its colors' faces
+ * meet, and a corner's colors must go around it in the same order as
+ * they do there. A corner is twisted by the turns it takes to line its
+ * colors up with that order, and an edge is flipped
+ * if its up or down color (or front or back color, for the middle
+ * layer) isn't on that face. Moves keep the twists adding up to a
+ * multiple of 3, the flips even, and the parities of the corners' and
+ * edges' permutations the same.
+ */
+bool Cube::isSolvable() const
+{
+	Cube cube = *this;
+	uint8_t centers = 0;
+	for (uint8_t f = 0; f < 6; f++)
+	{
+		uint8_t color = (uint8_t)cube.getCenter((FACE)f);
+		if (color == (uint8_t)COLOR::EMPTY || color > (uint8_t)COLOR::GREEN || (centers >> color) & 1)
+			return false;
+		centers |= 1 << color;
+	}
+	cube.normalizeColors();
+	Cube solved;
+
+	// each corner by its sticker on the up or down face
+	static const LOCATION corners[8] = {
+		{ FACE::UP, 0 }, { FACE::UP, 2 }, { FACE::UP, 4 }, { FACE::UP, 6 },
+		{ FACE::DOWN, 0 }, { FACE::DOWN, 2 }, { FACE::DOWN, 4 }, { FACE::DOWN, 6 }
+	};
+	uint8_t permutation[12];
+	uint16_t placed = 0;
+	uint8_t twist = 0;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		uint8_t colors[3];
+		cornerColors(cube, corners[i], colors);
+		permutation[i] = 8;
+		for (uint8_t j = 0; j < 8 && permutation[i] == 8; j++)
+		{
+			uint8_t home[3];
+			cornerColors(solved, corners[j], home);
+			// the same colors in the same clockwise order, turned some number of times
+			for (uint8_t turns = 0; turns < 3; turns++)
+			{
+				if (colors[turns] == home[0] && colors[(turns + 1) % 3] == home[1] && colors[(turns + 2) % 3] == home[2])
+				{
+					permutation[i] = j;
+					twist += turns;
+				}
+			}
+		}
+		if (permutation[i] == 8 || (placed >> permutation[i]) & 1)
+			return false;
+		placed |= 1 << permutation[i];
+	}
+	bool cornerParity = permutationParity(permutation, 8);
+
+	// each edge by its sticker on the up or down face, or the front or back
+	static const LOCATION edges[12] = {
+		{ FACE::UP, 1 }, { FACE::UP, 3 }, { FACE::UP, 5 }, { FACE::UP, 7 },
+		{ FACE::DOWN, 1 }, { FACE::DOWN, 3 }, { FACE::DOWN, 5 }, { FACE::DOWN, 7 },
+		{ FACE::FRONT, 3 }, { FACE::FRONT, 7 }, { FACE::BACK, 3 }, { FACE::BACK, 7 }
+	};
+	placed = 0;
+	uint8_t flips = 0;
+	for (uint8_t i = 0; i < 12; i++)
+	{
+		uint8_t colors[2] = { (uint8_t)cube.getSticker(edges[i]), (uint8_t)cube.getSticker(cube.getAdjacentEdge(edges[i])) };
+		uint8_t faces = (1 << colors[0]) | (1 << colors[1]);
+		permutation[i] = 12;
+		for (uint8_t j = 0; j < 12; j++)
+		{
+			if (faces == ((1 << (uint8_t)solved.getSticker(edges[j])) |
+				(1 << (uint8_t)solved.getSticker(solved.getAdjacentEdge(edges[j])))))
+				permutation[i] = j;
+		}
+		if (permutation[i] == 12 || (placed >> permutation[i]) & 1)
+			return false;
+		placed |= 1 << permutation[i];
+
+		// the edge's up or down color if it has one, otherwise its front or back
+		uint8_t primary = colors[0] <= (uint8_t)COLOR::YELLOW || colors[1] <= (uint8_t)COLOR::YELLOW
+			? (uint8_t)COLOR::YELLOW : (uint8_t)COLOR::ORANGE;
+		flips += colors[0] > primary;
+	}
+
+	return twist % 3 == 0 && flips % 2 == 0 && cornerParity == permutationParity(permutation, 12);
+}
+
+/**
+ * Check if two cubes are in exactly the same state,
+ * including the position of the centers.
+ */
+bool Cube::operator==(const Cube& other) const
+{
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		if (stickers[i] != other.stickers[i])
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Order cubes by their state, comparing each of the 7 integers in turn.
+ */
+bool Cube::operator<(const Cube& other) const
+{
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		if (stickers[i] != other.stickers[i])
+			return stickers[i] < other.stickers[i];
+	}
+	return false;
+}
+
+/**
+ * Get a 64-bit hash of the cube state.
+ *
+ * Each of the 7 integers is mixed in turn so that states
+ * differing by only a few stickers still spread out evenly.
+ */
+uint64_t Cube::hash() const
+{
+	uint64_t h = 0x9e3779b97f4a7c15;
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		h = (h ^ stickers[i]) * 0xbf58476d1ce4e5b9;
+		h ^= h >> 31;
+	}
+	return h;
+}
+
+/**
+ * Pack the state into 3 words, 3 bits a sticker.
+ *
+ * Each word holds two faces, 24 bits each in sticker order, followed by
+ * their two centers, which leaves its top 10 bits clear.
+ */
+void Cube::pack(uint64_t words[PACKED_WORDS]) const
+{
+	for (uint8_t w = 0; w < PACKED_WORDS; w++)
+	{
+		uint64_t word = 0;
+		for (uint8_t f = 0; f < 2; f++)
+		{
+			uint8_t face = w * 2 + f;
+			for (uint8_t b = 0; b < 8; b++)
+				word |= ((stickers[face] >> (b * 8)) & 7) << (f * 24 + b * 3);
+			word |= ((stickers[6] >> ((7 - face) * 8)) & 7) << (48 + f * 3);
+		}
+		words[w] = word;
+	}
+}
+
+/**
+ * Unpack a state packed into 3 words, returning false (and leaving the
+ * cube as it was) if a sticker isn't a valid color.
+ */
+bool Cube::unpack(const uint64_t words[PACKED_WORDS])
+{
+	uint64_t unpacked[7] = { 0, 0, 0, 0, 0, 0, 0 };
+	for (uint8_t w = 0; w < PACKED_WORDS; w++)
+	{
+		for (uint8_t f = 0; f < 2; f++)
+		{
+			uint8_t face = w * 2 + f;
+			for (uint8_t b = 0; b < 9; b++)
+			{
+				// the ninth sticker is the center
+				uint64_t color = (words[w] >> (b < 8 ? f * 24 + b * 3 : 48 + f * 3)) & 7;
+				if (color == (uint64_t)COLOR::EMPTY || color > (uint64_t)COLOR::GREEN)
+					return false;
+				if (b < 8)
+					unpacked[face] |= color << (b * 8);
+				else
+					unpacked[6] |= color << ((7 - face) * 8);
+			}
+		}
+	}
+	for (uint8_t i = 0; i < 7; i++)
+		stickers[i] = unpacked[i];
+	return true;
+}
+
+/**
+ * Reflect the cube from left to right.
+ *
+ * Every face is flipped horizontally (swapping its left and right
+ * columns, which holds for the up, down and back faces too given the
+ * way they're laid out), then the right and left faces trade places.
+ */
+void Cube::mirror()
+{
+	for (uint8_t f = 0; f < 6; f++)
+	{
+		uint64_t face = stickers[f];
+		// keep the middle column (stickers 1 and 5), swap 0/2, 3/7 and 4/6
+		uint64_t flipped = face & (((uint64_t)0xff << 48) | ((uint64_t)0xff << 16));
+		const uint8_t pairs[3][2] = { { 0, 2 }, { 3, 7 }, { 4, 6 } };
+		for (const uint8_t* pair : pairs)
+		{
+			uint8_t first = (7 - pair[0]) * 8;
+			uint8_t second = (7 - pair[1]) * 8;
+			flipped |= ((face >> first) & 0xff) << second;
+			flipped |= ((face >> second) & 0xff) << first;
+		}
+		stickers[f] = flipped;
+	}
+
+	uint64_t right = stickers[(uint8_t)FACE::RIGHT];
+	stickers[(uint8_t)FACE::RIGHT] = stickers[(uint8_t)FACE::LEFT];
+	stickers[(uint8_t)FACE::LEFT] = right;
+	COLOR rightCenter = getCenter(FACE::RIGHT);
+	setCenter(FACE::RIGHT, getCenter(FACE::LEFT));
+	setCenter(FACE::LEFT, rightCenter);
+}
+
+/**
+ * Recolor the cube so each center has the color it has on a cube that
+ * was just reset (the color after EMPTY in FACE order).
+ */
+void Cube::normalizeColors()
+{
+	uint8_t colors[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	for (uint8_t f = 0; f < 6; f++)
+		colors[(uint8_t)getCenter((FACE)f) & 7] = f + 1;
+
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		uint64_t recolored = 0;
+		for (uint8_t b = 0; b < 64; b += 8)
+			recolored |= (uint64_t)colors[(stickers[i] >> b) & 7] << b;
+		stickers[i] = recolored;
+	}
+}
+
 /**
  * Copy the state stored in the given string.
  * 
@@ -89,6 +368,49 @@ void Cube::copyState(std::string& state)
 	}
 }
 
+/**
+ * Write the cube's state into the given string, the inverse of
+ * copyState.
+ */
+void Cube::writeState(std::string& state)
+{
+	// sticker index for each character of a face, where -1 is the center
+	const int8_t positions[9] = { 0, 1, 2, 7, -1, 3, 6, 5, 4 };
+	state.resize(54);
+	for (uint8_t i = 0; i < 54; i++)
+	{
+		FACE face = (FACE)(i / 9);
+		int8_t idx = positions[i % 9];
+		state[i] = getColorChar(idx < 0 ? getCenter(face) : getSticker({ face, (uint8_t)idx }));
+	}
+}
+
+/**
+ * Rearrange the stickers the given way: each takes the color of the
+ * sticker the permutation says it comes from.
+ */
+void Cube::permute(const Permutation& permutation)
+{
+	uint8_t colors[NUM_STICKERS];
+	for (uint8_t sticker = 0; sticker < NUM_STICKERS; sticker++)
+		colors[sticker] = (uint8_t)(stickers[sticker / 8] >> ((7 - sticker % 8) * 8));
+	uint64_t permuted[7] = { 0, 0, 0, 0, 0, 0, 0 };
+	for (uint8_t sticker = 0; sticker < NUM_STICKERS; sticker++)
+		permuted[sticker / 8] |= (uint64_t)colors[permutation[sticker]] << ((7 - sticker % 8) * 8);
+	memcpy(stickers, permuted, sizeof(stickers));
+}
+
+/**
+ * Rearrange this cube the way the given cube rearranges a solved one.
+ */
+void Cube::compose(const Cube& other) { permute(Permutation(other)); }
+
+/**
+ * Return the inverse of this cube, the state the rearrangement that
+ * undoes this one leaves a solved cube in.
+ */
+Cube Cube::inverse() const { return Permutation(*this).inverse().toCube(); }
+
 /**
  * Return the FACE value opposite the given face.
  */
@@ -392,40 +714,14 @@ std::pair<Cube::LOCATION, Cube::LOCATION> Cube::getAdjacentCorner(LOCATION loc)
  */
 Move Cube::move(FACE face, Move::TYPE type)
 {
-	// get the string of the requested face
-	std::string move = "";
-	switch (face)
-	{
-	case FACE::UP:
-		move = "U";
-		break;
-	case FACE::DOWN:
-		move = "D";
-		break;
-	case FACE::FRONT:
-		move = "F";
-		break;
-	case FACE::BACK:
-		move = "B";
-		break;
-	case FACE::RIGHT:
-		move = "R";
-		break;
-	case FACE::LEFT:
-		move = "L";
-		break;
-	}
-
-	// parse move based on type
-	if (type == Move::TYPE::NORMAL)
-		return parseMove(move);
-	else if (type == Move::TYPE::PRIME)
-		return parseMove(move + "\'");
-	else if (type == Move::TYPE::DOUBLE)
-		return parseMove(move + "2");
-
 	// invalid move
-	return Move((Move::PIECES)0, Move::TYPE::NO_MOVE);
+	if (type == Move::TYPE::NO_MOVE)
+		return Move((Move::PIECES)0, Move::TYPE::NO_MOVE);
+
+	// the outer faces share the same order in both enums
+	Move move((Move::PIECES)face, type);
+	executeMove(move);
+	return move;
 }
 
 /**
@@ -528,13 +824,107 @@ std::vector<Move> Cube::readMoves(const std::string& moves)
 	return moveVector;
 }
 
+/**
+ * Find the move written as the given letter and suffix (', 2, or
+ * anything else for a clockwise turn).
+ *
+ * Return a move of type NO_MOVE if the letter isn't a move.
+ */
+Move charsToMove(char letter, char suffix)
+{
+	// letter of each move, in Move::PIECES order
+	static const char letters[] = "UDFBRLfbudrlMESxyz";
+
+	// rotations can be written in either case
+	if (letter >= 'X' && letter <= 'Z')
+		letter = letter - 'X' + 'x';
+	const char* found = letter != '\0' ? strchr(letters, letter) : nullptr;
+	if (found == nullptr)
+		return Move();
+
+	Move::TYPE type = suffix == '\'' ? Move::TYPE::PRIME : suffix == '2' ? Move::TYPE::DOUBLE : Move::TYPE::NORMAL;
+	return Move((Move::PIECES)(found - letters), type);
+}
+
+/**
+ * Read and execute a sequence of moves, adding each one to the end
+ * of the given buffer.
+ *
+ * Moves are read the same way as the string version, but without
+ * building any strings or vectors, so this never allocates.
+ */
+void Cube::readMoves(const char* moves, MoveBuffer& solution)
+{
+	for (const char* c = moves; *c != '\0'; c++)
+	{
+		char suffix = c[1] == '\'' || c[1] == '2' ? c[1] : ' ';
+		Move move = charsToMove(*c, suffix);
+		if (suffix != ' ')
+			c++;
+		if (move.type != Move::TYPE::NO_MOVE)
+		{
+			executeMove(move);
+			solution.push_back(move);
+		}
+	}
+}
+
 /**
  * Execute the moves in the given vector.
  */
-void Cube::executeMoves(std::vector<Move>& moves)
+void Cube::executeMoves(const std::vector<Move>& moves)
 {
-	for (Move& move : moves)
-		parseMove(move.toString());
+	for (const Move& move : moves)
+		executeMove(move);
+}
+
+/**
+ * Execute a single move.
+ *
+ * Unlike parseMove, this dispatches straight to the turn
+ * functions without building or comparing any strings.
+ */
+void Cube::executeMove(const Move& move)
+{
+	// clockwise and counter clockwise turn of each move's pieces, in Move::PIECES order
+	typedef void (Cube::*Turn)();
+	static const Turn turns[18][2] = {
+		{ &Cube::u, &Cube::uPrime },
+		{ &Cube::d, &Cube::dPrime },
+		{ &Cube::f, &Cube::fPrime },
+		{ &Cube::b, &Cube::bPrime },
+		{ &Cube::r, &Cube::rPrime },
+		{ &Cube::l, &Cube::lPrime },
+		{ &Cube::fWide, &Cube::fPrimeWide },
+		{ &Cube::bWide, &Cube::bPrimeWide },
+		{ &Cube::uWide, &Cube::uPrimeWide },
+		{ &Cube::dWide, &Cube::dPrimeWide },
+		{ &Cube::rWide, &Cube::rPrimeWide },
+		{ &Cube::lWide, &Cube::lPrimeWide },
+		{ &Cube::m, &Cube::mPrime },
+		{ &Cube::e, &Cube::ePrime },
+		{ &Cube::s, &Cube::sPrime },
+		{ &Cube::x, &Cube::xPrime },
+		{ &Cube::y, &Cube::yPrime },
+		{ &Cube::z, &Cube::zPrime }
+	};
+
+	const Turn* turn = turns[(uint8_t)move.pieces];
+	switch (move.type)
+	{
+	case Move::TYPE::NORMAL:
+		(this->*turn[0])();
+		break;
+	case Move::TYPE::PRIME:
+		(this->*turn[1])();
+		break;
+	case Move::TYPE::DOUBLE:
+		(this->*turn[0])();
+		(this->*turn[0])();
+		break;
+	default:
+		break;
+	}
 }
 
 /**
@@ -847,12 +1237,8 @@ void Cube::u()
 	// turn the up face
 	setFace(FACE::UP, rotateRight(getFace(FACE::UP), 16));
 
-	// turn the adjacent stickers on the front, left, back, and right faces
-	uint64_t toSave = getFace(FACE::FRONT) & upMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~upMask) | (getFace(FACE::RIGHT) & upMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~upMask) | (getFace(FACE::BACK) & upMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~upMask) | (getFace(FACE::LEFT) & upMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~upMask) | toSave);
+	// turn the adjacent stickers on the front, right, back, and left faces
+	turnSideRows(upMask, true);
 }
 
 /**
@@ -863,12 +1249,8 @@ void Cube::uPrime()
 	// turn the up face
 	setFace(FACE::UP, rotateLeft(getFace(FACE::UP), 16));
 
-	// turn the adjacent stickers on the front, left, back, and right faces
-	uint64_t toSave = getFace(FACE::FRONT) & upMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~upMask) | (getFace(FACE::LEFT) & upMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~upMask) | (getFace(FACE::BACK) & upMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~upMask) | (getFace(FACE::RIGHT) & upMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~upMask) | toSave);
+	// turn the adjacent stickers on the front, right, back, and left faces
+	turnSideRows(upMask, false);
 }
 
 /**
@@ -898,11 +1280,7 @@ void Cube::d()
 	setFace(FACE::DOWN, rotateRight(getFace(FACE::DOWN), 16));
 
 	// turn the adjacent stickers on the front, right, back, and left faces
-	uint64_t toSave = getFace(FACE::FRONT) & downMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~downMask) | (getFace(FACE::LEFT) & downMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~downMask) | (getFace(FACE::BACK) & downMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~downMask) | (getFace(FACE::RIGHT) & downMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~downMask) | toSave);
+	turnSideRows(downMask, false);
 }
 
 /**
@@ -914,11 +1292,7 @@ void Cube::dPrime()
 	setFace(FACE::DOWN, rotateLeft(getFace(FACE::DOWN), 16));
 
 	// turn the adjacent stickers on the front, right, back, and left faces
-	uint64_t toSave = getFace(FACE::FRONT) & downMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~downMask) | (getFace(FACE::RIGHT) & downMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~downMask) | (getFace(FACE::BACK) & downMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~downMask) | (getFace(FACE::LEFT) & downMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~downMask) | toSave);
+	turnSideRows(downMask, true);
 }
 
 /**
@@ -1192,11 +1566,7 @@ void Cube::e()
 	setCenter(FACE::RIGHT, toSaveCenter);
 
 	// rotate the edge pieces
-	uint64_t toSaveEdges = getFace(FACE::FRONT) & middleRowMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~middleRowMask) | (getFace(FACE::LEFT) & middleRowMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~middleRowMask) | (getFace(FACE::BACK) & middleRowMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~middleRowMask) | (getFace(FACE::RIGHT) & middleRowMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~middleRowMask) | toSaveEdges);
+	turnSideRows(middleRowMask, false);
 }
 
 /**
@@ -1212,11 +1582,7 @@ void Cube::ePrime()
 	setCenter(FACE::LEFT, toSaveCenter);
 
 	// rotate the edge pieces
-	uint64_t toSaveEdges = getFace(FACE::FRONT) & middleRowMask;
-	setFace(FACE::FRONT, (getFace(FACE::FRONT) & ~middleRowMask) | (getFace(FACE::RIGHT) & middleRowMask));
-	setFace(FACE::RIGHT, (getFace(FACE::RIGHT) & ~middleRowMask) | (getFace(FACE::BACK) & middleRowMask));
-	setFace(FACE::BACK, (getFace(FACE::BACK) & ~middleRowMask) | (getFace(FACE::LEFT) & middleRowMask));
-	setFace(FACE::LEFT, (getFace(FACE::LEFT) & ~middleRowMask) | toSaveEdges);
+	turnSideRows(middleRowMask, true);
 }
 
 /**
@@ -1381,29 +1747,8 @@ Cube::COLOR Cube::getCharColor(char c)
 
 void Cube::printLocation(LOCATION loc)
 {
-	COLOR c = getSticker(loc);
-	switch (loc.face)
-	{
-	case FACE::UP:
-		std::cout << "up";
-		break;
-	case FACE::DOWN:
-		std::cout << "down";
-		break;
-	case FACE::FRONT:
-		std::cout << "front";
-		break;
-	case FACE::BACK:
-		std::cout << "back";
-		break;
-	case FACE::RIGHT:
-		std::cout << "right";
-		break;
-	case FACE::LEFT:
-		std::cout << "left";
-		break;
-	}
-	std::cout << " face, idx " << (int)loc.idx << " color " << getColorChar(c) << std::endl;
+	const char* faceNames[6] = { "up", "down", "front", "back", "right", "left" };
+	printf("%s face, idx %d color %c\n", faceNames[(uint8_t)loc.face], (int)loc.idx, getColorChar(getSticker(loc)));
 }
 
 /**
@@ -1415,34 +1760,67 @@ void Cube::printLocation(LOCATION loc)
  */
 void Cube::print()
 {
+	// stickers of each row of a face, by index, with -1 for the center
+	const int rows[3][3] = { { 0, 1, 2 }, { 7, -1, 3 }, { 6, 5, 4 } };
+	auto row = [this, &rows](FACE face, uint8_t r) {
+		for (int idx : rows[r])
+			putchar(getColorChar(idx < 0 ? getCenter(face) : getSticker({ face, (uint8_t)idx })));
+	};
+
 	// print top face indented by 4 spaces
-	std::cout << "    " << getColorChar(getSticker({ FACE::UP, 0 })) << getColorChar(getSticker({ FACE::UP, 1 })) << getColorChar(getSticker({ FACE::UP, 2 })) << std::endl;
-	std::cout << "    " << getColorChar(getSticker({ FACE::UP, 7 })) << getColorChar(getCenter(FACE::UP)) << getColorChar(getSticker({ FACE::UP, 3 })) << std::endl;
-	std::cout << "    " << getColorChar(getSticker({ FACE::UP, 6 })) << getColorChar(getSticker({ FACE::UP, 5 })) << getColorChar(getSticker({ FACE::UP, 4 })) << std::endl;
+	for (uint8_t r = 0; r < 3; r++)
+	{
+		printf("    ");
+		row(FACE::UP, r);
+		putchar('\n');
+	}
+	putchar('\n');
 
-	// print first row of left, front, right, and back faces, each separated by a
+	// print each row of left, front, right, and back faces, each separated by a
 	// space
-	std::cout << "\n" << getColorChar(getSticker({ FACE::LEFT, 0 })) << getColorChar(getSticker({ FACE::LEFT, 1 })) << getColorChar(getSticker({ FACE::LEFT, 2 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::FRONT, 0 })) << getColorChar(getSticker({ FACE::FRONT, 1 })) << getColorChar(getSticker({ FACE::FRONT, 2 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::RIGHT, 0 })) << getColorChar(getSticker({ FACE::RIGHT, 1 })) << getColorChar(getSticker({ FACE::RIGHT, 2 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::BACK, 0 })) << getColorChar(getSticker({ FACE::BACK, 1 })) << getColorChar(getSticker({ FACE::BACK, 2 })) << std::endl;
-
-	// print second row of left, center, right, and back faces, each separated by
-	// a space
-	std::cout << getColorChar(getSticker({ FACE::LEFT, 7 })) << getColorChar(getCenter(FACE::LEFT)) << getColorChar(getSticker({ FACE::LEFT, 3 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::FRONT, 7 })) << getColorChar(getCenter(FACE::FRONT)) << getColorChar(getSticker({ FACE::FRONT, 3 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::RIGHT, 7 })) << getColorChar(getCenter(FACE::RIGHT)) << getColorChar(getSticker({ FACE::RIGHT, 3 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::BACK, 7 })) << getColorChar(getCenter(FACE::BACK)) << getColorChar(getSticker({ FACE::BACK, 3 })) << std::endl;
-
-	// print third row of left, center, right, and back faces, each separated by a
-	// space
-	std::cout << getColorChar(getSticker({ FACE::LEFT, 6 })) << getColorChar(getSticker({ FACE::LEFT, 5 })) << getColorChar(getSticker({ FACE::LEFT, 4 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::FRONT, 6 })) << getColorChar(getSticker({ FACE::FRONT, 5 })) << getColorChar(getSticker({ FACE::FRONT, 4 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::RIGHT, 6 })) << getColorChar(getSticker({ FACE::RIGHT, 5 })) << getColorChar(getSticker({ FACE::RIGHT, 4 }));
-	std::cout << " " << getColorChar(getSticker({ FACE::BACK, 6 })) << getColorChar(getSticker({ FACE::BACK, 5 })) << getColorChar(getSticker({ FACE::BACK, 4 })) << "\n\n";
+	for (uint8_t r = 0; r < 3; r++)
+	{
+		row(FACE::LEFT, r);
+		for (FACE face : { FACE::FRONT, FACE::RIGHT, FACE::BACK })
+		{
+			putchar(' ');
+			row(face, r);
+		}
+		putchar('\n');
+	}
+	putchar('\n');
 
 	// print the down face indented by 4 spaces
-	std::cout << "    " << getColorChar(getSticker({ FACE::DOWN, 0 })) << getColorChar(getSticker({ FACE::DOWN, 1 })) << getColorChar(getSticker({ FACE::DOWN, 2 })) << std::endl;
-	std::cout << "    " << getColorChar(getSticker({ FACE::DOWN, 7 })) << getColorChar(getCenter(FACE::DOWN)) << getColorChar(getSticker({ FACE::DOWN, 3 })) << std::endl;
-	std::cout << "    " << getColorChar(getSticker({ FACE::DOWN, 6 })) << getColorChar(getSticker({ FACE::DOWN, 5 })) << getColorChar(getSticker({ FACE::DOWN, 4 })) << "\n\n";
+	for (uint8_t r = 0; r < 3; r++)
+	{
+		printf("    ");
+		row(FACE::DOWN, r);
+		putchar('\n');
+	}
+	putchar('\n');
+}
+
+/**
+ * Cycle the stickers under the given mask around the side faces.
+ *
+ * The front and back faces are next to each other in memory, as are the
+ * right and left faces, so each pair is turned as two lanes at once: in
+ * U, front and back take right and left, while right and left take back
+ * and front, and the reverse in D.
+ */
+void Cube::turnSideRows(uint64_t mask, bool fromRight)
+{
+	Lanes rows = splatLanes(mask);
+	Lanes frontBack = loadLanes(&stickers[(uint8_t)FACE::FRONT]);
+	Lanes rightLeft = loadLanes(&stickers[(uint8_t)FACE::RIGHT]);
+	if (fromRight)
+	{
+		storeLanes(&stickers[(uint8_t)FACE::FRONT], selectLanes(frontBack, rightLeft, rows));
+		storeLanes(&stickers[(uint8_t)FACE::RIGHT], selectLanes(rightLeft, swapLanes(frontBack), rows));
+	}
+	else
+	{
+		storeLanes(&stickers[(uint8_t)FACE::FRONT], selectLanes(frontBack, swapLanes(rightLeft), rows));
+		storeLanes(&stickers[(uint8_t)FACE::RIGHT], selectLanes(rightLeft, frontBack, rows));
+	}
 }
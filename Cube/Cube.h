@@ -7,6 +7,9 @@
 #include <vector>
 
 #include "Move.h"
+#include "MoveBuffer.h"
+
+class Permutation;
 
 class Cube
 {
@@ -83,11 +86,74 @@ public:
 	 */
 	bool isSolved();
 
+	/**
+	 * Check if the cube can be solved: every piece is a real piece and
+	 * appears once, and no corner is twisted, edge flipped or pair of
+	 * pieces swapped on its own.
+	 */
+	bool isSolvable() const;
+
+	/**
+	 * Check if two cubes are in exactly the same state.
+	 */
+	bool operator==(const Cube& other) const;
+
+	/**
+	 * Order cubes by their state, so the least of several can be chosen.
+	 */
+	bool operator<(const Cube& other) const;
+
+	/**
+	 * Get a 64-bit hash of the cube state.
+	 */
+	uint64_t hash() const;
+
+	/**
+	 * Pack the state into 3 words, 3 bits a sticker, and unpack it,
+	 * returning false if a sticker isn't a valid color.
+	 */
+	static constexpr uint8_t PACKED_WORDS = 3;
+	void pack(uint64_t words[PACKED_WORDS]) const;
+	bool unpack(const uint64_t words[PACKED_WORDS]);
+
+	/**
+	 * Reflect the cube from left to right, as if it were seen in a mirror.
+	 */
+	void mirror();
+
+	/**
+	 * Recolor the cube so each center has the color it has on a cube
+	 * that was just reset, and every other sticker follows its center.
+	 */
+	void normalizeColors();
+
 	/**
 	 * Copy the state stored in the given string.
 	 */
 	void copyState(std::string& state);
 
+	/**
+	 * Write the cube's state into the given string, in the form
+	 * copyState reads.
+	 */
+	void writeState(std::string& state);
+
+	/**
+	 * Group operations on cube states, where a state stands for the way
+	 * it rearranges the stickers of a solved cube (so its colors must be
+	 * the ones a reset cube has, for each piece to be told by them).
+	 *
+	 * Composing with another cube rearranges this one the way the other
+	 * rearranges a solved cube, the same as making the moves that lead to
+	 * it. The inverse is the state the moves that undo this one lead to.
+	 * Stickers are numbered face * 8 + idx, with the centers after them.
+	 * Permuting rearranges the stickers the given way (see Permutation).
+	 */
+	static constexpr uint8_t NUM_STICKERS = 54;
+	void compose(const Cube& other);
+	Cube inverse() const;
+	void permute(const Permutation& permutation);
+
 	/**
 	 * Functions for getting faces relative to one another.
 	 */
@@ -109,18 +175,24 @@ public:
 	/**
 	 * Bit masks for selecting specific rows of stickers
 	 */
-	uint64_t upMask = 0xffffff0000000000;
-	uint64_t rightMask = 0x0000ffffff000000;
-	uint64_t downMask = 0x00000000ffffff00;
-	uint64_t leftMask = 0xff0000000000ffff;
-	uint64_t middleColMask = 0x00ff000000ff0000;
-	uint64_t middleRowMask = 0x000000ff000000ff;
+	static constexpr uint64_t upMask = 0xffffff0000000000;
+	static constexpr uint64_t rightMask = 0x0000ffffff000000;
+	static constexpr uint64_t downMask = 0x00000000ffffff00;
+	static constexpr uint64_t leftMask = 0xff0000000000ffff;
+	static constexpr uint64_t middleColMask = 0x00ff000000ff0000;
+	static constexpr uint64_t middleRowMask = 0x000000ff000000ff;
 
 	/**
 	 * Read and execute a sequence of moves.
 	 */
 	std::vector<Move> readMoves(const std::string& moves);
-	void executeMoves(std::vector<Move>& moves);
+	void readMoves(const char* moves, MoveBuffer& solution);
+	void executeMoves(const std::vector<Move>& moves);
+
+	/**
+	 * Execute a single move.
+	 */
+	void executeMove(const Move& move);
 
 	/**
 	 * Read and execute a single move.
@@ -182,6 +254,12 @@ public:
 	void print();
 
 private:
+	/**
+	 * Permutations read and write the stickers directly, and label them
+	 * with their own numbers to follow where moves take them.
+	 */
+	friend class Permutation;
+
 	/**
 	 * Array of 7 64-bit integers. The first six integers correspond to
 	 * the 8 outer stickers of each face, in the following order: Up,
@@ -220,6 +298,13 @@ private:
 	void setFace(FACE f, uint64_t value);
 	void setCenter(FACE f, COLOR c);
 	void setSticker(LOCATION l, COLOR c);
+
+	/**
+	 * Cycle the stickers under the given mask around the four side
+	 * faces, each face taking them from the face to its right (as U
+	 * does) or to its left (as D does).
+	 */
+	void turnSideRows(uint64_t mask, bool fromRight);
 };
 
 #endif
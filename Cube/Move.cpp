@@ -1,18 +1,9 @@
 #include "Move.h"
 
-/**
-* Create a new move of the given pieces and type.
-*/
-Move::Move(PIECES newPieces, TYPE newType)
-{
-	pieces = newPieces;
-	type = newType;
-}
-
 /**
 * Check if this move can merge with another.
 */
-bool Move::canMergeWith(const Move& move)
+bool Move::canMergeWith(const Move& move) const
 {
 	// can't merge if either are NO_MOVE
 	if (type == TYPE::NO_MOVE || move.type == TYPE::NO_MOVE)
@@ -31,7 +22,7 @@ bool Move::canMergeWith(const Move& move)
 * The new move's type is set to NO_MOVE if the merge results
 * in an elimination.
 */
-Move Move::merge(const Move& move)
+Move Move::merge(const Move& move) const
 {
 	TYPE newType = type;
 	switch (type)
@@ -100,80 +91,46 @@ Move Move::merge(const Move& move)
 }
 
 /**
-* Get a string representation of this move.
+* String representation of each move code.
 */
-std::string Move::toString()
+const char moveNames[NUM_MOVE_CODES][MOVE_CHARS + 1] = {
+	"U", "U'", "U2", "D", "D'", "D2", "F", "F'", "F2",
+	"B", "B'", "B2", "R", "R'", "R2", "L", "L'", "L2",
+	"f", "f'", "f2", "b", "b'", "b2", "u", "u'", "u2",
+	"d", "d'", "d2", "r", "r'", "r2", "l", "l'", "l2",
+	"M", "M'", "M2", "E", "E'", "E2", "S", "S'", "S2",
+	"x", "x'", "x2", "y", "y'", "y2", "z", "z'", "z2"
+};
+
+/**
+* Write the string representation of the move with the given code into
+* the given buffer, returning the number of characters written.
+*/
+size_t moveCodeToChars(uint8_t code, char* buffer)
 {
-	std::string value = "";
-	switch (pieces)
-	{
-	case PIECES::UP:
-		value += "U";
-		break;
-	case PIECES::DOWN:
-		value += "D";
-		break;
-	case PIECES::FRONT:
-		value += "F";
-		break;
-	case PIECES::BACK:
-		value += "B";
-		break;
-	case PIECES::RIGHT:
-		value += "R";
-		break;
-	case PIECES::LEFT:
-		value += "L";
-		break;
-	case PIECES::UP_WIDE:
-		value += "u";
-		break;
-	case PIECES::DOWN_WIDE:
-		value += "d";
-		break;
-	case PIECES::FRONT_WIDE:
-		value += "f";
-		break;
-	case PIECES::BACK_WIDE:
-		value += "b";
-		break;
-	case PIECES::RIGHT_WIDE:
-		value += "r";
-		break;
-	case PIECES::LEFT_WIDE:
-		value += "l";
-		break;
-	case PIECES::M_SLICE:
-		value += "M";
-		break;
-	case PIECES::E_SLICE:
-		value += "E";
-		break;
-	case PIECES::S_SLICE:
-		value += "S";
-		break;
-	case PIECES::X:
-		value += "x";
-		break;
-	case PIECES::Y:
-		value += "y";
-		break;
-	case PIECES::Z:
-		value += "z";
-		break;
-	}
+	buffer[0] = moveNames[code][0];
+	if (moveNames[code][1] == '\0')
+		return 1;
+	buffer[1] = moveNames[code][1];
+	return 2;
+}
 
-	switch (type)
-	{
-	case TYPE::PRIME:
-		value += "\'";
-		break;
-	case TYPE::DOUBLE:
-		value += "2";
-		break;
-	default:
-		break;
-	}
+/**
+* Write this move's string representation into the given buffer,
+* returning the number of characters written.
+*
+* An empty move is written as just its pieces.
+*/
+size_t Move::toChars(char* buffer) const
+{
+	return moveCodeToChars(type != TYPE::NO_MOVE ? code() : Move(pieces, TYPE::NORMAL).code(), buffer);
+}
 
-	return value;
-}
\ No newline at end of file
+/**
+* Get a string representation of this move.
+*/
+std::string Move::toString() const
+{
+	char buffer[MOVE_CHARS];
+	return std::string(buffer, toChars(buffer));
+}
@@ -1,9 +1,15 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 
+/**
+ * Most characters in a move's string representation.
+ */
+const size_t MOVE_CHARS = 2;
+
 class Move
 {
 public:
@@ -44,9 +50,10 @@ public:
 	};
 
 	/**
-	* Create a new move.
+	* Create a new move, or an empty one (of type NO_MOVE).
 	*/
-	Move(PIECES newPieces, TYPE newType);
+	constexpr Move(PIECES newPieces, TYPE newType) : pieces(newPieces), type(newType) {}
+	constexpr Move() : pieces(PIECES::UP), type(TYPE::NO_MOVE) {}
 
 	/**
 	* The pieces and type of this move.
@@ -57,16 +64,55 @@ public:
 	/**
 	* Check if this move can merge with another.
 	*/
-	bool canMergeWith(const Move& move);
+	bool canMergeWith(const Move& move) const;
 	/**
 	* Merge this move with another.
 	*/
-	Move merge(const Move& move);
+	Move merge(const Move& move) const;
+
+	/**
+	* The move that undoes this one: a clockwise turn for a counter
+	* clockwise one and the other way around. A half turn is its own
+	* inverse.
+	*/
+	constexpr Move inverse() const
+	{
+		return Move(pieces, type == TYPE::NORMAL ? TYPE::PRIME : type == TYPE::PRIME ? TYPE::NORMAL : type);
+	}
 
 	/**
 	* Get a string representation of this move.
 	*/
-	std::string toString();
+	std::string toString() const;
+
+	/**
+	* Write this move's string representation into the given buffer,
+	* which needs room for MOVE_CHARS characters, without allocating.
+	* Return the number of characters written (it's not terminated).
+	*/
+	size_t toChars(char* buffer) const;
+
+	/**
+	* One byte code for this move (see NUM_MOVE_CODES), and the move
+	* for a code. Empty moves have no code.
+	*/
+	constexpr uint8_t code() const { return (uint8_t)((uint8_t)pieces * 3 + (uint8_t)type); }
+	static constexpr Move fromCode(uint8_t code) { return Move((PIECES)(code / 3), (TYPE)(code % 3)); }
 };
 
+/**
+ * Number of one byte move codes. A move's code is its pieces * 3 plus
+ * its type, so the 18 outer face turns come first (U U' U2 D ...),
+ * followed by wide turns, slices and rotations.
+ */
+const uint8_t NUM_MOVE_CODES = 54;
+const uint8_t NUM_FACE_CODES = 18;
+
+/**
+ * Write the string representation of the move with the given code into
+ * the given buffer, which needs room for MOVE_CHARS characters, and
+ * return the number of characters written (it's not terminated).
+ */
+size_t moveCodeToChars(uint8_t code, char* buffer);
+
 #endif
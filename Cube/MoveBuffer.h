@@ -0,0 +1,68 @@
+#ifndef MOVE_BUFFER_H
+#define MOVE_BUFFER_H
+
+#include <stddef.h>
+
+#include "Move.h"
+
+/**
+ * Most moves a MoveBuffer can hold.
+ *
+ * No solve has been seen to need more than 110 moves (including
+ * rotations), so this leaves plenty of room.
+ */
+const size_t MOVE_BUFFER_CAPACITY = 256;
+
+class MoveBuffer
+{
+	/**
+	 * This class is a fixed-capacity list of moves stored inline,
+	 * so filling one never allocates.
+	 *
+	 * Moves pushed past the capacity are dropped, and the buffer
+	 * remembers that it overflowed.
+	 */
+
+public:
+	MoveBuffer() : count(0), overflowed(false) {}
+
+	void push_back(const Move& move)
+	{
+		if (count < MOVE_BUFFER_CAPACITY)
+			moves[count++] = move;
+		else
+			overflowed = true;
+	}
+	void pop_back() { count--; }
+	void clear()
+	{
+		count = 0;
+		overflowed = false;
+	}
+
+	Move& back() { return moves[count - 1]; }
+	const Move& back() const { return moves[count - 1]; }
+	Move& operator[](size_t i) { return moves[i]; }
+	const Move& operator[](size_t i) const { return moves[i]; }
+
+	Move* begin() { return moves; }
+	Move* end() { return moves + count; }
+	const Move* begin() const { return moves; }
+	const Move* end() const { return moves + count; }
+	const Move* data() const { return moves; }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	/**
+	 * Check if a move was ever dropped for lack of room.
+	 */
+	bool overflow() const { return overflowed; }
+
+private:
+	Move moves[MOVE_BUFFER_CAPACITY];
+	size_t count;
+	bool overflowed;
+};
+
+#endif
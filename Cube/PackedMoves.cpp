@@ -0,0 +1,144 @@
+#include "PackedMoves.h"
+
+static_assert(NUM_FACE_CODES + NUM_SLICE_CODES <= PACKED_ESCAPE, "packed symbols don't fit in 5 bits");
+static_assert(symbolCode(packedSymbol(Move(Move::PIECES::S_SLICE, Move::TYPE::DOUBLE).code())) ==
+	Move(Move::PIECES::S_SLICE, Move::TYPE::DOUBLE).code(), "packed slices don't round trip");
+static_assert(packedSymbol(Move(Move::PIECES::X, Move::TYPE::NORMAL).code()) == PACKED_ESCAPE, "rotations should be escaped");
+
+/**
+ * Number of bits the given moves take once packed.
+ */
+size_t packedBits(const uint8_t* codes, size_t count)
+{
+	size_t bits = 0;
+	for (size_t i = 0; i < count; i++)
+		bits += packedSymbol(codes[i]) == PACKED_ESCAPE ? PACKED_MOVE_BITS + PACKED_CODE_BITS : PACKED_MOVE_BITS;
+	return bits;
+}
+
+/**
+ * Pack the given move codes into the given buffer, returning the number
+ * of bytes written.
+ *
+ * Bits are gathered in a word and written out a byte at a time.
+ */
+size_t packMoves(const uint8_t* codes, size_t count, uint8_t* buffer)
+{
+	size_t written = 0;
+	uint32_t bits = 0;
+	uint8_t numBits = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		uint8_t symbol = packedSymbol(codes[i]);
+		bits |= (uint32_t)symbol << numBits;
+		numBits += PACKED_MOVE_BITS;
+		if (symbol == PACKED_ESCAPE)
+		{
+			bits |= (uint32_t)codes[i] << numBits;
+			numBits += PACKED_CODE_BITS;
+		}
+		while (numBits >= 8)
+		{
+			buffer[written++] = (uint8_t)bits;
+			bits >>= 8;
+			numBits -= 8;
+		}
+	}
+	if (numBits > 0)
+		buffer[written++] = (uint8_t)bits;
+	return written;
+}
+
+/**
+ * Unpack the given number of moves from the given packed bytes,
+ * returning the number of bytes read, or 0 if they're invalid.
+ */
+size_t unpackMoves(const uint8_t* buffer, size_t size, size_t count, uint8_t* codes)
+{
+	size_t read = 0;
+	uint32_t bits = 0;
+	uint8_t numBits = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		// make sure there are enough bits for an escaped move
+		while (numBits < PACKED_MOVE_BITS + PACKED_CODE_BITS && read < size)
+		{
+			bits |= (uint32_t)buffer[read++] << numBits;
+			numBits += 8;
+		}
+		if (numBits < PACKED_MOVE_BITS)
+			return 0;
+
+		uint8_t symbol = bits & ((1 << PACKED_MOVE_BITS) - 1);
+		bits >>= PACKED_MOVE_BITS;
+		numBits -= PACKED_MOVE_BITS;
+		if (symbol == PACKED_ESCAPE)
+		{
+			if (numBits < PACKED_CODE_BITS)
+				return 0;
+			codes[i] = bits & ((1 << PACKED_CODE_BITS) - 1);
+			bits >>= PACKED_CODE_BITS;
+			numBits -= PACKED_CODE_BITS;
+			if (codes[i] >= NUM_MOVE_CODES)
+				return 0;
+		}
+		else if (symbol < NUM_FACE_CODES + NUM_SLICE_CODES)
+			codes[i] = symbolCode(symbol);
+		else
+			return 0;
+	}
+	// whole bytes left over were read ahead but not used
+	return read - numBits / 8;
+}
+
+/**
+ * Write the given integer 7 bits at a time, returning the number of
+ * bytes written.
+ */
+size_t writeVarint(uint64_t value, uint8_t* buffer)
+{
+	size_t written = 0;
+	while (value >= 0x80)
+	{
+		buffer[written++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	buffer[written++] = (uint8_t)value;
+	return written;
+}
+
+/**
+ * Read an integer written 7 bits at a time, returning the number of
+ * bytes read, or 0 if the bytes run out.
+ */
+size_t readVarint(const uint8_t* buffer, size_t size, uint64_t& value)
+{
+	value = 0;
+	for (size_t i = 0; i < size && i < MAX_VARINT_BYTES; i++)
+	{
+		value |= (uint64_t)(buffer[i] & 0x7f) << (7 * i);
+		if ((buffer[i] & 0x80) == 0)
+			return i + 1;
+	}
+	return 0;
+}
+
+/**
+ * Read a little endian integer of the given number of bytes.
+ */
+uint64_t readLittleEndian(const uint8_t* bytes, uint8_t size)
+{
+	uint64_t value = 0;
+	for (uint8_t i = 0; i < size; i++)
+		value |= (uint64_t)bytes[i] << (i * 8);
+	return value;
+}
+
+/**
+ * Write a little endian integer of the given number of bytes.
+ */
+void writeLittleEndian(uint64_t value, uint8_t size, uint8_t* bytes)
+{
+	for (uint8_t i = 0; i < size; i++)
+		bytes[i] = (uint8_t)(value >> (i * 8));
+}
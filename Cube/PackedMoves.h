@@ -0,0 +1,85 @@
+#ifndef PACKED_MOVES_H
+#define PACKED_MOVES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Move.h"
+
+/**
+ * Moves packed into 5 bit symbols, for storing solutions compactly.
+ *
+ * Outer face turns (symbols 0-17) and slices (18-26) get a symbol of
+ * their own, which covers every move an optimized solution uses other
+ * than the rotations at its end. Any other move is written as the
+ * escape symbol followed by its 6 bit code. Symbols are packed starting
+ * from the lowest bit of each byte, and the last byte is padded with
+ * zeros.
+ */
+const uint8_t PACKED_MOVE_BITS = 5;
+const uint8_t PACKED_CODE_BITS = 6;
+const uint8_t PACKED_ESCAPE = 31;
+
+/**
+ * First code and number of codes of the slices, which follow the outer
+ * face turns in the packed symbols.
+ */
+const uint8_t SLICE_CODES = (uint8_t)Move::PIECES::M_SLICE * 3;
+const uint8_t NUM_SLICE_CODES = 9;
+
+/**
+ * Packed symbol for the move with the given code, and the code for a
+ * packed symbol (other than the escape).
+ */
+constexpr uint8_t packedSymbol(uint8_t code)
+{
+	return code < NUM_FACE_CODES ? code
+		: code >= SLICE_CODES && code < SLICE_CODES + NUM_SLICE_CODES ? (uint8_t)(code - SLICE_CODES + NUM_FACE_CODES)
+		: PACKED_ESCAPE;
+}
+constexpr uint8_t symbolCode(uint8_t symbol)
+{
+	return symbol < NUM_FACE_CODES ? symbol : (uint8_t)(symbol - NUM_FACE_CODES + SLICE_CODES);
+}
+
+/**
+ * Number of bits the given moves take once packed, and the number of
+ * bytes they're padded to.
+ */
+size_t packedBits(const uint8_t* codes, size_t count);
+inline size_t packedBytes(const uint8_t* codes, size_t count) { return (packedBits(codes, count) + 7) / 8; }
+
+/**
+ * Pack the given move codes into the given buffer, which must hold
+ * packedBytes of them, returning the number of bytes written.
+ */
+size_t packMoves(const uint8_t* codes, size_t count, uint8_t* buffer);
+
+/**
+ * Unpack the given number of moves from the given packed bytes into the
+ * given array of codes, returning the number of bytes read, or 0 if the
+ * bytes run out or hold an invalid move.
+ */
+size_t unpackMoves(const uint8_t* buffer, size_t size, size_t count, uint8_t* codes);
+
+/**
+ * Most bytes a packed variable length integer takes.
+ */
+const size_t MAX_VARINT_BYTES = 10;
+
+/**
+ * Write the given integer 7 bits at a time, lowest first, with the top
+ * bit of each byte set if more follow, returning the number of bytes
+ * written. Read one back, returning the number of bytes read, or 0 if
+ * the bytes run out.
+ */
+size_t writeVarint(uint64_t value, uint8_t* buffer);
+size_t readVarint(const uint8_t* buffer, size_t size, uint64_t& value);
+
+/**
+ * Read and write a little endian integer of the given number of bytes.
+ */
+uint64_t readLittleEndian(const uint8_t* bytes, uint8_t size);
+void writeLittleEndian(uint64_t value, uint8_t size, uint8_t* bytes);
+
+#endif
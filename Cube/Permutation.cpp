@@ -0,0 +1,280 @@
+#include <string.h>
+
+#include "Permutation.h"
+
+typedef Cube::FACE FACE;
+typedef Cube::LOCATION LOCATION;
+
+constexpr uint8_t Permutation::SIZE;
+
+/**
+ * Value of every sticker of the given state, numbered face * 8 + idx,
+ * with the centers in the last integer.
+ */
+void Permutation::readStickers(const uint64_t stickers[7], uint8_t values[Cube::NUM_STICKERS])
+{
+	for (uint8_t sticker = 0; sticker < Cube::NUM_STICKERS; sticker++)
+		values[sticker] = (uint8_t)(stickers[sticker / 8] >> ((7 - sticker % 8) * 8));
+}
+
+/**
+ * Table for telling where each sticker belongs: the other stickers on
+ * each sticker's piece, and the place on a solved cube of each color on
+ * each piece, by the piece's colors as a bit mask (which has one color
+ * for a center, two for an edge and three for a corner).
+ */
+struct Permutation::StickerHomes
+{
+	uint8_t pieces[48][2];
+	uint8_t homes[128][8];
+
+	StickerHomes()
+	{
+		Cube solved;
+		for (uint8_t f = 0; f < 6; f++)
+		{
+			for (uint8_t idx = 0; idx < 8; idx++)
+			{
+				LOCATION loc = { (FACE)f, idx };
+				uint8_t sticker = f * 8 + idx;
+				if (idx % 2 == 1)
+				{
+					LOCATION edge = solved.getAdjacentEdge(loc);
+					pieces[sticker][0] = pieces[sticker][1] = (uint8_t)edge.face * 8 + edge.idx;
+				}
+				else
+				{
+					std::pair<LOCATION, LOCATION> corner = solved.getAdjacentCorner(loc);
+					pieces[sticker][0] = (uint8_t)corner.first.face * 8 + corner.first.idx;
+					pieces[sticker][1] = (uint8_t)corner.second.face * 8 + corner.second.idx;
+				}
+			}
+		}
+
+		uint8_t colors[Cube::NUM_STICKERS];
+		for (uint8_t sticker = 0; sticker < 48; sticker++)
+			colors[sticker] = (uint8_t)solved.getSticker({ (FACE)(sticker / 8), (uint8_t)(sticker % 8) });
+		for (uint8_t f = 0; f < 6; f++)
+			colors[48 + f] = (uint8_t)solved.getCenter((FACE)f);
+		memset(homes, 0xff, sizeof(homes));
+		for (uint8_t sticker = 0; sticker < Cube::NUM_STICKERS; sticker++)
+			homes[pieceMask(colors, sticker)][colors[sticker] & 7] = sticker;
+	}
+
+	/**
+	 * Bit mask of the colors on the given sticker's piece.
+	 */
+	uint8_t pieceMask(const uint8_t colors[Cube::NUM_STICKERS], uint8_t sticker) const
+	{
+		uint8_t mask = 1 << (colors[sticker] & 7);
+		if (sticker >= 48)
+			return mask;
+		return mask | 1 << (colors[pieces[sticker][0]] & 7) | 1 << (colors[pieces[sticker][1]] & 7);
+	}
+};
+
+/**
+ * Table of the rearrangement each move makes, found by making it on a
+ * solved cube.
+ */
+struct Permutation::MovePermutations
+{
+	Permutation moves[NUM_MOVE_CODES];
+
+	MovePermutations()
+	{
+		for (uint8_t code = 0; code < NUM_MOVE_CODES; code++)
+		{
+			Cube cube;
+			cube.executeMove(Move::fromCode(code));
+			moves[code] = Permutation(cube);
+		}
+	}
+};
+
+Permutation::Permutation()
+{
+	for (uint8_t i = 0; i < SIZE; i++)
+		from[i] = i;
+}
+
+/**
+ * Create the rearrangement the given cube makes of a solved cube: each
+ * sticker comes from where its color belongs on its piece, found by the
+ * piece's colors. A sticker that isn't on a real piece, or whose place
+ * another sticker has already taken, is given one of the places left
+ * over in order, so every place is used once even for a state that
+ * can't be reached, and inverting it is always safe.
+ */
+Permutation::Permutation(const Cube& cube)
+{
+	const StickerHomes& stickerHomes = homes();
+	uint8_t colors[Cube::NUM_STICKERS];
+	readStickers(cube.stickers, colors);
+	bool used[SIZE] = {};
+	bool complete = true;
+	for (uint8_t sticker = 0; sticker < SIZE; sticker++)
+	{
+		uint8_t home = stickerHomes.homes[stickerHomes.pieceMask(colors, sticker)][colors[sticker] & 7];
+		if (home < SIZE && !used[home])
+			used[home] = true;
+		else
+		{
+			home = SIZE;
+			complete = false;
+		}
+		from[sticker] = home;
+	}
+	if (complete)
+		return;
+
+	uint8_t unused = 0;
+	for (uint8_t sticker = 0; sticker < SIZE; sticker++)
+	{
+		if (from[sticker] < SIZE)
+			continue;
+		while (used[unused])
+			unused++;
+		from[sticker] = unused;
+		used[unused] = true;
+	}
+}
+
+Permutation::Permutation(const std::vector<Move>& moves) : Permutation(moves.data(), moves.size()) {}
+
+/**
+ * Create the rearrangement the given moves make: each sticker of the
+ * labelled cube ends up holding the number of the sticker it came from.
+ */
+Permutation::Permutation(const Move* moves, size_t count)
+{
+	Cube cube = labelledCube();
+	for (size_t i = 0; i < count; i++)
+		cube.executeMove(moves[i]);
+	readStickers(cube.stickers, from);
+}
+
+/**
+ * A cube whose stickers hold their own numbers rather than colors.
+ */
+const Cube& Permutation::labelledCube()
+{
+	static const Cube labelled = []() {
+		Cube cube;
+		for (uint8_t i = 0; i < 7; i++)
+		{
+			cube.stickers[i] = 0;
+			for (uint8_t idx = 0; idx < 8; idx++)
+				cube.stickers[i] |= (uint64_t)(i * 8 + idx) << ((7 - idx) * 8);
+		}
+		return cube;
+	}();
+	return labelled;
+}
+
+/**
+ * The table of each sticker's home, built on first use.
+ */
+const Permutation::StickerHomes& Permutation::homes()
+{
+	static const StickerHomes stickerHomes;
+	return stickerHomes;
+}
+
+/**
+ * The rearrangement the given move makes, or the identity for an empty
+ * move.
+ */
+const Permutation& Permutation::ofMove(const Move& move)
+{
+	static const Permutation identity;
+	static const MovePermutations movePermutations;
+	return move.type == Move::TYPE::NO_MOVE ? identity : movePermutations.moves[move.code()];
+}
+
+/**
+ * This rearrangement followed by the given one: each sticker takes the
+ * color of the sticker this one moves to where the other one takes it
+ * from.
+ */
+Permutation Permutation::compose(const Permutation& other) const
+{
+	Permutation composed{ Uninitialized() };
+	for (uint8_t i = 0; i < SIZE; i++)
+		composed.from[i] = from[other.from[i]];
+	return composed;
+}
+
+/**
+ * The rearrangement that undoes this one, which sends each sticker back
+ * to where it came from.
+ */
+Permutation Permutation::inverse() const
+{
+	Permutation inverted{ Uninitialized() };
+	uint8_t source[SIZE];
+	memcpy(source, from, SIZE);
+	for (uint8_t i = 0; i < SIZE; i++)
+		inverted.from[source[i]] = i;
+	return inverted;
+}
+
+/**
+ * This rearrangement made the given number of times, by squaring it for
+ * each bit of the exponent.
+ */
+Permutation Permutation::power(int exponent) const
+{
+	Permutation result;
+	Permutation square = exponent < 0 ? inverse() : *this;
+	for (unsigned int n = exponent < 0 ? -(unsigned int)exponent : exponent; n > 0; n >>= 1)
+	{
+		if (n & 1)
+			result = result.compose(square);
+		square = square.compose(square);
+	}
+	return result;
+}
+
+/**
+ * This rearrangement between the given setup and its inverse, in one
+ * pass that writes each sticker at the place the setup takes it from,
+ * so the setup's inverse is never built.
+ */
+Permutation Permutation::conjugate(const Permutation& setup) const
+{
+	Permutation conjugated{ Uninitialized() };
+	uint8_t moves[SIZE], setupMoves[SIZE];
+	memcpy(moves, from, SIZE);
+	memcpy(setupMoves, setup.from, SIZE);
+	for (uint8_t i = 0; i < SIZE; i++)
+		conjugated.from[setupMoves[i]] = setupMoves[moves[i]];
+	return conjugated;
+}
+
+/**
+ * The commutator of the given rearrangements: a, then b, then undoing a
+ * and b, in one pass the same way as a conjugate.
+ */
+Permutation Permutation::commutator(const Permutation& a, const Permutation& b)
+{
+	Permutation commuted{ Uninitialized() };
+	uint8_t aMoves[SIZE], bMoves[SIZE];
+	memcpy(aMoves, a.from, SIZE);
+	memcpy(bMoves, b.from, SIZE);
+	for (uint8_t i = 0; i < SIZE; i++)
+		commuted.from[bMoves[aMoves[i]]] = aMoves[bMoves[i]];
+	return commuted;
+}
+
+/**
+ * The state this rearrangement leaves a solved cube in.
+ */
+Cube Permutation::toCube() const
+{
+	Cube cube;
+	cube.permute(*this);
+	return cube;
+}
+
+bool Permutation::operator==(const Permutation& other) const { return memcmp(from, other.from, SIZE) == 0; }
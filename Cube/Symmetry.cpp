@@ -0,0 +1,126 @@
+#include "Symmetry.h"
+
+/**
+ * Apply the given symmetry to the given cube: reflect it if the symmetry
+ * is 24 or more, then turn it to the symmetry's orientation.
+ */
+void applySymmetry(Cube& cube, uint8_t symmetry)
+{
+	if (symmetry >= NUM_ROTATIONS)
+		cube.mirror();
+	uint8_t rotation = symmetry % NUM_ROTATIONS;
+	cube.executeMove(bottomRotations[rotation / 4]);
+	cube.executeMove(sideRotations[rotation % 4]);
+}
+
+/**
+ * Table of each symmetry's conjugate of each move code.
+ *
+ * Rather than working out how each rotation and reflection relabels the
+ * faces, the table is found by trying every move on a scrambled cube
+ * (which no symmetry leaves the same) and seeing which one matches each
+ * move made after the symmetry.
+ */
+struct ConjugateTable
+{
+	uint8_t codes[NUM_SYMMETRIES][NUM_MOVE_CODES];
+	uint8_t inverse[NUM_SYMMETRIES][NUM_MOVE_CODES];
+
+	ConjugateTable()
+	{
+		Cube scrambled;
+		scrambled.readMoves("R U2 F' L D B2 R' U F2 D' L2 B U' R2 F D2 L' B'");
+		for (uint8_t s = 0; s < NUM_SYMMETRIES; s++)
+		{
+			Cube before[NUM_MOVE_CODES];
+			Cube after[NUM_MOVE_CODES];
+			for (uint8_t code = 0; code < NUM_MOVE_CODES; code++)
+			{
+				// the move made before the symmetry, and after it
+				before[code] = scrambled;
+				before[code].executeMove(Move::fromCode(code));
+				applySymmetry(before[code], s);
+				after[code] = scrambled;
+				applySymmetry(after[code], s);
+				after[code].executeMove(Move::fromCode(code));
+			}
+			for (uint8_t code = 0; code < NUM_MOVE_CODES; code++)
+			{
+				codes[s][code] = code;
+				for (uint8_t conjugate = 0; conjugate < NUM_MOVE_CODES; conjugate++)
+				{
+					if (before[conjugate] == after[code])
+					{
+						codes[s][code] = conjugate;
+						inverse[s][conjugate] = code;
+						break;
+					}
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Each symmetry's conjugate of each move code, built on first use.
+ */
+const ConjugateTable& conjugateTable()
+{
+	static const ConjugateTable table;
+	return table;
+}
+
+uint8_t conjugateMoveCode(uint8_t symmetry, uint8_t code)
+{
+	return conjugateTable().codes[symmetry][code];
+}
+
+uint8_t inverseConjugateMoveCode(uint8_t symmetry, uint8_t code)
+{
+	return conjugateTable().inverse[symmetry][code];
+}
+
+/**
+ * Replace the given cube with its canonical form, returning the symmetry
+ * that was applied to it.
+ *
+ * Each reflection's orientations are reached by choosing the bottom
+ * face and then turning the cube around it one quarter at a time, so
+ * each symmetry takes a single rotation rather than two.
+ */
+uint8_t canonicalize(Cube& cube, bool rotations, bool reflections)
+{
+	Cube best = cube;
+	best.normalizeColors();
+	uint8_t bestSymmetry = 0;
+	if (!rotations)
+	{
+		cube = best;
+		return bestSymmetry;
+	}
+
+	for (uint8_t reflection = 0; reflection < (reflections ? 2 : 1); reflection++)
+	{
+		for (uint8_t bottom = 0; bottom < 6; bottom++)
+		{
+			Cube rotated = cube;
+			if (reflection == 1)
+				rotated.mirror();
+			rotated.executeMove(bottomRotations[bottom]);
+			for (uint8_t side = 0; side < 4; side++)
+			{
+				if (side > 0)
+					rotated.executeMove(sideRotations[1]);
+				Cube candidate = rotated;
+				candidate.normalizeColors();
+				if (candidate < best)
+				{
+					best = candidate;
+					bestSymmetry = reflection * NUM_ROTATIONS + bottom * 4 + side;
+				}
+			}
+		}
+	}
+	cube = best;
+	return bestSymmetry;
+}
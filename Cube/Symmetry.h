@@ -0,0 +1,65 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <stdint.h>
+
+#include "Cube.h"
+#include "Move.h"
+
+/**
+ * The symmetries of the cube: each of its 24 orientations, then the
+ * same 24 after reflecting it from left to right.
+ *
+ * Symmetry s turns a cube to orientation s % 24 (the same order the
+ * solver tries them in: one of six bottom faces, then one of four
+ * turns around it), reflecting it first if s is 24 or more.
+ */
+const uint8_t NUM_ROTATIONS = 24;
+const uint8_t NUM_SYMMETRIES = 48;
+
+/**
+ * Rotations that turn the cube to each of its 24 orientations:
+ * one of six to choose the bottom face, then one of four around it.
+ */
+const Move bottomRotations[6] = {
+	Move(Move::PIECES::X, Move::TYPE::NO_MOVE),
+	Move(Move::PIECES::X, Move::TYPE::NORMAL),
+	Move(Move::PIECES::X, Move::TYPE::DOUBLE),
+	Move(Move::PIECES::X, Move::TYPE::PRIME),
+	Move(Move::PIECES::Z, Move::TYPE::NORMAL),
+	Move(Move::PIECES::Z, Move::TYPE::PRIME)
+};
+const Move sideRotations[4] = {
+	Move(Move::PIECES::Y, Move::TYPE::NO_MOVE),
+	Move(Move::PIECES::Y, Move::TYPE::NORMAL),
+	Move(Move::PIECES::Y, Move::TYPE::DOUBLE),
+	Move(Move::PIECES::Y, Move::TYPE::PRIME)
+};
+
+/**
+ * Apply the given symmetry to the given cube, in place.
+ */
+void applySymmetry(Cube& cube, uint8_t symmetry);
+
+/**
+ * Code of the move that has the same effect on a cube as the move with
+ * the given code has once the given symmetry is applied to it.
+ *
+ * Applying the symmetry and then the given move leaves the cube the
+ * same as applying the returned move and then the symmetry, so a
+ * solution for a transformed cube maps back move by move. The inverse
+ * maps a solution for the original cube onto the transformed one.
+ */
+uint8_t conjugateMoveCode(uint8_t symmetry, uint8_t code);
+uint8_t inverseConjugateMoveCode(uint8_t symmetry, uint8_t code);
+
+/**
+ * Replace the given cube with its canonical form, returning the symmetry
+ * that was applied to it: the least state (see Cube::operator<) over
+ * each symmetry applied and the colors normalized (see
+ * Cube::normalizeColors). Without reflections, only the 24 orientations
+ * are tried; without rotations, only the colors are normalized.
+ */
+uint8_t canonicalize(Cube& cube, bool rotations = true, bool reflections = true);
+
+#endif
@@ -0,0 +1,301 @@
+#include <string.h>
+#include <vector>
+
+#include "Batch.h"
+#include "CubeSolver.h"
+#include "Peephole.h"
+#include "Solver.h"
+
+/**
+ * Whether the given input is a 54 character state rather than a
+ * scramble.
+ */
+bool isStateInput(const char* input)
+{
+	return strlen(input) == 54 && strspn(input, "WYROBG") == 54;
+}
+
+/**
+ * Read the given C options (null for the defaults) into solve options,
+ * returning false if one is out of range.
+ *
+ * Options from a caller built against an older header are shorter, so
+ * only as many bytes as it says there are are read, and the rest keep
+ * their defaults.
+ */
+bool toSolveOptions(const cs_options* options, SolveOptions& solveOptions)
+{
+	cs_options given;
+	cs_default_options(&given);
+	if (options != nullptr)
+	{
+		if (options->size < offsetof(cs_options, metric))
+			return false;
+		memcpy(&given, options, options->size < sizeof(given) ? options->size : sizeof(given));
+	}
+
+	if (given.metric > CS_METRIC_ETM || given.move_set > CS_MOVES_SLICE_TURNS || given.allowed_moves > ALL_FACE_MOVES ||
+		!(given.budget_ms >= 0))
+		return false;
+	solveOptions.metric = (METRIC)given.metric;
+	solveOptions.moveSet = (MOVE_SET)given.move_set;
+	solveOptions.optimize = given.optimize != 0;
+	if (given.allowed_moves != 0)
+		solveOptions.restriction.allowed = given.allowed_moves;
+	solveOptions.budget = given.budget_ms / 1000;
+	return true;
+}
+
+/**
+ * Read the given input into the given cube, returning its status.
+ */
+int readInput(const char* input, Cube& cube)
+{
+	if (parseCube(input, cube) == nullptr)
+		return CS_OK;
+	// a state that parses but can't be solved is the only other failure
+	return isStateInput(input) ? CS_ERROR_UNSOLVABLE : CS_ERROR_INVALID_CUBE;
+}
+
+/**
+ * Length of the given solution's moves separated by spaces, without the
+ * space solutionToString leaves after the last one.
+ */
+size_t solutionLength(const Solution& solution)
+{
+	size_t length = solutionToString(solution, nullptr, 0);
+	return length > 0 ? length - 1 : 0;
+}
+
+/**
+ * Solve the given cube and write its solution to the given buffer,
+ * returning its status.
+ */
+int writeSolution(const Cube& cube, const SolveOptions& options, char* output, size_t outputSize, size_t* length)
+{
+	Solution solution = solve(cube, options);
+	if (!solution.solved)
+		return CS_ERROR_UNSOLVABLE;
+
+	size_t needed = solutionLength(solution);
+	if (length != nullptr)
+		*length = needed;
+	if (output == nullptr || outputSize == 0)
+		return CS_ERROR_BUFFER_TOO_SMALL;
+	solutionToString(solution, output, outputSize);
+	output[needed < outputSize ? needed : outputSize - 1] = '\0';
+	return needed < outputSize ? CS_OK : CS_ERROR_BUFFER_TOO_SMALL;
+}
+
+/**
+ * Solve the cube with the given state or scramble, checking it's the
+ * expected kind of input.
+ */
+int solveInput(const char* input, bool state, const cs_options* options, char* output, size_t outputSize,
+	size_t* length)
+{
+	SolveOptions solveOptions;
+	if (input == nullptr || !toSolveOptions(options, solveOptions))
+		return CS_ERROR_INVALID_ARGUMENT;
+	if (isStateInput(input) != state)
+		return CS_ERROR_INVALID_CUBE;
+
+	Cube cube;
+	int status = readInput(input, cube);
+	if (status != CS_OK)
+		return status;
+	return writeSolution(cube, solveOptions, output, outputSize, length);
+}
+
+/**
+ * Solve each of the given inputs on the given pool, or on the calling
+ * thread if it's null, writing the solutions as cs_solve_batch does.
+ */
+int solveInputs(const char* const* inputs, size_t count, const cs_options* options, ThreadPool* pool, char* output,
+	size_t outputSize, size_t* offsets, int* statuses, size_t* length)
+{
+	SolveOptions solveOptions;
+	if ((count > 0 && (inputs == nullptr || offsets == nullptr || statuses == nullptr)) ||
+		!toSolveOptions(options, solveOptions))
+		return CS_ERROR_INVALID_ARGUMENT;
+
+	std::vector<Cube> cubes(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		statuses[i] = inputs[i] == nullptr ? CS_ERROR_INVALID_CUBE : readInput(inputs[i], cubes[i]);
+		// inputs that failed are left as solved cubes, whose solutions are dropped
+		if (statuses[i] != CS_OK)
+			cubes[i] = Cube();
+	}
+
+	std::vector<Solution> solutions(count);
+	if (pool == nullptr)
+	{
+		for (size_t i = 0; i < count; i++)
+			solutions[i] = solve(cubes[i], solveOptions);
+	}
+	else
+		solveBatch(cubes.data(), count, solveOptions, solutions.data(), *pool);
+
+	size_t total = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (statuses[i] == CS_OK && !solutions[i].solved)
+			statuses[i] = CS_ERROR_UNSOLVABLE;
+		offsets[i] = total;
+		total += (statuses[i] == CS_OK ? solutionLength(solutions[i]) : 0) + 1;
+	}
+	if (length != nullptr)
+		*length = total;
+	if (total > outputSize || (total > 0 && output == nullptr))
+		return CS_ERROR_BUFFER_TOO_SMALL;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		char* text = output + offsets[i];
+		if (statuses[i] == CS_OK)
+			solutionToString(solutions[i], text, outputSize - offsets[i]);
+		size_t end = i + 1 < count ? offsets[i + 1] - 1 : total - 1;
+		text[end - offsets[i]] = '\0';
+	}
+	return CS_OK;
+}
+
+/**
+ * A solver's threads, kept between its batches.
+ */
+struct cs_solver
+{
+	ThreadPool pool;
+
+	explicit cs_solver(size_t threads) : pool(threads) {}
+};
+
+extern "C" {
+
+int cs_abi_version(void) { return CS_ABI_VERSION; }
+
+const char* cs_status_string(int status)
+{
+	switch (status)
+	{
+	case CS_OK:
+		return "ok";
+	case CS_ERROR_INVALID_ARGUMENT:
+		return "invalid argument";
+	case CS_ERROR_INVALID_CUBE:
+		return "not a scramble or a state";
+	case CS_ERROR_UNSOLVABLE:
+		return "can't be solved";
+	case CS_ERROR_BUFFER_TOO_SMALL:
+		return "buffer too small";
+	case CS_ERROR_TABLE:
+		return "table couldn't be saved or mapped";
+	case CS_ERROR_INTERNAL:
+		return "internal error";
+	}
+	return "unknown status";
+}
+
+void cs_default_options(cs_options* options)
+{
+	if (options == nullptr)
+		return;
+	memset(options, 0, sizeof(*options));
+	options->size = sizeof(*options);
+	options->metric = CS_METRIC_HTM;
+	options->move_set = CS_MOVES_ANY;
+	options->optimize = 1;
+}
+
+// nothing may throw across the interface, so anything unexpected becomes a status
+
+int cs_init(const char* table_path)
+{
+	if (table_path == nullptr)
+		return CS_ERROR_INVALID_ARGUMENT;
+	try
+	{
+		return loadPeepholeTable(table_path) ? CS_OK : CS_ERROR_TABLE;
+	}
+	catch (...)
+	{
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+int cs_solve_state(const char* state, const cs_options* options, char* output, size_t output_size, size_t* length)
+{
+	try
+	{
+		return solveInput(state, true, options, output, output_size, length);
+	}
+	catch (...)
+	{
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+int cs_solve_moves(const char* scramble, const cs_options* options, char* output, size_t output_size,
+	size_t* length)
+{
+	try
+	{
+		return solveInput(scramble, false, options, output, output_size, length);
+	}
+	catch (...)
+	{
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+int cs_solve_batch(const char* const* inputs, size_t count, const cs_options* options, size_t threads,
+	char* output, size_t output_size, size_t* offsets, int* statuses, size_t* length)
+{
+	try
+	{
+		if (threads == 1)
+			return solveInputs(inputs, count, options, nullptr, output, output_size, offsets, statuses, length);
+		ThreadPool pool(threads);
+		return solveInputs(inputs, count, options, &pool, output, output_size, offsets, statuses, length);
+	}
+	catch (...)
+	{
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+int cs_solver_create(size_t threads, cs_solver** solver)
+{
+	if (solver == nullptr)
+		return CS_ERROR_INVALID_ARGUMENT;
+	try
+	{
+		*solver = new cs_solver(threads);
+		return CS_OK;
+	}
+	catch (...)
+	{
+		*solver = nullptr;
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+void cs_solver_destroy(cs_solver* solver) { delete solver; }
+
+int cs_solver_solve_batch(cs_solver* solver, const char* const* inputs, size_t count, const cs_options* options,
+	char* output, size_t output_size, size_t* offsets, int* statuses, size_t* length)
+{
+	if (solver == nullptr)
+		return CS_ERROR_INVALID_ARGUMENT;
+	try
+	{
+		return solveInputs(inputs, count, options, &solver->pool, output, output_size, offsets, statuses, length);
+	}
+	catch (...)
+	{
+		return CS_ERROR_INTERNAL;
+	}
+}
+
+}
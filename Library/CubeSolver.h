@@ -0,0 +1,174 @@
+#ifndef CUBE_SOLVER_H
+#define CUBE_SOLVER_H
+
+/**
+ * C interface to the solver, built into libcubesolver.so by `make lib`,
+ * for calling it in-process from C or through a foreign function
+ * interface.
+ *
+ * Functions only ever change the buffers they're given, never allocate
+ * memory the caller has to free (besides a solver, which
+ * cs_solver_destroy frees), never let an exception out, and report
+ * failure with one of the status codes below. Every function is safe to
+ * call from many threads at once.
+ *
+ * The ABI only grows: existing functions, status codes and option
+ * fields keep their meaning, and new option fields are only added to
+ * the end of cs_options.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define CS_API __declspec(dllexport)
+#else
+#define CS_API __attribute__((visibility("default")))
+#endif
+
+/**
+ * Version of the interface, which goes up whenever something is added.
+ */
+#define CS_ABI_VERSION 2
+
+/**
+ * Status codes returned by every function.
+ */
+#define CS_OK 0
+/* a pointer that's needed is null, or an option is out of range */
+#define CS_ERROR_INVALID_ARGUMENT 1
+/* the input isn't a scramble or a 54 character state */
+#define CS_ERROR_INVALID_CUBE 2
+/* the state can't be solved, or some move can't be made from the allowed moves */
+#define CS_ERROR_UNSOLVABLE 3
+/* the output buffer is too small; the length needed is still reported */
+#define CS_ERROR_BUFFER_TOO_SMALL 4
+/* the table of optimal sequences couldn't be saved or mapped (it's built in memory) */
+#define CS_ERROR_TABLE 5
+/* something unexpected failed inside the library, such as running out of memory */
+#define CS_ERROR_INTERNAL 6
+
+/**
+ * Metrics to optimize solutions for, and sets of moves to write them in
+ * (see Solver/Optimizer.h).
+ */
+#define CS_METRIC_HTM 0
+#define CS_METRIC_QTM 1
+#define CS_METRIC_STM 2
+#define CS_METRIC_ETM 3
+
+#define CS_MOVES_ANY 0
+#define CS_MOVES_FACE_TURNS 1
+#define CS_MOVES_SLICE_TURNS 2
+
+/**
+ * Options for solving. Fill them in with cs_default_options before
+ * changing any, so fields added later keep their defaults.
+ *
+ * Allowed moves is a mask of the outer face turns a robot can make, bit
+ * 3 * face + type, with faces in the order U D F B R L and types in the
+ * order clockwise, counterclockwise, half (0 allows them all). Budget
+ * is how many milliseconds to keep improving the solution for (0 for a
+ * single pass).
+ */
+typedef struct cs_options
+{
+	uint32_t size;
+	uint8_t metric;
+	uint8_t move_set;
+	uint8_t optimize;
+	uint8_t reserved;
+	uint32_t allowed_moves;
+	double budget_ms;
+} cs_options;
+
+/**
+ * Version of the interface the library was built with.
+ */
+CS_API int cs_abi_version(void);
+
+/**
+ * Short description of the given status code.
+ */
+CS_API const char* cs_status_string(int status);
+
+/**
+ * Fill in the default options: optimized in HTM, using any moves.
+ */
+CS_API void cs_default_options(cs_options* options);
+
+/**
+ * Load the table of optimal sequences from the given path, building it
+ * and saving it there first if it isn't there (about 8MB). Optional: the
+ * table is built in memory on the first solve otherwise. Only the first
+ * call has any effect.
+ */
+CS_API int cs_init(const char* table_path);
+
+/**
+ * Solve the cube with the given 54 character state (see
+ * Cube::copyState), or the cube the given scramble leaves, with the
+ * given options (null for the defaults).
+ *
+ * The solution is written to the output buffer as moves separated by
+ * spaces, ending with a null character, and its length (not counting
+ * the null character) is written to length, if it isn't null. If the
+ * buffer is too small, as much as fits is written and the length needed
+ * is still reported.
+ */
+CS_API int cs_solve_state(const char* state, const cs_options* options, char* output, size_t output_size,
+	size_t* length);
+CS_API int cs_solve_moves(const char* scramble, const cs_options* options, char* output, size_t output_size,
+	size_t* length);
+
+/**
+ * Solve each of the given inputs (each a scramble or a 54 character
+ * state) on the given number of threads (0 for one per hardware thread,
+ * 1 for the calling thread only), with the given options (null for the
+ * defaults).
+ *
+ * The solutions are written to the output buffer one after another,
+ * each ending with a null character, with the offset of each written to
+ * offsets and its status to statuses (an input that fails gets an empty
+ * solution). The total length of the output, including the null
+ * characters, is written to length if it isn't null.
+ *
+ * Return CS_OK when every solution was written, even if some inputs
+ * failed, or CS_ERROR_BUFFER_TOO_SMALL (with nothing written but the
+ * length needed) if they don't all fit.
+ */
+CS_API int cs_solve_batch(const char* const* inputs, size_t count, const cs_options* options, size_t threads,
+	char* output, size_t output_size, size_t* offsets, int* statuses, size_t* length);
+
+/**
+ * A solver that keeps its threads between batches, so a caller solving
+ * many batches doesn't start new ones for each (which cs_solve_batch
+ * does). Batches on the same solver from many threads run one at a
+ * time.
+ */
+typedef struct cs_solver cs_solver;
+
+/**
+ * Create a solver with the given number of threads (0 for one per
+ * hardware thread, 1 for the calling thread only), writing it to
+ * solver, and destroy one (null does nothing).
+ */
+CS_API int cs_solver_create(size_t threads, cs_solver** solver);
+CS_API void cs_solver_destroy(cs_solver* solver);
+
+/**
+ * Solve each of the given inputs on the given solver's threads, the same
+ * as cs_solve_batch.
+ */
+CS_API int cs_solver_solve_batch(cs_solver* solver, const char* const* inputs, size_t count, const cs_options* options,
+	char* output, size_t output_size, size_t* offsets, int* statuses, size_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,9 +1,61 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <thread>
 #include <time.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
+#include "Batch.h"
+#include "Cache.h"
+#include "Checkpoint.h"
+#include "Client.h"
+#include "Corpus.h"
+#include "CubeSolver.h"
+#include "Daemon.h"
+#include "Oracle.h"
+#include "Permutation.h"
+#include "PhaseSolver.h"
+#include "Pipeline.h"
+#include "Session.h"
 #include "Solver.h"
+#include "Store.h"
+#include "Symmetry.h"
+
+/**
+ * Number of heap allocations made so far, counted by replacing the
+ * global operator new, so tests can check a path doesn't allocate.
+ */
+std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	void* memory = malloc(size != 0 ? size : 1);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+// gcc can't tell this delete is the one matching the new above
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
 
 /**
  * Generate a random scramble.
@@ -22,6 +74,25 @@ std::string generateScramble()
 	return scramble;
 }
 
+/**
+ * Path in the temporary directory for a scratch file with the given
+ * name, suffixed with this process's id so test runs don't share it.
+ */
+std::string testPath(const std::string& name)
+{
+#ifdef _WIN32
+	const char* dir = getenv("TEMP");
+	const char* fallback = ".";
+	int pid = _getpid();
+#else
+	const char* dir = getenv("TMPDIR");
+	const char* fallback = "/tmp";
+	int pid = (int)getpid();
+#endif
+	std::string path = dir != nullptr && *dir != '\0' ? dir : fallback;
+	return path + "/" + name + "." + std::to_string(pid) + ".test";
+}
+
 /**
  * Test the solver on a sequence of random scrambles.
  *
@@ -72,31 +143,2695 @@ void testRandomScrambles()
 				break;
 			}
 			// printSolution(solution);
-			solutionLengths.push_back(solution.size());
+			solutionLengths.push_back(countMoves(solution, METRIC::HTM));
 		}
 	}
 	float avgLength = (float)std::accumulate(solutionLengths.begin(), solutionLengths.end(), 0) / solutionLengths.size();
 	std::cout << "Average Solution Length: " << avgLength << std::endl;
 }
 
-int main(int argc, char* argv[])
+/**
+ * Test the optimizer on a few sequences with known reductions, then on
+ * random sequences of every kind of move (outer turns, wide turns,
+ * slices and rotations) in every metric and move set.
+ *
+ * Return true if every reduction matched, and every optimized sequence
+ * left the cube in the same state as the original (in some orientation
+ * for the move sets that never rotate the cube) using only moves from
+ * its move set, and was no longer in its metric than the original
+ * whenever the original was already in the move set.
+ */
+bool testOptimizer()
 {
-	// get a scramble from the user
-	std::string scramble;
-	std::cout << "Enter scramble: ";
-	std::getline(std::cin, scramble);
+	const size_t NUM_SEQUENCES = 200;
+	const size_t MAX_SEQUENCE_LENGTH = 30;
 
-	// get the solution
-	Cube c;
-	c.readMoves(scramble);
+	const char* reductions[][2] = { { "R L R'", "L" }, { "U D U", "U2 D" }, { "F B2 F' B2", "" }, { "x U x'", "F" } };
+	for (const auto& reduction : reductions)
+	{
+		Cube original, expected;
+		std::vector<Move> optimized = optimizeSolution(original.readMoves(reduction[0]), METRIC::HTM);
+		if (solutionToString(optimized) != solutionToString(expected.readMoves(reduction[1])))
+		{
+			std::cout << "Optimizing " << reduction[0] << " gave " << solutionToString(optimized) << std::endl;
+			return false;
+		}
+	}
+
+	srand((unsigned int)time(NULL));
+	for (uint8_t m = 0; m <= (uint8_t)METRIC::ETM; m++)
+	{
+		for (uint8_t s = 0; s <= (uint8_t)MOVE_SET::SLICE_TURNS; s++)
+		{
+			METRIC metric = (METRIC)m;
+			MOVE_SET moveSet = (MOVE_SET)s;
+			for (size_t i = 0; i < NUM_SEQUENCES; i++)
+			{
+				std::vector<Move> sequence;
+				// short sequences have fewer rotations to merge, so they show any that make it longer
+				size_t length = 1 + rand() % MAX_SEQUENCE_LENGTH;
+				for (size_t j = 0; j < length; j++)
+					sequence.push_back(Move::fromCode((uint8_t)(rand() % NUM_MOVE_CODES)));
+				std::vector<Move> optimized = optimizeSolution(sequence, metric, moveSet);
+
+				bool valid = true;
+				for (const Move& move : optimized)
+				{
+					if (moveSet == MOVE_SET::FACE_TURNS)
+						valid = valid && move.pieces <= Move::PIECES::LEFT;
+					else if (moveSet == MOVE_SET::SLICE_TURNS)
+						valid = valid && (move.pieces <= Move::PIECES::LEFT ||
+							(move.pieces >= Move::PIECES::M_SLICE && move.pieces <= Move::PIECES::S_SLICE));
+				}
+
+				// the restricted move sets may leave the cube in any orientation
+				Cube original;
+				original.executeMoves(sequence);
+				bool same = false;
+				for (uint8_t r = 0; r < NUM_ROTATIONS && !same; r++)
+				{
+					Cube cube;
+					cube.executeMoves(optimized);
+					cube.executeMove(bottomRotations[r / 4]);
+					cube.executeMove(sideRotations[r % 4]);
+					same = cube == original && (r == 0 || moveSet != MOVE_SET::ANY);
+				}
+
+				// moves already in the move set never get longer
+				std::vector<Move> inSet;
+				for (const Move& move : sequence)
+				{
+					if (moveSet == MOVE_SET::ANY || move.pieces <= Move::PIECES::LEFT ||
+						(moveSet == MOVE_SET::SLICE_TURNS && move.pieces >= Move::PIECES::M_SLICE && move.pieces <= Move::PIECES::S_SLICE))
+						inSet.push_back(move);
+				}
+				std::vector<Move> shortened = optimizeSolution(inSet, metric, moveSet);
+				bool shorter = countMoves(shortened, metric) <= countMoves(inSet, metric);
+				if (!valid || !same || !shorter)
+				{
+					std::vector<Move>& input = shorter ? sequence : inSet;
+					std::cout << "Optimizing " << solutionToString(input) << "in " << metricToString(metric) << " with "
+						<< moveSetToString(moveSet) << " moves gave " << solutionToString(shorter ? optimized : shortened) << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+	std::cout << "All " << NUM_SEQUENCES * 12 << " optimized sequences matched" << std::endl;
+	return true;
+}
+
+/**
+ * Test the peephole pass on random sequences of outer turns and on
+ * optimized solutions, in every metric, after loading the table from a
+ * corrupt file (which should be rebuilt and saved over it). Tables with
+ * an entry that's too long or no empty slot must be refused.
+ *
+ * Return true if the table was rebuilt, bad tables were refused, and
+ * every sequence kept the same cube state without getting any longer.
+ */
+bool testPeephole()
+{
+	const size_t NUM_SEQUENCES = 500;
+	const size_t SEQUENCE_LENGTH = 20;
+
+	// a table cut off after its header, as if saving it was interrupted
+	std::string path = testPath("peephole");
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		std::cout << "Couldn't create " << path << std::endl;
+		return false;
+	}
+	const char header[32] = { 'C', 'S', 'P', 'E', 'E', 'P', '0', '2', 5 };
+	fwrite(header, 1, sizeof(header), file);
+	fclose(file);
+	bool rebuilt = loadPeepholeTable(path);
+	std::vector<uint8_t> table;
+	file = fopen(path.c_str(), "rb");
+	if (file != nullptr)
+	{
+		uint8_t bytes[65536];
+		for (size_t read; (read = fread(bytes, 1, sizeof(bytes), file)) > 0;)
+			table.insert(table.end(), bytes, bytes + read);
+		fclose(file);
+	}
+	remove(path.c_str());
+	if (!rebuilt || !isPeepholeTable(table.data(), table.size()))
+	{
+		std::cout << "Peephole table wasn't rebuilt over a corrupt one" << std::endl;
+		return false;
+	}
+
+	// the rebuilt table with an entry longer than any sequence, and with no empty slot left to stop a lookup
+	uint64_t* entries = (uint64_t*)(table.data() + sizeof(header));
+	size_t capacity = (table.size() - sizeof(header)) / sizeof(uint64_t);
+	size_t used = 0;
+	while (entries[used] == 0)
+		used++;
+	std::vector<uint8_t> tooLong = table;
+	((uint64_t*)(tooLong.data() + sizeof(header)))[used] |= 7;
+	for (size_t slot = 0; slot < capacity; slot++)
+	{
+		if (entries[slot] == 0)
+			entries[slot] = entries[used];
+	}
+	uint64_t full = capacity;
+	memcpy(table.data() + 24, &full, sizeof(full));
+	if (isPeepholeTable(tooLong.data(), tooLong.size()) || isPeepholeTable(table.data(), table.size()))
+	{
+		std::cout << "Peephole table with a bad entry or no empty slot was accepted" << std::endl;
+		return false;
+	}
+
+	srand((unsigned int)time(NULL));
+	for (size_t i = 0; i < NUM_SEQUENCES; i++)
+	{
+		std::vector<Move> sequence;
+		if (i % 2 == 0)
+		{
+			for (size_t j = 0; j < SEQUENCE_LENGTH; j++)
+				sequence.push_back(Move::fromCode((uint8_t)(rand() % NUM_FACE_CODES)));
+		}
+		else
+		{
+			Cube scrambled;
+			scrambled.readMoves(generateScramble());
+			sequence = solve(scrambled, SolveOptions()).toMoves();
+		}
+		Cube original;
+		original.executeMoves(sequence);
+
+		for (uint8_t m = 0; m <= (uint8_t)METRIC::ETM; m++)
+		{
+			METRIC metric = (METRIC)m;
+			std::vector<Move> shortened = peepholeSolution(sequence, metric);
+			Cube cube;
+			cube.executeMoves(shortened);
+			if (!(cube == original) || countMoves(shortened, metric) > countMoves(sequence, metric))
+			{
+				std::cout << "Peephole pass on " << solutionToString(sequence) << "in " << metricToString(metric)
+					<< " gave " << solutionToString(shortened) << std::endl;
+				return false;
+			}
+		}
+	}
+	std::cout << "All " << NUM_SEQUENCES << " peephole sequences kept their state" << std::endl;
+	return true;
+}
+
+/**
+ * Test restricted solving on random scrambles: without B, without half
+ * turns, and with only clockwise turns of U, R, F, D and L.
+ *
+ * Return true if every solution used only the allowed moves and solved
+ * its cube.
+ */
+bool testRestrictedSolves()
+{
+	const size_t NUM_CUBES = 200;
+
+	const uint32_t allowed[3] = {
+		ALL_FACE_MOVES & ~faceMoveMask(Cube().readMoves("B B' B2")),
+		faceMoveMask(Cube().readMoves("U U' D D' F F' B B' R R' L L'")),
+		faceMoveMask(Cube().readMoves("U R F D L"))
+	};
+	srand((unsigned int)time(NULL));
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube scrambled;
+		scrambled.readMoves(generateScramble());
+		for (uint32_t moves : allowed)
+		{
+			SolveOptions options;
+			options.restriction.allowed = moves;
+			std::vector<Move> solution = solve(scrambled, options).toMoves();
+			bool valid = true;
+			for (const Move& move : solution)
+				valid = valid && move.type != Move::TYPE::NO_MOVE && move.pieces <= Move::PIECES::LEFT &&
+					options.restriction.isAllowed(move);
+			Cube cube = scrambled;
+			cube.executeMoves(solution);
+			if (!valid || !cube.isSolved())
+			{
+				std::cout << "Restricted solution " << solutionToString(solution) << "didn't use only allowed moves"
+					<< std::endl;
+				return false;
+			}
+		}
+	}
+	std::cout << "All " << NUM_CUBES * 3 << " restricted solutions used only allowed moves" << std::endl;
+	return true;
+}
+
+/**
+ * Test robot schedules for random sequences of outer turns and for
+ * solutions with wide turns, slices and rotations in them.
+ *
+ * Return true if every schedule turned the sequence's moves in order,
+ * only ever two at once when they're on opposite faces, with each step
+ * starting once the one before it settled, and took as long as
+ * scheduledTime predicts. Sequences that leave the cube rotated can't
+ * be scheduled.
+ */
+bool testRobotSchedules()
+{
+	const size_t NUM_SEQUENCES = 500;
+	const size_t SEQUENCE_LENGTH = 30;
+
+	RobotTiming timing(100, 160, 10);
+	Cube parser;
+	if (scheduleSolution(parser.readMoves("R y"), timing).valid || scheduledTime(parser.readMoves("y"), timing) != UINT32_MAX ||
+		scheduleToString(scheduleSolution(parser.readMoves("x U x' R L' U2 D"), timing)) != "0:F 110:R+L' 220:U2+D ")
+	{
+		std::cout << "Scheduled a sequence that rotates the cube" << std::endl;
+		return false;
+	}
+
+	srand((unsigned int)time(NULL));
+	for (size_t i = 0; i < NUM_SEQUENCES; i++)
+	{
+		std::vector<Move> sequence;
+		if (i % 2 == 0)
+		{
+			for (size_t j = 0; j < SEQUENCE_LENGTH; j++)
+				sequence.push_back(Move::fromCode((uint8_t)(rand() % NUM_FACE_CODES)));
+		}
+		else
+		{
+			Cube scrambled;
+			scrambled.readMoves(generateScramble());
+			SolveOptions options;
+			options.metric = METRIC::STM;
+			// undo the rotation it leaves the cube in, so the robot can perform it
+			sequence = solve(scrambled, options).toMoves();
+			Cube rotated = scrambled;
+			rotated.executeMoves(sequence);
+			for (uint8_t r = 0; r < NUM_ROTATIONS && !(rotated == Cube()); r++)
+			{
+				Cube cube = rotated;
+				cube.executeMove(bottomRotations[r / 4]);
+				cube.executeMove(sideRotations[r % 4]);
+				if (cube == Cube())
+				{
+					sequence.push_back(bottomRotations[r / 4]);
+					sequence.push_back(sideRotations[r % 4]);
+					rotated = cube;
+				}
+			}
+		}
+
+		Schedule schedule = scheduleSolution(sequence, timing);
+		std::vector<Move> scheduled;
+		uint32_t time = 0;
+		bool valid = schedule.valid;
+		for (const ScheduleStep& step : schedule.steps)
+		{
+			valid = valid && step.start == time && (step.count == 1 || (step.count == 2 &&
+				((uint8_t)step.moves[0].pieces ^ 1) == (uint8_t)step.moves[1].pieces));
+			for (uint8_t m = 0; m < step.count; m++)
+				scheduled.push_back(step.moves[m]);
+			time += step.duration + timing.settle;
+		}
+		Cube original, performed;
+		original.executeMoves(sequence);
+		performed.executeMoves(scheduled);
+		valid = valid && original == performed && schedule.time == time && scheduledTime(sequence, timing) == time &&
+			(i % 2 == 1 || scheduled.size() == sequence.size());
+		if (!valid)
+		{
+			std::cout << "Schedule " << scheduleToString(schedule) << "didn't match " << solutionToString(sequence) << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_SEQUENCES << " schedules matched their moves" << std::endl;
+	return true;
+}
+
+/**
+ * Test that solving from many threads at once gives exactly the
+ * same solutions as solving one cube at a time.
+ *
+ * Scrambles are solved with a few different options, first one at a
+ * time and then again split across 16 threads.
+ *
+ * Return true if every solution matched.
+ */
+bool testConcurrentSolves()
+{
+	const size_t NUM_CUBES = 2000;
+	const size_t NUM_THREADS = 16;
+
+	// solve with the default options, in face turns, and for a robot without a back face
+	SolveOptions optionSets[3];
+	optionSets[1].metric = METRIC::QTM;
+	optionSets[1].moveSet = MOVE_SET::FACE_TURNS;
+	optionSets[2].restriction.allowed = ALL_FACE_MOVES & ~faceMoveMask(Cube().readMoves("B B' B2"));
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_CUBES);
+	std::vector<Solution> expected(NUM_CUBES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		cubes[i].readMoves(generateScramble());
+		expected[i] = solve(cubes[i], optionSets[i % 3]);
+	}
+
+	std::vector<Solution> results(NUM_CUBES);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < NUM_THREADS; t++)
+	{
+		threads.push_back(std::thread([&, t]() {
+			for (size_t i = t; i < NUM_CUBES; i += NUM_THREADS)
+				results[i] = solve(cubes[i], optionSets[i % 3]);
+		}));
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube check = cubes[i];
+		check.executeMoves(results[i].toMoves());
+		if (!results[i].solved || !check.isSolved() || results[i].moves != expected[i].moves)
+		{
+			std::cout << "Concurrent solve " << i << " didn't match" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " concurrent solves matched on " << NUM_THREADS << " threads" << std::endl;
+	return true;
+}
+
+/**
+ * Test the thread pool on loops of every size from empty to many times
+ * its number of threads, with uneven work, then solve a batch on it.
+ *
+ * Return true if every loop visited each index exactly once, and every
+ * batch solution matched solving its cube on its own.
+ */
+bool testBatchSolves()
+{
+	const size_t NUM_CUBES = 500;
+	const size_t loopCounts[] = { 0, 1, 3, 15, 16, 17, 1000, 100000 };
+	const size_t poolSizes[] = { 1, 4, 16 };
+
+	for (size_t threads : poolSizes)
+	{
+		ThreadPool pool(threads);
+		for (size_t count : loopCounts)
+		{
+			std::unique_ptr<std::atomic<uint32_t>[]> visits(new std::atomic<uint32_t>[count + 1]);
+			for (size_t i = 0; i <= count; i++)
+				visits[i] = 0;
+			// every seventh index takes longer, so ranges get stolen
+			pool.parallelFor(count, [&visits](size_t i) {
+				if (i % 7 == 0)
+					std::this_thread::sleep_for(std::chrono::microseconds(20));
+				visits[i]++;
+			});
+			for (size_t i = 0; i <= count; i++)
+			{
+				if (visits[i] != (i < count ? 1u : 0u))
+				{
+					std::cout << "Loop of " << count << " on " << threads << " threads visited " << i << " "
+						<< visits[i] << " times" << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	SolveOptions options;
+	options.metric = METRIC::QTM;
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+	std::vector<Solution> solutions(NUM_CUBES);
+	ThreadPool pool(4);
+	BatchStats stats = solveBatch(cubes.data(), NUM_CUBES, options, solutions.data(), pool);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Solution expected = solve(cubes[i], options);
+		if (stats.count != NUM_CUBES || !solutions[i].solved || solutions[i].moves != expected.moves)
+		{
+			std::cout << "Batch solve " << i << " didn't match" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All pool loops visited each index once, and all " << NUM_CUBES << " batch solves matched" << std::endl;
+	return true;
+}
+
+/**
+ * Test that solving into move buffers and writing the solutions into
+ * a char buffer never allocates, once the first solve has warmed up
+ * the thread's arena and loaded the tables.
+ *
+ * Return true if every solve succeeded without allocating.
+ */
+bool testAllocationFreeSolves()
+{
+	const size_t NUM_CUBES = 1000;
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+
+	SolveOptions options;
+	MoveBuffer solution;
+	char text[MOVE_BUFFER_CAPACITY * (MOVE_CHARS + 1) + 1];
+	solve(cubes[0], options, solution);
+
+	size_t allocations = allocationCount.load();
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		options.metric = i % 2 ? METRIC::QTM : METRIC::HTM;
+		if (!solve(cubes[i], options, solution))
+		{
+			std::cout << "Allocation-free solve " << i << " failed" << std::endl;
+			return false;
+		}
+		solutionToString(solution.data(), solution.size(), text, sizeof(text));
+	}
+	allocations = allocationCount.load() - allocations;
+	if (allocations != 0)
+	{
+		std::cout << NUM_CUBES << " allocation-free solves made " << allocations << " allocations" << std::endl;
+		return false;
+	}
+
+	// check the solutions match the allocating version
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		options.metric = i % 2 ? METRIC::QTM : METRIC::HTM;
+		solve(cubes[i], options, solution);
+		solutionToString(solution.data(), solution.size(), text, sizeof(text));
+		if (solutionToString(solve(cubes[i], options).toMoves()) != text)
+		{
+			std::cout << "Allocation-free solve " << i << " didn't match" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " solves made no allocations" << std::endl;
+	return true;
+}
+
+/**
+ * Test that anytime solves always solve the cube, never come out longer
+ * than the usual solution however small their budget, and give up when
+ * cancelled. Robot solves are only checked for solving the cube, since
+ * without a budget they try every orientation.
+ *
+ * Return true if every anytime solve was valid.
+ */
+bool testAnytimeSolves()
+{
+	const size_t NUM_CUBES = 40;
+	const double SHORT_BUDGET = 0.0005;
+	const double LONG_BUDGET = 0.02;
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	SolveOptions robotOptions;
+	robotOptions.restriction.allowed = ALL_FACE_MOVES & ~faceMoveMask(Cube().readMoves("B B' B2"));
+	size_t usualTotal = 0;
+	size_t shortTotal = 0;
+	size_t longTotal = 0;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		size_t usual = countMoves(solve(cube, options).toMoves(), options.metric);
+
+		size_t lengths[2];
+		for (uint8_t b = 0; b < 2; b++)
+		{
+			SolveOptions anytimeOptions = i % 4 == 3 ? robotOptions : options;
+			anytimeOptions.budget = b == 0 ? SHORT_BUDGET : LONG_BUDGET;
+			Solution solution = solve(cube, anytimeOptions);
+
+			Cube check = cube;
+			check.executeMoves(solution.toMoves());
+			bool valid = solution.solved && check.isSolved() && solution.numPhases == MAX_PHASES &&
+				solution.phases[MAX_PHASES - 1].end == solution.size();
+			if (!valid)
+			{
+				std::cout << "Anytime solve " << i << " with a budget of " << anytimeOptions.budget * 1000
+					<< " ms was invalid" << std::endl;
+				return false;
+			}
+			lengths[b] = countMoves(solution.toMoves(), anytimeOptions.metric);
+		}
+		if (i % 4 == 3)
+			continue;
+		if (lengths[0] > usual || lengths[1] > usual)
+		{
+			std::cout << "Anytime solve " << i << " was longer than the usual solution (" << usual << ", " << lengths[0]
+				<< ", " << lengths[1] << " moves)" << std::endl;
+			return false;
+		}
+		usualTotal += usual;
+		shortTotal += lengths[0];
+		longTotal += lengths[1];
+	}
+
+	std::atomic<bool> cancel(true);
+	options.budget = LONG_BUDGET;
+	options.cancel = &cancel;
+	Cube cancelled;
+	cancelled.readMoves(generateScramble());
+	if (solve(cancelled, options).solved)
+	{
+		std::cout << "Cancelled anytime solve was solved" << std::endl;
+		return false;
+	}
+
+	size_t counted = NUM_CUBES - NUM_CUBES / 4;
+	std::cout << "All " << NUM_CUBES << " anytime solves were valid (average " << (double)usualTotal / counted
+		<< " moves, " << (double)shortTotal / counted << " in " << SHORT_BUDGET * 1000 << " ms, "
+		<< (double)longTotal / counted << " in " << LONG_BUDGET * 1000 << " ms)" << std::endl;
+	return true;
+}
 
-	std::vector<Move> solution = solve(c);
-	std::cout << "\nSolution:\n\n";
-	printSolution(solution);
+/**
+ * Phases streamed from a solve, and when the first move arrived.
+ */
+struct StreamedPhases
+{
+	std::vector<PhaseMoves> phases;
+	std::vector<Move> moves;
+	std::chrono::steady_clock::time_point firstMove;
+};
+
+/**
+ * Keep a streamed phase, noting the time if it has the first move.
+ */
+void receivePhase(const PhaseMoves& phase, void* context)
+{
+	StreamedPhases& streamed = *(StreamedPhases*)context;
+	if (streamed.moves.empty() && !phase.moves.empty())
+		streamed.firstMove = std::chrono::steady_clock::now();
+	streamed.phases.push_back(phase);
+	streamed.moves.insert(streamed.moves.end(), phase.moves.begin(), phase.moves.end());
+}
+
+/**
+ * Test that streaming a solve a phase at a time gives every phase in
+ * order, with moves that solve the cube and the same last layer cases
+ * as solving it in one go, for the default options, face turns in
+ * quarter turn metric, unoptimized solves and a robot without a back
+ * face, and that a cancelled stream stops.
+ *
+ * Return true if every stream was valid.
+ */
+bool testPhaseStreaming()
+{
+	const size_t NUM_CUBES = 400;
+	const PHASE order[MAX_PHASES] = { PHASE::CROSS, PHASE::F2L, PHASE::F2L, PHASE::F2L, PHASE::F2L, PHASE::OLL, PHASE::PLL };
+
+	SolveOptions optionSets[4];
+	optionSets[1].metric = METRIC::QTM;
+	optionSets[1].moveSet = MOVE_SET::FACE_TURNS;
+	optionSets[2].optimize = false;
+	optionSets[3].restriction.allowed = ALL_FACE_MOVES & ~faceMoveMask(Cube().readMoves("B B' B2"));
+
+	srand((unsigned int)time(NULL));
+	size_t streamedLength = 0;
+	size_t solvedLength = 0;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		const SolveOptions& options = optionSets[i % 4];
+		Cube cube;
+		cube.readMoves(generateScramble());
+		StreamedPhases streamed;
+		bool solved = solveByPhase(cube, options, receivePhase, &streamed);
+
+		Cube check = cube;
+		check.executeMoves(streamed.moves);
+		bool valid = solved && check.isSolved() && streamed.phases.size() == MAX_PHASES;
+		for (size_t p = 0; p < streamed.phases.size() && valid; p++)
+			valid = streamed.phases[p].phase == order[p];
+		for (const Move& move : streamed.moves)
+		{
+			if (options.moveSet == MOVE_SET::FACE_TURNS || i % 4 == 3)
+				valid = valid && move.pieces <= Move::PIECES::LEFT;
+			if (i % 4 == 3)
+				valid = valid && (options.restriction.allowed & (1u << faceMoveIndex(move))) != 0;
+		}
+		if (valid && i % 4 != 3)
+		{
+			Solution solution = solve(cube, options);
+			valid = streamed.phases[5].llCase.id == solution.oll.id && streamed.phases[6].llCase.id == solution.pll.id;
+			if (i % 4 == 0)
+			{
+				streamedLength += countMoves(streamed.moves, options.metric);
+				solvedLength += countMoves(solution.toMoves(), options.metric);
+			}
+		}
+		if (!valid)
+		{
+			std::cout << "Streamed solve " << i << " was invalid" << std::endl;
+			return false;
+		}
+	}
+
+	std::atomic<bool> cancel(true);
+	SolveOptions cancelled;
+	cancelled.cancel = &cancel;
+	StreamedPhases streamed;
+	if (solveByPhase(Cube(), cancelled, receivePhase, &streamed) || !streamed.phases.empty())
+	{
+		std::cout << "Cancelled stream wasn't stopped" << std::endl;
+		return false;
+	}
+
+	std::cout << "All " << NUM_CUBES << " streamed solves were valid (" << (double)streamedLength / (NUM_CUBES / 4)
+		<< " moves on average, against " << (double)solvedLength / (NUM_CUBES / 4) << " solved in one go)" << std::endl;
+	return true;
+}
 
-	solution = cleanSolution(solution, true);
-	std::cout << "\nOptimized:\n\n";
-	printSolution(solution);
+/**
+ * Test the C interface: that its solutions match solve's, for scrambles
+ * and states, alone and in a batch on one or many threads, and that bad
+ * inputs, bad options and small buffers give the right status codes.
+ *
+ * Return true if every call gave what was expected.
+ */
+bool testCInterface()
+{
+	const size_t NUM_CUBES = 200;
+
+	srand((unsigned int)time(NULL));
+	std::vector<std::string> inputs(NUM_CUBES);
+	std::vector<std::string> expected(NUM_CUBES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		inputs[i] = generateScramble();
+		cube.readMoves(inputs[i]);
+		if (i % 2 == 1)
+			cube.writeState(inputs[i]);
+		expected[i] = solutionToString(solve(cube, SolveOptions()).toMoves());
+		// the C interface leaves off the trailing space
+		if (!expected[i].empty())
+			expected[i].pop_back();
+	}
+	// a solved state with its up front right corner twisted, and something that's neither
+	std::string twisted = "WWWWWWWWWYYYYYYYYYRRRRRRRRROOOOOOOOOBBBBBBBBBGGGGGGGGG";
+	std::swap(twisted[8], twisted[20]);
+	std::swap(twisted[20], twisted[36]);
+	inputs.push_back(twisted);
+	inputs.push_back("R U Q");
+
+	char output[MOVE_BUFFER_CAPACITY * (MOVE_CHARS + 1) + 1];
+	size_t length;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		int status = i % 2 == 0 ? cs_solve_moves(inputs[i].c_str(), nullptr, output, sizeof(output), &length) :
+			cs_solve_state(inputs[i].c_str(), nullptr, output, sizeof(output), &length);
+		if (status != CS_OK || length != expected[i].size() || expected[i] != output)
+		{
+			std::cout << "C solve " << i << " didn't match (" << cs_status_string(status) << ")" << std::endl;
+			return false;
+		}
+	}
+
+	cs_options options;
+	cs_default_options(&options);
+	options.metric = 7;
+	bool valid = cs_solve_moves(inputs[0].c_str(), nullptr, output, 4, &length) == CS_ERROR_BUFFER_TOO_SMALL &&
+		length == expected[0].size() && strlen(output) == 3 &&
+		cs_solve_state(inputs[0].c_str(), nullptr, output, sizeof(output), &length) == CS_ERROR_INVALID_CUBE &&
+		cs_solve_moves(inputs[1].c_str(), nullptr, output, sizeof(output), &length) == CS_ERROR_INVALID_CUBE &&
+		cs_solve_state(inputs[NUM_CUBES].c_str(), nullptr, output, sizeof(output), &length) == CS_ERROR_UNSOLVABLE &&
+		cs_solve_moves(inputs[NUM_CUBES + 1].c_str(), nullptr, output, sizeof(output), &length) == CS_ERROR_INVALID_CUBE &&
+		cs_solve_moves(nullptr, nullptr, output, sizeof(output), &length) == CS_ERROR_INVALID_ARGUMENT &&
+		cs_solve_moves(inputs[0].c_str(), &options, output, sizeof(output), &length) == CS_ERROR_INVALID_ARGUMENT;
+	if (!valid)
+	{
+		std::cout << "C interface gave the wrong status for a bad call" << std::endl;
+		return false;
+	}
+
+	std::vector<const char*> batch;
+	for (const std::string& input : inputs)
+		batch.push_back(input.c_str());
+	std::vector<size_t> offsets(batch.size());
+	std::vector<int> statuses(batch.size());
+	// batches on one and all threads, then two batches on the same solver
+	cs_solver* solver;
+	if (cs_solver_create(0, &solver) != CS_OK)
+	{
+		std::cout << "C solver couldn't be created" << std::endl;
+		return false;
+	}
+	for (size_t run = 0; run < 4; run++)
+	{
+		size_t threads = run == 0 ? 1 : 0;
+		auto solveAll = [&](char* output, size_t size) {
+			return run < 2 ? cs_solve_batch(batch.data(), batch.size(), nullptr, threads, output, size,
+				offsets.data(), statuses.data(), &length) :
+				cs_solver_solve_batch(solver, batch.data(), batch.size(), nullptr, output, size, offsets.data(),
+					statuses.data(), &length);
+		};
+		std::vector<char> text;
+		int status = solveAll(nullptr, 0);
+		if (status == CS_ERROR_BUFFER_TOO_SMALL)
+		{
+			text.resize(length);
+			status = solveAll(text.data(), text.size());
+		}
+		valid = status == CS_OK && length == text.size() && statuses[NUM_CUBES] == CS_ERROR_UNSOLVABLE &&
+			statuses[NUM_CUBES + 1] == CS_ERROR_INVALID_CUBE && text[offsets[NUM_CUBES]] == '\0';
+		for (size_t i = 0; i < NUM_CUBES && valid; i++)
+			valid = statuses[i] == CS_OK && expected[i] == text.data() + offsets[i];
+		if (!valid)
+		{
+			std::cout << "C batch " << run << " didn't match" << std::endl;
+			cs_solver_destroy(solver);
+			return false;
+		}
+	}
+	cs_solver_destroy(solver);
+	if (cs_solver_create(0, nullptr) != CS_ERROR_INVALID_ARGUMENT ||
+		cs_solver_solve_batch(nullptr, batch.data(), batch.size(), nullptr, nullptr, 0, offsets.data(),
+			statuses.data(), &length) != CS_ERROR_INVALID_ARGUMENT)
+	{
+		std::cout << "C solver gave the wrong status for a bad call" << std::endl;
+		return false;
+	}
+	std::cout << "All " << NUM_CUBES << " C interface solves matched, alone, in batches and on a solver" << std::endl;
+	return true;
+}
+
+/**
+ * Test that every solution's phases cover its moves in order, and that
+ * the last layer cases recognized are valid.
+ *
+ * Return true if every solution's phases and cases were valid.
+ */
+bool testSolutionPhases()
+{
+	const size_t NUM_CUBES = 2000;
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	bool ollSeen[NUM_OLLS] = {};
+	bool pllSeen[NUM_PLLS] = {};
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		options.optimize = i % 2 == 0;
+		Solution solution = solve(cube, options);
+
+		bool valid = solution.solved && solution.numPhases == MAX_PHASES && solution.phases[0].begin == 0 &&
+			solution.phases[MAX_PHASES - 1].end == solution.size();
+		for (uint8_t p = 0; p < solution.numPhases && valid; p++)
+		{
+			const PhaseSpan& span = solution.phases[p];
+			valid = span.begin <= span.end && (p == 0 || span.begin == solution.phases[p - 1].end);
+		}
+		valid = valid && (solution.oll.id < NUM_OLLS || solution.oll.id == NO_CASE) && solution.oll.preAUF < 4 &&
+			(solution.pll.id < NUM_PLLS || solution.pll.id == NO_CASE) && solution.pll.preAUF < 4 && solution.pll.postAUF < 4;
+		if (!valid)
+		{
+			std::cout << "Solution " << i << " has invalid phases or cases" << std::endl;
+			return false;
+		}
+		if (solution.oll.id != NO_CASE)
+			ollSeen[solution.oll.id] = true;
+		if (solution.pll.id != NO_CASE)
+			pllSeen[solution.pll.id] = true;
+	}
+	std::cout << "All " << NUM_CUBES << " solutions had valid phases (" << std::accumulate(ollSeen, ollSeen + NUM_OLLS, 0)
+		<< " OLLs and " << std::accumulate(pllSeen, pllSeen + NUM_PLLS, 0) << " PLLs seen)" << std::endl;
+	return true;
+}
+
+/**
+ * Test that solutions come back unchanged after packing them in the
+ * batch wire format, with moves that are packed directly (face turns
+ * and slices) and escaped (wide turns and rotations, which unoptimized
+ * solutions have).
+ *
+ * Report how many bytes each solution took.
+ *
+ * Return true if every solution came back the same.
+ */
+bool testPackedSolutions()
+{
+	const size_t NUM_CUBES = 2000;
+
+	SolveOptions optionSets[3];
+	optionSets[1].metric = METRIC::STM;
+	optionSets[1].moveSet = MOVE_SET::SLICE_TURNS;
+	optionSets[2].optimize = false;
+
+	srand((unsigned int)time(NULL));
+	std::vector<Solution> solutions(NUM_CUBES);
+	size_t numMoves = 0;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		solutions[i] = solve(cube, optionSets[i % 3]);
+		numMoves += solutions[i].size();
+	}
+
+	std::vector<uint8_t> bytes;
+	packBatch(solutions.data(), solutions.size(), bytes);
+	std::vector<Solution> unpacked;
+	if (!unpackBatch(bytes.data(), bytes.size(), unpacked) || unpacked.size() != NUM_CUBES)
+	{
+		std::cout << "Packed batch couldn't be read back" << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		if (unpacked[i].moves != solutions[i].moves || unpacked[i].solved != solutions[i].solved)
+		{
+			std::cout << "Packed solution " << i << " didn't match" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " packed solutions matched (" << (double)bytes.size() / NUM_CUBES
+		<< " bytes per solution, " << bytes.size() * 8.0 / numMoves << " bits per move)" << std::endl;
+	return true;
+}
+
+/**
+ * Test solving packed states (as the web build's batches do), on the
+ * calling thread and across a pool, against solving each cube alone,
+ * with a state that isn't valid in the middle of the batch.
+ *
+ * Return true if every solution matched, and the invalid state's
+ * solution was unsolved.
+ */
+bool testPackedStates()
+{
+	const size_t NUM_CUBES = 500;
+	const size_t INVALID = NUM_CUBES / 2;
+
+	srand((unsigned int)time(NULL));
+	std::vector<uint8_t> states(NUM_CUBES * PACKED_STATE_BYTES);
+	std::vector<Solution> expected(NUM_CUBES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		packState(cube, &states[i * PACKED_STATE_BYTES]);
+		expected[i] = solve(cube, SolveOptions());
+	}
+	// every sticker of the invalid state is empty
+	memset(&states[INVALID * PACKED_STATE_BYTES], 0, PACKED_STATE_BYTES);
+
+	ThreadPool pool(4);
+	for (ThreadPool* batchPool : { (ThreadPool*)nullptr, &pool })
+	{
+		std::vector<uint8_t> bytes;
+		solvePacked(states.data(), NUM_CUBES, SolveOptions(), batchPool, bytes);
+		std::vector<Solution> solutions;
+		bool valid = unpackBatch(bytes.data(), bytes.size(), solutions) && solutions.size() == NUM_CUBES &&
+			!solutions[INVALID].solved && solutions[INVALID].size() == 0;
+		for (size_t i = 0; i < NUM_CUBES && valid; i++)
+			valid = i == INVALID || (solutions[i].solved && solutions[i].moves == expected[i].moves);
+		if (!valid)
+		{
+			std::cout << "Packed states solved " << (batchPool == nullptr ? "alone" : "on a pool")
+				<< " didn't match" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " packed states matched, alone and on a pool" << std::endl;
+	return true;
+}
+
+/**
+ * Check the given solution solves the given cube.
+ */
+bool solvesCube(const Cube& cube, const Solution& solution)
+{
+	Cube solved = cube;
+	solved.executeMoves(solution.toMoves());
+	return solution.solved && solved.isSolved();
+}
+
+/**
+ * Test sessions on random scrambles, as a front end would use them:
+ * following part of a solution, straying a few moves from it, sending a
+ * state one turn off it, then scrambling the cube again.
+ *
+ * Return true if every answer solved its cube, and following the
+ * solution gave the rest of it.
+ */
+bool testSessions()
+{
+	const size_t NUM_CUBES = 300;
+
+	srand((unsigned int)time(NULL));
+	SolverSession session;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		session.setState(cube);
+		Solution first = session.solve();
+		bool valid = solvesCube(session.cube(), first);
+
+		size_t followed = first.size() > 0 ? rand() % first.size() : 0;
+		for (size_t m = 0; m < followed; m++)
+			session.apply(first.move(m));
+		valid = valid && session.solve().moves == std::vector<uint8_t>(first.moves.begin() + followed, first.moves.end());
+
+		for (int m = rand() % 3; m >= 0; m--)
+			session.apply(Move::fromCode(rand() % NUM_FACE_CODES));
+		valid = valid && solvesCube(session.cube(), session.solve());
+
+		Cube nearby = session.cube();
+		nearby.executeMove(Move::fromCode(rand() % NUM_FACE_CODES));
+		session.setState(nearby);
+		const Solution& nearbySolution = session.solve();
+		valid = valid && solvesCube(session.cube(), nearbySolution) &&
+			(nearbySolution.size() == 0 || session.hint().code() == nearbySolution.moves[0]);
+
+		session.apply(generateScramble());
+		valid = valid && solvesCube(session.cube(), session.solve());
+		if (!valid)
+		{
+			std::cout << "Session on cube " << i << " gave a wrong solution" << std::endl;
+			return false;
+		}
+	}
+
+	const SessionStats& stats = session.stats();
+	if (stats.reused == 0)
+	{
+		std::cout << "Session never reused a solution" << std::endl;
+		return false;
+	}
+	std::cout << "All " << NUM_CUBES << " sessions solved every cube (" << stats.solves << " solved from scratch, "
+		<< stats.followed << " followed, " << stats.reused << " reused)" << std::endl;
+	return true;
+}
+
+/**
+ * Test hints on random scrambles: while the cross isn't done, each hint
+ * must take it one turn closer, and following every hint must solve the
+ * cube, with the lower bound never above the moves it took. Distances
+ * are checked against the cross of a fresh solve.
+ *
+ * Return true if every scramble was solved by its hints.
+ */
+bool testHints()
+{
+	const size_t NUM_CUBES = 300;
+	const size_t MAX_STEPS = 200;
+
+	srand((unsigned int)time(NULL));
+	HintOracle oracle;
+	Cube solved;
+	Hint done = oracle.hint(solved);
+	if (distanceLowerBound(solved) != 0 || done.estimate != 0 || done.next.type != Move::TYPE::NO_MOVE)
+	{
+		std::cout << "Hint for a solved cube wasn't empty" << std::endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		uint8_t bound = distanceLowerBound(cube);
+		Cube downCross = cube;
+		MoveBuffer crossMoves;
+		solveCross(downCross, crossMoves);
+		bool valid = crossDistance(cube, FACE::DOWN) <= crossMoves.size();
+
+		size_t steps = 0;
+		for (; steps < MAX_STEPS && valid && !cube.isSolved(); steps++)
+		{
+			Hint hint = oracle.hint(cube);
+			valid = hint.next.type != Move::TYPE::NO_MOVE && hint.lowerBound == distanceLowerBound(cube);
+			Cube next = cube;
+			next.executeMove(hint.next);
+			if (hint.phase == PHASE::CROSS)
+				valid = valid && crossDistance(next, findCenter(next, hint.crossColor)) + 1 == hint.crossDistance;
+			cube = next;
+		}
+		if (!valid || !cube.isSolved() || steps < bound)
+		{
+			std::cout << "Hints for cube " << i << " didn't solve it" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " cubes solved by following hints" << std::endl;
+	return true;
+}
+
+/**
+ * Test composing and inverting cubes, and solving between random pairs
+ * of scrambles, held in random orientations.
+ *
+ * Return true if composing matched making the moves, a cube composed
+ * with its inverse was solved, and every solution took its first cube
+ * to the second.
+ */
+bool testSolveBetween()
+{
+	const size_t NUM_CUBES = 300;
+	const char* rotations[] = { "", "x", "y'", "z2", "x y" };
+
+	srand((unsigned int)time(NULL));
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube from;
+		from.readMoves(rotations[rand() % 5]);
+		from.readMoves(generateScramble());
+		std::string moves = std::string(rotations[rand() % 5]) + " " + generateScramble();
+		Cube to;
+		to.readMoves(moves);
+
+		// composing with the second cube makes the moves that lead to it
+		Cube composed = from;
+		composed.compose(to);
+		Cube moved = from;
+		moved.readMoves(moves);
+		Cube identity = from;
+		identity.compose(from.inverse());
+		bool valid = composed == moved && identity == Cube() && from.inverse().inverse() == from;
+
+		Solution solution = solveBetween(from, to);
+		Cube solved = from;
+		solved.executeMoves(solution.toMoves());
+		if (!valid || !solution.solved || !(solved == to))
+		{
+			std::cout << "Solving between cube " << i << " and the next didn't reach it" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " cubes were solved to another" << std::endl;
+	return true;
+}
+
+/**
+ * Test permutations on random scrambles against making the moves: the
+ * permutation of a scramble, its cube, and the cube's own permutation
+ * must agree, and composing, inverting, powers, conjugates and
+ * commutators must match the moves they stand for. A state that can't be
+ * reached must still give a rearrangement that inverts.
+ *
+ * Return true if every permutation matched its moves.
+ */
+bool testPermutations()
+{
+	const size_t NUM_CUBES = 300;
+
+	srand((unsigned int)time(NULL));
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube first;
+		std::vector<Move> firstMoves = first.readMoves(generateScramble());
+		Cube second;
+		std::vector<Move> secondMoves = second.readMoves(generateScramble());
+		Permutation a(firstMoves);
+		Permutation b(secondMoves);
+		bool valid = a.toCube() == first && Permutation(first) == a && a.compose(a.inverse()) == Permutation();
+
+		// a b a' b', and a b a' and a four times in a row
+		std::vector<Move> commutator = firstMoves;
+		commutator.insert(commutator.end(), secondMoves.begin(), secondMoves.end());
+		for (size_t m = firstMoves.size(); m-- > 0;)
+			commutator.push_back(firstMoves[m].inverse());
+		std::vector<Move> conjugate = commutator;
+		for (size_t m = secondMoves.size(); m-- > 0;)
+			commutator.push_back(secondMoves[m].inverse());
+		conjugate.erase(conjugate.begin() + firstMoves.size(), conjugate.begin() + firstMoves.size() + secondMoves.size());
+		conjugate.insert(conjugate.begin() + firstMoves.size(), secondMoves.begin(), secondMoves.end());
+		Cube repeated;
+		for (int n = 0; n < 4; n++)
+			repeated.executeMoves(firstMoves);
+		Cube moved;
+		moved.executeMoves(commutator);
+		Cube conjugated;
+		conjugated.executeMoves(conjugate);
+
+		valid = valid && Permutation::commutator(a, b).toCube() == moved && b.conjugate(a).toCube() == conjugated &&
+			a.power(4).toCube() == repeated && a.power(-4) == a.power(4).inverse() && a.power(0) == Permutation();
+
+		// a state that can't be reached, with a few stickers recolored, must still give a rearrangement
+		std::string state;
+		first.writeState(state);
+		for (int n = 1 + rand() % 4; n > 0; n--)
+			state[rand() % state.size()] = "WYROBG"[rand() % 6];
+		Cube broken;
+		broken.copyState(state);
+		Permutation c(broken);
+		valid = valid && c.compose(c.inverse()) == Permutation() && c.inverse().compose(c) == Permutation();
+		if (!valid)
+		{
+			std::cout << "Permutations of cube " << i << " didn't match its moves" << std::endl;
+			return false;
+		}
+	}
+	std::cout << "All " << NUM_CUBES << " permutations matched their moves" << std::endl;
+	return true;
+}
+
+/**
+ * Test the solution cache on random scrambles, solving each one, then
+ * a random symmetry of it.
+ *
+ * Return true if every second solve was a hit, and every solution
+ * solved its cube.
+ */
+bool testCachedSolutions()
+{
+	const size_t NUM_CUBES = 500;
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	SolutionCache cache(options, NUM_CUBES, true);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		Cube variant = cube;
+		applySymmetry(variant, (uint8_t)(rand() % NUM_SYMMETRIES));
+
+		for (Cube* scrambled : { &cube, &variant })
+		{
+			Solution solution = cache.solve(*scrambled);
+			Cube solved = *scrambled;
+			for (size_t m = 0; m < solution.size(); m++)
+				solved.executeMove(solution.move(m));
+			if (!solution.solved || !solved.isSolved())
+			{
+				std::cout << "Cached solution " << solutionToString(solution.toMoves()) << "didn't solve its cube" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	CacheStats stats = cache.stats();
+	if (stats.hits != NUM_CUBES)
+	{
+		std::cout << "Only " << stats.hits << " of " << NUM_CUBES << " symmetric cubes were found in the cache" << std::endl;
+		return false;
+	}
+	std::cout << "All " << NUM_CUBES << " symmetric cubes were solved from the cache (" << stats.symmetricHits
+		<< " conjugated)" << std::endl;
+	return true;
+}
+
+/**
+ * Test the solution store, writing solutions for random scrambles to a
+ * new store, then reading them back from a second mapping of the same
+ * file, both while the writer has it open and after it's reopened.
+ *
+ * Report how long each lookup took.
+ *
+ * Return true if every cube (and a random symmetry of it) was found,
+ * and every solution solved its cube.
+ */
+bool testSolutionStore()
+{
+	const size_t NUM_CUBES = 500;
+	std::string path = testPath("solution-store");
+
+	srand((unsigned int)time(NULL));
+	remove(path.c_str());
+	SolveOptions options;
+	SolutionStore writer;
+	SolutionStore reader;
+	if (!writer.openForWriting(path, options, NUM_CUBES, true) || !reader.open(path, options))
+	{
+		std::cout << "Couldn't create a solution store" << std::endl;
+		remove(path.c_str());
+		return false;
+	}
+
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (Cube& cube : cubes)
+	{
+		cube.readMoves(generateScramble());
+		writer.solve(cube);
+		applySymmetry(cube, (uint8_t)(rand() % NUM_SYMMETRIES));
+	}
+	writer.close();
+
+	bool passed = true;
+	for (uint8_t pass = 0; pass < 2 && passed; pass++)
+	{
+		if (pass == 1 && !reader.open(path, options))
+		{
+			std::cout << "Couldn't reopen the solution store" << std::endl;
+			passed = false;
+			break;
+		}
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (const Cube& cube : cubes)
+		{
+			Solution solution;
+			Cube solved = cube;
+			if (reader.find(cube, solution))
+			{
+				for (size_t m = 0; m < solution.size(); m++)
+					solved.executeMove(solution.move(m));
+			}
+			if (!solution.solved || !solved.isSolved() || solution.numPhases != MAX_PHASES)
+			{
+				std::cout << "Stored solution " << solutionToString(solution.toMoves()) << "didn't solve its cube" << std::endl;
+				passed = false;
+				break;
+			}
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (passed && pass == 1)
+			std::cout << "All " << reader.size() << " stored solutions were found again (" << seconds * 1e6 / NUM_CUBES
+				<< " us per lookup)" << std::endl;
+	}
+	reader.close();
+	remove(path.c_str());
+	return passed;
+}
+
+/**
+ * Test streaming a batch of random scrambles through several threads,
+ * with a blank line and an impossible state mixed in.
+ *
+ * Return true if every result came back in order and matched solving
+ * its scramble on its own.
+ */
+bool testBatchStream()
+{
+	const size_t NUM_CUBES = 1000;
+
+	srand((unsigned int)time(NULL));
+	FILE* input = tmpfile();
+	FILE* output = tmpfile();
+	if (input == nullptr || output == nullptr)
+	{
+		std::cout << "Couldn't create files for the batch stream" << std::endl;
+		return false;
+	}
+
+	SolveOptions options;
+	std::string expected;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		std::string scramble = generateScramble();
+		Cube cube;
+		cube.readMoves(scramble);
+		std::string solution = solutionToString(solve(cube, options).toMoves());
+		fprintf(input, "%s\n", scramble.c_str());
+		expected += solution.substr(0, solution.size() - 1) + "\n";
+	}
+	fprintf(input, "\nWWWWWWWWWYYYYYYYYYRRRRRRRRROOOOOOOOOBBBBBBBBBGGGGGGGGW\n");
+	expected += "error: state can't be solved\n";
+	rewind(input);
+
+	ThreadPool pool(4);
+	BatchStats stats = solveStream(input, output, options, BATCH_FORMAT::TEXT, pool);
+	std::string results(expected.size() + 1, '\0');
+	rewind(output);
+	results.resize(fread(&results[0], 1, results.size(), output));
+	fclose(input);
+	fclose(output);
+
+	if (stats.count != NUM_CUBES + 1 || results != expected)
+	{
+		std::cout << "Batch stream results didn't match" << std::endl;
+		return false;
+	}
+	std::cout << "All " << stats.count << " streamed results matched" << std::endl;
+	return true;
+}
+
+/**
+ * Test the corpus pipeline, writing random scrambles to a corpus and
+ * solving it on several threads into the batch wire format.
+ *
+ * Return true if every solution came back in order and matched solving
+ * its cube on its own.
+ */
+bool testCorpusPipeline()
+{
+	const size_t NUM_CUBES = 1000;
+	const char* path = "corpus.test";
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	std::vector<Solution> expected(NUM_CUBES);
+	CorpusWriter writer;
+	if (!writer.open(path))
+	{
+		std::cout << "Couldn't create a corpus" << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		writer.add(cube);
+		expected[i] = solve(cube, options);
+	}
+
+	Corpus corpus;
+	FILE* output = tmpfile();
+	bool passed = writer.close() && corpus.open(path) && corpus.size() == NUM_CUBES && output != nullptr;
+	if (passed)
+	{
+		solveCorpus(corpus, output, options, BATCH_FORMAT::BINARY, 4);
+		std::vector<uint8_t> bytes((size_t)ftell(output));
+		rewind(output);
+		std::vector<Solution> solutions;
+		passed = fread(bytes.data(), 1, bytes.size(), output) == bytes.size() &&
+			unpackBatch(bytes.data(), bytes.size(), solutions) && solutions.size() == NUM_CUBES;
+		for (size_t i = 0; passed && i < NUM_CUBES; i++)
+			passed = solutions[i].moves == expected[i].moves && solutions[i].solved;
+	}
+	if (output != nullptr)
+		fclose(output);
+	remove(path);
+
+	if (!passed)
+	{
+		std::cout << "Corpus pipeline results didn't match" << std::endl;
+		return false;
+	}
+	std::cout << "All " << NUM_CUBES << " corpus solutions matched (" << CORPUS_RECORD_SIZE << " bytes per cube)" << std::endl;
+	return true;
+}
+
+/**
+ * Write the given bytes to the given job's output up to the given offset,
+ * save a checkpoint there with the given input offset, line and count,
+ * then write the rest of the bytes as if the job stopped after the next
+ * flush. Return false if any of it can't be written.
+ */
+bool writeInterruptedJob(const std::string& bytes, size_t offset, const CheckpointJob& job, const Checkpoint& checkpoint,
+	const char* outputPath, const char* checkpointPath)
+{
+	remove(checkpointPath);
+	Checkpointer checkpointer(checkpointPath, job);
+	FILE* output = openCheckpointedOutput(outputPath, checkpointer);
+	if (output == nullptr)
+		return false;
+	fwrite(bytes.data(), 1, offset, output);
+	bool saved = checkpointer.save(output, checkpoint);
+	// results written after the checkpoint, which a resumed job replaces
+	fwrite(bytes.data() + offset, 1, (bytes.size() - offset) / 2, output);
+	return fclose(output) == 0 && saved;
+}
+
+/**
+ * Read the whole file at the given path.
+ */
+std::string readWholeFile(const char* path)
+{
+	std::string bytes;
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr)
+		return bytes;
+	char buffer[4096];
+	for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+		bytes.append(buffer, read);
+	fclose(file);
+	return bytes;
+}
+
+/**
+ * Test resuming batch jobs from a checkpoint partway through, after
+ * more results were written than it covers: a text job with JSON
+ * output, and a corpus job with binary output. Then try resuming the
+ * text job with another format, and after its input changed.
+ *
+ * Return true if both outputs came out the same as solving the whole
+ * batch in one go, with every result exactly once, and the other jobs
+ * refused to resume.
+ */
+bool testCheckpointResume()
+{
+	const size_t NUM_CUBES = 1000;
+	const size_t STOPPED_AT = 600;
+	const char* inputPath = "checkpoint-input.test";
+	const char* corpusPath = "checkpoint-corpus.test";
+	const char* outputPath = "checkpoint-output.test";
+	const char* checkpointPath = "checkpoint.test";
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	std::string text, json;
+	std::vector<Solution> solutions(NUM_CUBES);
+	size_t textOffset = 0, jsonOffset = 0;
+	FILE* input = fopen(inputPath, "wb");
+	CorpusWriter writer;
+	if (input == nullptr || !writer.open(corpusPath))
+	{
+		std::cout << "Couldn't create files for the checkpoint test" << std::endl;
+		if (input != nullptr)
+			fclose(input);
+		return false;
+	}
+	std::string result;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		if (i == STOPPED_AT)
+		{
+			textOffset = text.size();
+			jsonOffset = json.size();
+		}
+		std::string scramble = generateScramble();
+		Cube cube;
+		cube.readMoves(scramble);
+		writer.add(cube);
+		solutions[i] = solve(cube, options);
+		text += scramble + "\n";
+		formatResult(i + 1, solutions[i], nullptr, BATCH_FORMAT::JSON, result);
+		json += result;
+	}
+	fwrite(text.data(), 1, text.size(), input);
+	bool passed = fclose(input) == 0 && writer.close();
+
+	// a text job, stopped after STOPPED_AT lines
+	CheckpointJob job;
+	job.settings = hashOptions(options) * 31 + (uint64_t)BATCH_FORMAT::JSON;
+	passed = passed && job.readInput(inputPath);
+	Checkpoint checkpoint;
+	checkpoint.inputOffset = textOffset;
+	checkpoint.lineNumber = checkpoint.count = STOPPED_AT;
+	passed = passed && writeInterruptedJob(json, jsonOffset, job, checkpoint, outputPath, checkpointPath);
+	if (passed)
+	{
+		Checkpointer checkpointer(checkpointPath, job);
+		input = fopen(inputPath, "rb");
+		FILE* output = openCheckpointedOutput(outputPath, checkpointer);
+		ThreadPool pool(4);
+		passed = input != nullptr && output != nullptr && checkpointer.hasStart() &&
+			solveStream(input, output, options, BATCH_FORMAT::JSON, pool, &checkpointer).count == NUM_CUBES - STOPPED_AT;
+		if (input != nullptr)
+			fclose(input);
+		passed = output != nullptr && fclose(output) == 0 && passed && checkpointer.good() &&
+			readWholeFile(outputPath) == json;
+	}
+
+	// the same checkpoint with text output, and with a line added to the input
+	passed = passed && writeInterruptedJob(json, jsonOffset, job, checkpoint, outputPath, checkpointPath);
+	CheckpointJob otherFormat = job;
+	otherFormat.settings = hashOptions(options) * 31 + (uint64_t)BATCH_FORMAT::TEXT;
+	passed = passed && Checkpointer(checkpointPath, otherFormat).mismatched();
+	input = fopen(inputPath, "ab");
+	CheckpointJob changedInput = job;
+	passed = passed && input != nullptr && fputs("R U R' U'\n", input) >= 0 && fclose(input) == 0 &&
+		changedInput.readInput(inputPath);
+	passed = passed && Checkpointer(checkpointPath, changedInput).mismatched() &&
+		!Checkpointer(checkpointPath, changedInput).hasStart() && !Checkpointer(checkpointPath, job).mismatched();
+
+	// a corpus job, stopped after STOPPED_AT cubes
+	std::vector<uint8_t> packed;
+	packBatch(solutions.data(), NUM_CUBES, packed);
+	std::string binary(packed.begin(), packed.end());
+	packed.clear();
+	for (size_t i = 0; i < STOPPED_AT; i++)
+		packSolution(solutions[i], packed);
+	// the header's count is for the whole batch
+	uint8_t header[MAX_VARINT_BYTES];
+	size_t binaryOffset = sizeof(BATCH_MAGIC) + writeVarint(NUM_CUBES, header) + packed.size();
+	checkpoint.inputOffset = checkpoint.lineNumber = checkpoint.count = STOPPED_AT;
+	job.settings = hashOptions(options) * 31 + (uint64_t)BATCH_FORMAT::BINARY;
+	passed = passed && job.readInput(corpusPath) &&
+		writeInterruptedJob(binary, binaryOffset, job, checkpoint, outputPath, checkpointPath);
+	if (passed)
+	{
+		Checkpointer checkpointer(checkpointPath, job);
+		Corpus corpus;
+		FILE* output = openCheckpointedOutput(outputPath, checkpointer);
+		passed = corpus.open(corpusPath) && output != nullptr &&
+			solveCorpus(corpus, output, options, BATCH_FORMAT::BINARY, 4, &checkpointer).count == NUM_CUBES - STOPPED_AT;
+		passed = output != nullptr && fclose(output) == 0 && passed && checkpointer.good() &&
+			readWholeFile(outputPath) == binary;
+	}
+
+	remove(inputPath);
+	remove(corpusPath);
+	remove(outputPath);
+	remove(checkpointPath);
+
+	if (!passed)
+	{
+		std::cout << "Resumed batch results didn't match" << std::endl;
+		return false;
+	}
+	std::cout << "Both resumed batches matched solving in one go, and other jobs didn't resume" << std::endl;
+	return true;
+}
+
+/**
+ * Test the scheduler on one thread: bulk solves queued ahead of
+ * interactive ones, solves past their deadline (dropped, or solved
+ * fast), and cancelled solves, along with cancelling solves directly.
+ *
+ * Return true if the interactive solves jumped the queue and every
+ * solve finished the way it should have.
+ */
+bool testScheduler()
+{
+	const size_t NUM_BULK = 100;
+	const size_t NUM_INTERACTIVE = 10;
+	const size_t NUM_JOBS = NUM_BULK + NUM_INTERACTIVE + 3;
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	std::unique_ptr<SolveJob[]> jobs(new SolveJob[NUM_JOBS]);
+	struct Recorder
+	{
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::vector<size_t> order;
+	} recorder;
+	std::vector<size_t>& order = recorder.order;
+	ClassStats bulk, interactive;
+	{
+		Scheduler scheduler(options, 1);
+		for (size_t i = 0; i < NUM_JOBS; i++)
+		{
+			SolveJob& job = jobs[i];
+			job.cube.readMoves(generateScramble());
+			job.priority = i < NUM_BULK ? PRIORITY::BULK : PRIORITY::INTERACTIVE;
+			// the last three are already past their deadline or cancelled
+			if (i >= NUM_BULK + NUM_INTERACTIVE)
+				job.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+			job.dropLate = i == NUM_JOBS - 3;
+			job.cancelled = i == NUM_JOBS - 1;
+			job.finished = [](SolveJob* job, void* context) {
+				Recorder* recorder = (Recorder*)context;
+				std::lock_guard<std::mutex> lock(recorder->mutex);
+				recorder->order.push_back((size_t)job->sequence);
+				recorder->changed.notify_all();
+			};
+			job.context = &recorder;
+		}
+		for (size_t i = 0; i < NUM_JOBS; i++)
+			scheduler.submit(&jobs[i]);
+
+		std::unique_lock<std::mutex> lock(recorder.mutex);
+		recorder.changed.wait(lock, [&recorder]() { return recorder.order.size() == NUM_JOBS; });
+		bulk = scheduler.stats(PRIORITY::BULK);
+		interactive = scheduler.stats(PRIORITY::INTERACTIVE);
+	}
+
+	// every interactive solve should finish before the last half of the bulk ones
+	bool passed = order.size() == NUM_JOBS;
+	for (size_t i = 0; passed && i < NUM_JOBS; i++)
+		passed = order[i] < NUM_BULK || i < NUM_BULK / 2 + NUM_INTERACTIVE + 3;
+	SolveOptions fast = options;
+	fast.fast = true;
+	const SolveJob& dropped = jobs[NUM_JOBS - 3];
+	const SolveJob& degraded = jobs[NUM_JOBS - 2];
+	const SolveJob& cancelled = jobs[NUM_JOBS - 1];
+	passed = passed && dropped.dropped && !dropped.solution.solved && degraded.degraded && degraded.solution.solved &&
+		degraded.solution.moves == solve(degraded.cube, fast).moves && !cancelled.solution.solved;
+	for (size_t i = 0; passed && i < NUM_BULK + NUM_INTERACTIVE; i++)
+		passed = jobs[i].solution.solved && jobs[i].solution.moves == solve(jobs[i].cube, options).moves;
+	passed = passed && bulk.finished == NUM_BULK && interactive.finished == NUM_INTERACTIVE + 3 &&
+		interactive.dropped == 1 && interactive.degraded == 1 && interactive.cancelled == 1 && interactive.deadlineMisses == 2;
+
+	// a cancelled solve gives up, with or without a restriction
+	std::atomic<bool> cancel(true);
+	SolveOptions cancelling = options;
+	cancelling.cancel = &cancel;
+	passed = passed && !solve(jobs[0].cube, cancelling).solved;
+	cancelling.restriction.allowed &= ~(uint32_t)7;
+	passed = passed && !solve(jobs[0].cube, cancelling).solved;
+
+	if (!passed)
+	{
+		std::cout << "Scheduled solves didn't finish in order" << std::endl;
+		return false;
+	}
+	std::cout << "All " << NUM_JOBS << " scheduled solves finished in order (interactive waited "
+		<< (size_t)(interactive.meanWait() * 1e6) << " us on average, bulk " << (size_t)(bulk.meanWait() * 1e6) << " us)"
+		<< std::endl;
+	return true;
+}
+
+/**
+ * Test the daemon, pipelining requests from an interactive and a bulk
+ * client at once: cubes, scrambles, a scramble and a state that can't be
+ * solved, a request that's cancelled, and a request for stats.
+ *
+ * Return true if every response came back in order and matched solving
+ * its cube directly.
+ */
+bool testDaemon()
+{
+	const size_t NUM_CUBES = 300;
+	const char* path = "daemon.test.sock";
+
+	srand((unsigned int)time(NULL));
+	SolveOptions options;
+	Daemon daemon(options, 4);
+	if (!daemon.listen(path))
+	{
+		std::cout << "Couldn't listen on " << path << std::endl;
+		return false;
+	}
+	std::thread server(&Daemon::serve, &daemon);
+
+	std::vector<std::string> scrambles(NUM_CUBES);
+	std::vector<Solution> expected(NUM_CUBES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		scrambles[i] = generateScramble();
+		Cube cube;
+		cube.readMoves(scrambles[i]);
+		expected[i] = solve(cube, options);
+	}
+
+	std::atomic<bool> passed(true);
+	std::vector<std::thread> clients;
+	for (size_t c = 0; c < 2; c++)
+	{
+		clients.emplace_back([&, c]() {
+			SolverClient client;
+			if (!client.connect(path))
+			{
+				passed = false;
+				return;
+			}
+			client.setClass(c == 0 ? PRIORITY::INTERACTIVE : PRIORITY::BULK);
+			for (size_t i = 0; i < NUM_CUBES; i++)
+			{
+				Cube cube;
+				cube.readMoves(scrambles[i]);
+				if ((i + c) % 2 == 0)
+					client.send((uint32_t)i, cube);
+				else
+					client.send((uint32_t)i, scrambles[i]);
+			}
+			client.send((uint32_t)NUM_CUBES, std::string("R U Q"));
+			client.send((uint32_t)NUM_CUBES + 1, std::string("WWWWWWWWWYYYYYYYYYRRRRRRRRROOOOOOOOOBBBBBBBBBGGGGGGGGW"));
+			// cancelled before it's solved, unless the daemon gets to it first
+			client.send((uint32_t)NUM_CUBES + 2, scrambles[0]);
+			client.cancel((uint32_t)NUM_CUBES + 2);
+
+			uint32_t id;
+			RESPONSE status;
+			Solution solution;
+			for (size_t i = 0; i < NUM_CUBES; i++)
+			{
+				if (!client.receive(id, status, solution) || id != i || status != RESPONSE::OK ||
+					solution.moves != expected[i].moves)
+					passed = false;
+			}
+			for (size_t i = NUM_CUBES; i < NUM_CUBES + 2; i++)
+			{
+				if (!client.receive(id, status, solution) || id != i || status != RESPONSE::INVALID_CUBE)
+					passed = false;
+			}
+			if (!client.receive(id, status, solution) || id != NUM_CUBES + 2 ||
+				(status != RESPONSE::CANCELLED && (status != RESPONSE::OK || solution.moves != expected[0].moves)))
+				passed = false;
+
+			std::string stats;
+			if (c == 0 && (!client.stats(stats) || std::count(stats.begin(), stats.end(), '\n') != NUM_PRIORITIES))
+				passed = false;
+		});
+	}
+	for (std::thread& client : clients)
+		client.join();
+	daemon.stop();
+	server.join();
+	// connections count their requests once the responses are sent
+	size_t served = daemon.served();
+
+	if (!passed || served != (NUM_CUBES + 3) * 2 + 1)
+	{
+		std::cout << "Daemon responses didn't match" << std::endl;
+		return false;
+	}
+	std::cout << "All " << served << " daemon responses matched" << std::endl;
+	return true;
+}
+
+/**
+ * Benchmark the solution cache on requests for a set of scrambles drawn
+ * from a Zipf distribution (the nth most common scramble asked for
+ * about 1/n as often as the first), with every other request turned to
+ * a random symmetry of its scramble.
+ *
+ * Report the hit rate and throughput without a cache, with an exact
+ * cache, and with a symmetric cache, each holding a quarter of the
+ * scrambles.
+ */
+void benchmarkCache()
+{
+	const size_t NUM_SCRAMBLES = 4000;
+	const size_t NUM_REQUESTS = 100000;
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> scrambles(NUM_SCRAMBLES);
+	for (Cube& cube : scrambles)
+		cube.readMoves(generateScramble());
+
+	// pick each request's scramble from the cumulative distribution
+	std::vector<double> cumulative(NUM_SCRAMBLES);
+	double total = 0;
+	for (size_t i = 0; i < NUM_SCRAMBLES; i++)
+	{
+		total += 1.0 / (i + 1);
+		cumulative[i] = total;
+	}
+	std::vector<Cube> requests(NUM_REQUESTS);
+	for (size_t i = 0; i < NUM_REQUESTS; i++)
+	{
+		double pick = total * rand() / ((double)RAND_MAX + 1);
+		size_t scramble = std::lower_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin();
+		requests[i] = scrambles[scramble < NUM_SCRAMBLES ? scramble : NUM_SCRAMBLES - 1];
+		if (i % 2 == 1)
+			applySymmetry(requests[i], (uint8_t)(rand() % NUM_SYMMETRIES));
+	}
+
+	SolveOptions options;
+	ThreadPool pool;
+	const char* names[3] = { "No cache", "Exact cache", "Symmetric cache" };
+	for (uint8_t mode = 0; mode < 3; mode++)
+	{
+		SolutionCache cache(options, NUM_SCRAMBLES / 4, mode == 2);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		pool.parallelFor(NUM_REQUESTS, [&](size_t i) {
+			if (mode == 0)
+				solve(requests[i], options);
+			else
+				cache.solve(requests[i]);
+		});
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		CacheStats stats = cache.stats();
+		std::cout << names[mode] << ": " << (size_t)(NUM_REQUESTS / seconds) << " solves/s";
+		if (mode > 0)
+			std::cout << ", " << stats.hitRate() * 100 << "% hits (" << stats.symmetricHits << " symmetric, "
+				<< stats.evictions << " evictions)";
+		std::cout << std::endl;
+	}
+}
+
+/**
+ * Benchmark solving batches of random scrambles on 1, 2, 4, 8, 16
+ * and 32 threads, reporting the throughput of each and how much
+ * faster it is than a single thread.
+ */
+void benchmarkBatch()
+{
+	const size_t NUM_CUBES = 20000;
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+	std::vector<Solution> solutions(NUM_CUBES);
+
+	SolveOptions options;
+	double singleThread = 0;
+	for (size_t threads = 1; threads <= 32; threads *= 2)
+	{
+		ThreadPool pool(threads);
+		BatchStats stats = solveBatch(cubes.data(), cubes.size(), options, solutions.data(), pool);
+		if (threads == 1)
+			singleThread = stats.solvesPerSecond;
+		std::cout << threads << " threads: " << (size_t)stats.solvesPerSecond << " solves/s ("
+			<< stats.solvesPerSecond / singleThread << "x)" << std::endl;
+	}
+}
+
+/**
+ * Benchmark anytime solving, reporting the average solution length (in
+ * the given options' metric) and time for budgets from 0.1 ms to 1 s,
+ * after the usual solution's. Fewer cubes are solved with the bigger
+ * budgets, so each takes a few seconds.
+ */
+void benchmarkAnytime(const SolveOptions& options)
+{
+	const size_t MAX_CUBES = 1000;
+	const double SECONDS_PER_BUDGET = 4;
+	const double budgets[] = { 0, 0.0001, 0.0003, 0.001, 0.003, 0.01, 0.03, 0.1, 0.3, 1 };
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(MAX_CUBES);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+
+	std::cout << "Budget (ms)\tAverage length\tAverage time (ms)" << std::endl;
+	for (double budget : budgets)
+	{
+		size_t numCubes = budget > 0 ? std::max((size_t)20, std::min(MAX_CUBES, (size_t)(SECONDS_PER_BUDGET / budget))) : MAX_CUBES;
+		SolveOptions anytimeOptions = options;
+		anytimeOptions.budget = budget;
+		size_t total = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < numCubes; i++)
+			total += countMoves(solve(cubes[i], anytimeOptions).toMoves(), options.metric);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (budget > 0)
+			std::cout << budget * 1000;
+		else
+			std::cout << "none";
+		std::cout << "\t" << (double)total / numCubes << "\t" << seconds * 1000 / numCubes << std::endl;
+	}
+}
+
+/**
+ * Benchmark streaming solves a phase at a time, for the default options
+ * and a robot without a back face, reporting the average time until the
+ * first move is ready against the time to solve the cube in one go,
+ * along with how long the stream takes to finish.
+ */
+void benchmarkStreaming()
+{
+	typedef std::chrono::steady_clock Clock;
+	const size_t NUM_CUBES = 2000;
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+
+	SolveOptions optionSets[2];
+	optionSets[1].restriction.allowed = ALL_FACE_MOVES & ~faceMoveMask(Cube().readMoves("B B' B2"));
+	const char* names[2] = { "Default", "Robot without B" };
+	for (uint8_t o = 0; o < 2; o++)
+	{
+		double whole = 0;
+		double firstMove = 0;
+		double stream = 0;
+		for (const Cube& cube : cubes)
+		{
+			Clock::time_point start = Clock::now();
+			solve(cube, optionSets[o]);
+			whole += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+			StreamedPhases streamed;
+			start = Clock::now();
+			solveByPhase(cube, optionSets[o], receivePhase, &streamed);
+			Clock::time_point end = Clock::now();
+			firstMove += std::chrono::duration<double, std::micro>(streamed.firstMove - start).count();
+			stream += std::chrono::duration<double, std::micro>(end - start).count();
+		}
+		std::cout << names[o] << ": first move after " << firstMove / NUM_CUBES << " us, whole solution after "
+			<< whole / NUM_CUBES << " us (" << stream / NUM_CUBES << " us to stream every phase)" << std::endl;
+	}
+}
+
+/**
+ * Benchmark a session against solving from scratch on every request, on
+ * a user working through each scramble: asking for a hint after every
+ * move, and making the hinted move, except for one move in five, which
+ * is a random outer face turn instead.
+ */
+void benchmarkSession(const SolveOptions& options)
+{
+	typedef std::chrono::steady_clock Clock;
+	const size_t NUM_CUBES = 200;
+	const size_t MAX_STEPS = 200;
+
+	srand((unsigned int)time(NULL));
+	SolverSession session(options);
+	double sessionTime = 0;
+	double freshTime = 0;
+	size_t requests = 0;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		session.setState(cube);
+		for (size_t step = 0; step < MAX_STEPS && !cube.isSolved(); step++)
+		{
+			Clock::time_point start = Clock::now();
+			Move hint = session.hint();
+			sessionTime += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			start = Clock::now();
+			solve(cube, options);
+			freshTime += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			requests++;
+
+			Move move = rand() % 5 == 0 ? Move::fromCode(rand() % NUM_FACE_CODES) : hint;
+			cube.executeMove(move);
+			session.apply(move);
+		}
+	}
+
+	const SessionStats& stats = session.stats();
+	std::cout << requests << " requests: " << sessionTime / requests << " us each with a session, "
+		<< freshTime / requests << " us solving from scratch (" << stats.solves << " solved from scratch, "
+		<< stats.followed << " followed, " << stats.reused << " reused)" << std::endl;
+}
+
+/**
+ * Benchmark hints on a user working through each scramble as in
+ * benchmarkSession, asking for a hint after every move, and timing the
+ * lower bound alone too.
+ */
+void benchmarkHints()
+{
+	typedef std::chrono::steady_clock Clock;
+	const size_t NUM_CUBES = 1000;
+	const size_t MAX_STEPS = 200;
+
+	srand((unsigned int)time(NULL));
+	HintOracle oracle;
+	// the first hint builds the cross table, so it isn't timed
+	oracle.hint(Cube());
+	double hintTime = 0;
+	double boundTime = 0;
+	size_t requests = 0;
+	size_t bounds = 0;
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		for (size_t step = 0; step < MAX_STEPS && !cube.isSolved(); step++)
+		{
+			Clock::time_point start = Clock::now();
+			Hint hint = oracle.hint(cube);
+			hintTime += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			start = Clock::now();
+			bounds += distanceLowerBound(cube);
+			boundTime += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			requests++;
+
+			Move move = rand() % 5 == 0 ? Move::fromCode(rand() % NUM_FACE_CODES) : hint.next;
+			cube.executeMove(move);
+		}
+	}
+
+	std::cout << requests << " requests: " << hintTime / requests << " ns per hint, " << boundTime / requests
+		<< " ns per lower bound (averaging " << (double)bounds / requests << " turns)" << std::endl;
+}
+
+/**
+ * Benchmark each operation on permutations of random scrambles, and
+ * turning them into and out of moves and cubes.
+ */
+void benchmarkPermutations()
+{
+	typedef std::chrono::steady_clock Clock;
+	const size_t NUM_CUBES = 1000;
+	const size_t REPEATS = 100;
+
+	srand((unsigned int)time(NULL));
+	std::vector<std::vector<Move>> scrambles(NUM_CUBES);
+	std::vector<Permutation> permutations(NUM_CUBES);
+	std::vector<Cube> cubes(NUM_CUBES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		scrambles[i] = cubes[i].readMoves(generateScramble());
+		permutations[i] = Permutation(scrambles[i]);
+	}
+
+	// each operation's result feeds the next, so none can be skipped
+	Permutation result;
+	size_t checksum = 0;
+	auto time = [&](const char* name, auto operation) {
+		Clock::time_point start = Clock::now();
+		for (size_t r = 0; r < REPEATS; r++)
+		{
+			for (size_t i = 0; i < NUM_CUBES; i++)
+				operation(i);
+		}
+		double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		checksum += result[0];
+		std::cout << name << ": " << elapsed / (REPEATS * NUM_CUBES) << " ns" << std::endl;
+	};
+	time("compose", [&](size_t i) { result = result.compose(permutations[i]); });
+	time("inverse", [&](size_t i) { result = permutations[i].compose(result).inverse(); });
+	time("power 5", [&](size_t i) { result = result.compose(permutations[i].power(5)); });
+	time("conjugate", [&](size_t i) { result = result.conjugate(permutations[i]); });
+	time("commutator", [&](size_t i) { result = Permutation::commutator(result, permutations[i]); });
+	time("25 moves to permutation", [&](size_t i) { result = result.compose(Permutation(scrambles[i])); });
+	time("cube to permutation", [&](size_t i) { result = result.compose(Permutation(cubes[i])); });
+	time("permutation to cube", [&](size_t i) { checksum += permutations[i].compose(result).toCube().hash() & 1; });
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+}
+
+/**
+ * Benchmark the web build's bindings natively (WebBenchmark.js runs the
+ * same comparison on the web build itself): getSolution, which takes a
+ * state string and returns the moves as a string, against BatchSolver,
+ * which solves a whole array of packed states and returns their packed
+ * solutions, on the calling thread and across the given number of
+ * threads. Strings crossing into and out of the module are copied each
+ * way, as embind does.
+ */
+void benchmarkWeb(size_t threads)
+{
+	typedef std::chrono::steady_clock Clock;
+	const size_t NUM_CUBES = 5000;
+
+	srand((unsigned int)time(NULL));
+	std::vector<std::string> states(NUM_CUBES);
+	std::vector<uint8_t> packed(NUM_CUBES * PACKED_STATE_BYTES);
+	for (size_t i = 0; i < NUM_CUBES; i++)
+	{
+		Cube cube;
+		cube.readMoves(generateScramble());
+		cube.writeState(states[i]);
+		packState(cube, &packed[i * PACKED_STATE_BYTES]);
+	}
+
+	Clock::time_point start = Clock::now();
+	size_t length = 0;
+	for (const std::string& state : states)
+	{
+		std::string input(state.c_str(), state.size());
+		Cube cube;
+		cube.copyState(input);
+		std::string output = solutionToString(solve(cube, SolveOptions()).toMoves());
+		length += std::string(output.c_str(), output.size()).size();
+	}
+	double single = NUM_CUBES / std::chrono::duration<double>(Clock::now() - start).count();
+	std::cout << "getSolution: " << (size_t)single << " solves/s (" << (double)length / NUM_CUBES
+		<< " bytes per solution)" << std::endl;
+
+	ThreadPool pool(threads);
+	for (ThreadPool* batchPool : { (ThreadPool*)nullptr, &pool })
+	{
+		std::vector<uint8_t> bytes;
+		start = Clock::now();
+		solvePacked(packed.data(), NUM_CUBES, SolveOptions(), batchPool, bytes);
+		double batch = NUM_CUBES / std::chrono::duration<double>(Clock::now() - start).count();
+		std::cout << "BatchSolver on " << (batchPool == nullptr ? 1 : pool.size()) << " threads: " << (size_t)batch
+			<< " solves/s (" << batch / single << "x, " << (double)bytes.size() / NUM_CUBES << " bytes per solution)"
+			<< std::endl;
+	}
+}
+
+/**
+ * Send the given cubes to the daemon at the given path in the given
+ * priority class, with the given deadline in microseconds (0 for none),
+ * keeping the given number in flight and sending another as each
+ * response comes back. Write each one's latency in microseconds, from
+ * sending it to reading its response, and count the responses solved
+ * fast to meet their deadline.
+ *
+ * Return false if the connection is lost.
+ */
+bool runLoadClient(const std::string& path, const Cube* cubes, size_t count, size_t depth, PRIORITY priority,
+	uint32_t deadline, double* latencies, size_t& degraded)
+{
+	typedef std::chrono::steady_clock Clock;
+	SolverClient client;
+	if (!client.connect(path))
+		return false;
+	client.setClass(priority, deadline);
+	std::vector<Clock::time_point> sent(count);
+	size_t next = 0;
+	degraded = 0;
+	for (size_t done = 0; done < count; done++)
+	{
+		for (; next < count && next < done + depth; next++)
+		{
+			sent[next] = Clock::now();
+			client.send((uint32_t)next, cubes[next]);
+		}
+		uint32_t id;
+		RESPONSE status;
+		Solution solution;
+		if (!client.receive(id, status, solution) || id >= count)
+			return false;
+		latencies[id] = std::chrono::duration<double, std::micro>(Clock::now() - sent[id]).count();
+		degraded += status == RESPONSE::DEGRADED;
+	}
+	return true;
+}
+
+/**
+ * Print the throughput and the median and 99th percentile of the given
+ * latencies, in microseconds.
+ */
+void printLatencies(const std::string& name, std::vector<double>& latencies, double seconds)
+{
+	std::sort(latencies.begin(), latencies.end());
+	std::cout << name << ": " << (size_t)(latencies.size() / seconds) << " solves/s, p50 "
+		<< (size_t)latencies[latencies.size() / 2] << " us, p99 " << (size_t)latencies[latencies.size() * 99 / 100] << " us"
+		<< std::endl;
+}
+
+/**
+ * Benchmark the daemon at the given path, starting one in this process
+ * if none is listening there.
+ *
+ * Report the throughput and latency for 1 and 4 clients, each keeping 1
+ * or 16 requests in flight. Then run bulk clients that keep the daemon
+ * busy alongside an interactive client with a deadline, and report the
+ * interactive latency and the daemon's stats for each class.
+ */
+void benchmarkDaemon(const std::string& path, const SolveOptions& options, size_t numThreads)
+{
+	const size_t NUM_REQUESTS = 4000;
+	const size_t CLIENTS[] = { 1, 4 };
+	const size_t DEPTHS[] = { 1, 16 };
+	const size_t NUM_BULK_CLIENTS = 2;
+	const size_t BULK_DEPTH = 64;
+	const size_t NUM_INTERACTIVE = 200;
+	const uint32_t INTERACTIVE_DEADLINE = 1000;
+
+	std::unique_ptr<Daemon> daemon;
+	std::thread server;
+	SolverClient probe;
+	if (!probe.connect(path))
+	{
+		daemon.reset(new Daemon(options, numThreads));
+		if (!daemon->listen(path))
+		{
+			std::cout << "Couldn't listen on " << path << std::endl;
+			return;
+		}
+		server = std::thread(&Daemon::serve, daemon.get());
+		std::cout << "Started a daemon on " << path << std::endl;
+	}
+	probe.close();
+
+	srand((unsigned int)time(NULL));
+	std::vector<Cube> cubes(NUM_REQUESTS);
+	for (Cube& cube : cubes)
+		cube.readMoves(generateScramble());
+
+	typedef std::chrono::steady_clock Clock;
+	std::atomic<bool> failed(false);
+	for (size_t numClients : CLIENTS)
+	{
+		for (size_t depth : DEPTHS)
+		{
+			size_t perClient = NUM_REQUESTS / numClients;
+			std::vector<double> latencies(perClient * numClients);
+			Clock::time_point start = Clock::now();
+			std::vector<std::thread> clients;
+			for (size_t c = 0; c < numClients; c++)
+			{
+				clients.emplace_back([&, c]() {
+					size_t degraded;
+					if (!runLoadClient(path, &cubes[c * perClient], perClient, depth, PRIORITY::NORMAL, 0,
+						&latencies[c * perClient], degraded))
+						failed = true;
+				});
+			}
+			for (std::thread& client : clients)
+				client.join();
+			if (!failed)
+			{
+				printLatencies(std::to_string(numClients) + " clients, " + std::to_string(depth) + " in flight each",
+					latencies, std::chrono::duration<double>(Clock::now() - start).count());
+			}
+		}
+	}
+
+	// bulk clients run until the interactive one is done
+	std::vector<double> latencies(NUM_INTERACTIVE);
+	size_t degraded = 0;
+	std::atomic<bool> interactiveDone(false);
+	std::vector<std::thread> clients;
+	for (size_t c = 0; c < NUM_BULK_CLIENTS; c++)
+	{
+		clients.emplace_back([&]() {
+			std::vector<double> bulkLatencies(NUM_REQUESTS);
+			size_t bulkDegraded;
+			while (!interactiveDone && !failed)
+			{
+				if (!runLoadClient(path, cubes.data(), NUM_REQUESTS / 8, BULK_DEPTH, PRIORITY::BULK, 0, bulkLatencies.data(),
+					bulkDegraded))
+					failed = true;
+			}
+		});
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	Clock::time_point start = Clock::now();
+	if (!runLoadClient(path, cubes.data(), NUM_INTERACTIVE, 1, PRIORITY::INTERACTIVE, INTERACTIVE_DEADLINE,
+		latencies.data(), degraded))
+		failed = true;
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	interactiveDone = true;
+	for (std::thread& client : clients)
+		client.join();
+
+	std::string stats;
+	if (!failed && probe.connect(path) && probe.stats(stats))
+	{
+		printLatencies("Interactive alongside " + std::to_string(NUM_BULK_CLIENTS) + " bulk clients (" +
+			std::to_string(degraded) + " solved fast)", latencies, seconds);
+		std::cout << stats;
+	}
+	if (failed)
+		std::cout << "Lost the connection to the daemon" << std::endl;
+
+	if (daemon)
+	{
+		daemon->stop();
+		server.join();
+	}
+}
+
+/**
+ * Number of solutions a store made by --store can hold. Its file only
+ * takes disk space as it fills up.
+ */
+const size_t STORE_CAPACITY = 1000000;
+
+/**
+ * What the program was asked to do, besides how to solve.
+ */
+struct CommandLine
+{
+	bool schedule = false;
+	bool test = false;
+	bool bench = false;
+	bool benchCache = false;
+	bool benchAnytime = false;
+	bool benchStream = false;
+	bool benchWeb = false;
+	bool benchSession = false;
+	bool benchHints = false;
+	bool benchPermutations = false;
+	std::string storePath;
+	// serve requests on a socket at this path, or benchmark the daemon there
+	std::string daemonPath;
+	std::string benchDaemonPath;
+
+	// batch mode reads from the input file (or stdin) and writes to the output file (or stdout)
+	bool batch = false;
+	std::string inputPath;
+	std::string outputPath;
+	BATCH_FORMAT format = BATCH_FORMAT::TEXT;
+	size_t threads = 0;
+	// write the text input to a corpus at this path instead of solving it
+	std::string corpusPath;
+	// save the batch's progress here, and carry on from it if it's there
+	std::string checkpointPath;
+};
+
+/**
+ * Read the options from the command line:
+ *
+ * --metric htm|qtm|stm|etm   metric to optimize the solution for
+ * --moves any|faces|slices   moves the optimized solution can use
+ * --allow "U U' D ..."       only solve with these outer face turns
+ * --cost MOVE=COST           cost of an outer face turn (default 1)
+ * --timing QUARTER,HALF,SETTLE  robot turn times in milliseconds
+ * --fastest                  choose the solution the robot performs fastest
+ * --budget MS                keep improving the solution for this many milliseconds
+ * --schedule                 print the robot's schedule for the solution
+ * --test                     test solving from many threads at once
+ * --bench                    benchmark solving batches on 1 to 32 threads
+ * --bench-cache              benchmark the solution cache on a Zipf workload
+ * --bench-anytime            benchmark solution length against budget
+ * --bench-stream             benchmark time to the first move when streaming phases
+ * --bench-web                benchmark the web bindings natively, one cube against batches
+ * --bench-session            benchmark a session's hints against solving from scratch
+ * --bench-hints              benchmark the hint oracle's hints and lower bounds
+ * --bench-permutations       benchmark composing, inverting and converting permutations
+ * --store PATH               look up and save solutions in a store file
+ * --daemon PATH              serve solve requests on a Unix socket at PATH
+ * --bench-daemon PATH        benchmark the daemon at PATH (starting one if needed)
+ * --batch                    solve every line of the input, without prompting
+ * --input PATH               read batch input from a file instead of stdin
+ * --output PATH              write batch results to a file instead of stdout
+ * --format text|json|binary  write batch results as moves, JSON Lines or packed
+ * --threads N                threads to solve a batch on (default all)
+ * --make-corpus PATH         write the batch input to a binary corpus instead
+ * --checkpoint PATH          save batch progress to resume from if it's stopped
+ *
+ * Return false if any option isn't recognized.
+ */
+bool readOptions(int argc, char* argv[], SolveOptions& options, CommandLine& command)
+{
+	Cube parser;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		if (option == "--metric" && i + 1 < argc)
+		{
+			if (!parseMetric(argv[++i], options.metric))
+				return false;
+		}
+		else if (option == "--moves" && i + 1 < argc)
+		{
+			if (!parseMoveSet(argv[++i], options.moveSet))
+				return false;
+		}
+		else if (option == "--allow" && i + 1 < argc)
+		{
+			options.restriction.allowed = faceMoveMask(parser.readMoves(argv[++i]));
+			if (options.restriction.allowed == 0)
+				return false;
+		}
+		else if (option == "--cost" && i + 1 < argc)
+		{
+			std::string cost = argv[++i];
+			size_t split = cost.find('=');
+			if (split == std::string::npos)
+				return false;
+			Move move = parser.parseMove(cost.substr(0, split));
+			float value = (float)atof(cost.c_str() + split + 1);
+			if (move.type == Move::TYPE::NO_MOVE || move.pieces > Move::PIECES::LEFT || value <= 0)
+				return false;
+			options.restriction.costs[faceMoveIndex(move)] = value;
+		}
+		else if (option == "--timing" && i + 1 < argc)
+		{
+			unsigned int quarter, half, settle;
+			if (sscanf(argv[++i], "%u,%u,%u", &quarter, &half, &settle) != 3)
+				return false;
+			options.timing = RobotTiming(quarter, half, settle);
+		}
+		else if (option == "--fastest")
+			options.minimizeTime = true;
+		else if (option == "--budget" && i + 1 < argc)
+		{
+			options.budget = atof(argv[++i]) / 1000;
+			if (options.budget <= 0)
+				return false;
+		}
+		else if (option == "--schedule")
+			command.schedule = true;
+		else if (option == "--test")
+			command.test = true;
+		else if (option == "--bench")
+			command.bench = true;
+		else if (option == "--bench-cache")
+			command.benchCache = true;
+		else if (option == "--bench-anytime")
+			command.benchAnytime = true;
+		else if (option == "--bench-stream")
+			command.benchStream = true;
+		else if (option == "--bench-web")
+			command.benchWeb = true;
+		else if (option == "--bench-session")
+			command.benchSession = true;
+		else if (option == "--bench-hints")
+			command.benchHints = true;
+		else if (option == "--bench-permutations")
+			command.benchPermutations = true;
+		else if (option == "--store" && i + 1 < argc)
+			command.storePath = argv[++i];
+		else if (option == "--daemon" && i + 1 < argc)
+			command.daemonPath = argv[++i];
+		else if (option == "--bench-daemon" && i + 1 < argc)
+			command.benchDaemonPath = argv[++i];
+		else if (option == "--batch")
+			command.batch = true;
+		else if (option == "--input" && i + 1 < argc)
+			command.inputPath = argv[++i];
+		else if (option == "--output" && i + 1 < argc)
+			command.outputPath = argv[++i];
+		else if (option == "--format" && i + 1 < argc)
+		{
+			if (!parseBatchFormat(argv[++i], command.format))
+				return false;
+		}
+		else if (option == "--threads" && i + 1 < argc)
+			command.threads = (size_t)atoi(argv[++i]);
+		else if (option == "--make-corpus" && i + 1 < argc)
+			command.corpusPath = argv[++i];
+		else if (option == "--checkpoint" && i + 1 < argc)
+			command.checkpointPath = argv[++i];
+		else
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Write each cube in the text batch input to a corpus at the given path,
+ * reporting any line that isn't a valid cube on stderr.
+ *
+ * Return the exit code.
+ */
+int makeCorpus(FILE* input, const std::string& path)
+{
+	CorpusWriter corpus;
+	if (!corpus.open(path))
+	{
+		std::cerr << "Couldn't create " << path << std::endl;
+		return 1;
+	}
+	LineReader reader(input);
+	std::string line;
+	for (size_t number = 1; reader.next(line); number++)
+	{
+		if (line.find_first_not_of(" \t") == std::string::npos)
+			continue;
+		Cube cube;
+		const char* error = parseCube(line.c_str(), cube);
+		if (error != nullptr)
+			std::cerr << "Line " << number << ": " << error << std::endl;
+		else
+			corpus.add(cube);
+	}
+	size_t count = corpus.size();
+	if (!corpus.close())
+	{
+		std::cerr << "Couldn't write " << path << std::endl;
+		return 1;
+	}
+	std::cerr << "Wrote " << count << " cubes to " << path << std::endl;
+	return 0;
+}
+
+/**
+ * Solve every cube in the batch input, writing a result for each, and
+ * report the throughput on stderr (so it stays out of the results).
+ *
+ * Input that's a corpus is solved through the pipeline, and anything
+ * else is read as text a line at a time.
+ *
+ * Return the exit code.
+ */
+int runBatch(const SolveOptions& options, const CommandLine& command)
+{
+	Corpus corpus;
+	bool binaryInput = !command.inputPath.empty() && corpus.open(command.inputPath);
+	FILE* input = command.inputPath.empty() ? stdin : binaryInput ? nullptr : fopen(command.inputPath.c_str(), "rb");
+	if (!binaryInput && input == nullptr)
+	{
+		std::cerr << "Couldn't open " << command.inputPath << std::endl;
+		return 1;
+	}
+	if (!command.corpusPath.empty())
+	{
+		int result = binaryInput ? 1 : makeCorpus(input, command.corpusPath);
+		if (input != nullptr && input != stdin)
+			fclose(input);
+		return result;
+	}
+	if (!binaryInput && command.format == BATCH_FORMAT::BINARY)
+	{
+		std::cerr << "Binary output needs a corpus as input (see --make-corpus)" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<Checkpointer> checkpointer;
+	if (!command.checkpointPath.empty())
+	{
+		// a resumed job has to truncate its output, which stdout can't do, and check its input is the same
+		CheckpointJob job;
+		job.settings = hashOptions(options) * 31 + (uint64_t)command.format;
+		if (command.outputPath.empty() || command.inputPath.empty() || !job.readInput(command.inputPath))
+		{
+			std::cerr << "Checkpoints need an input file and an output file (see --input and --output)" << std::endl;
+			return 1;
+		}
+		checkpointer.reset(new Checkpointer(command.checkpointPath, job));
+		if (checkpointer->mismatched())
+		{
+			std::cerr << "The checkpoint at " << command.checkpointPath << " is for another job or input"
+				<< " (remove it to start over)" << std::endl;
+			return 1;
+		}
+		if (checkpointer->hasStart())
+			std::cerr << "Resuming after " << checkpointer->start().count << " cubes" << std::endl;
+	}
+	FILE* output = command.outputPath.empty() ? stdout : checkpointer ?
+		openCheckpointedOutput(command.outputPath, *checkpointer) : fopen(command.outputPath.c_str(), "wb");
+	if (output == nullptr)
+	{
+		std::cerr << "Couldn't open " << command.outputPath << std::endl;
+		return 1;
+	}
+
+	BatchStats stats;
+	size_t threads = command.threads;
+	if (binaryInput)
+	{
+		stats = solveCorpus(corpus, output, options, command.format, threads, checkpointer.get());
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+	}
+	else
+	{
+		ThreadPool pool(command.threads);
+		stats = solveStream(input, output, options, command.format, pool, checkpointer.get());
+		threads = pool.size();
+	}
+	std::cerr << "Solved " << stats.count << " cubes in " << stats.seconds << " s (" << (size_t)stats.solvesPerSecond
+		<< " solves/s on " << threads << " threads)" << std::endl;
+
+	if (input != nullptr && input != stdin)
+		fclose(input);
+	if (checkpointer && !checkpointer->good())
+		std::cerr << "Couldn't save a checkpoint to " << command.checkpointPath << std::endl;
+	if ((output != stdout && fclose(output) != 0) || (checkpointer && !checkpointer->good()))
+		return 1;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	SolveOptions options;
+	CommandLine command;
+	if (!readOptions(argc, argv, options, command))
+	{
+		std::cout << "Usage: " << argv[0] << " [--metric htm|qtm|stm|etm] [--moves any|faces|slices]"
+			<< " [--allow MOVES] [--cost MOVE=COST]... [--timing QUARTER,HALF,SETTLE] [--fastest] [--budget MS]"
+			<< " [--schedule] [--test] [--bench] [--bench-cache] [--bench-anytime] [--bench-stream]"
+			<< " [--bench-web] [--bench-session] [--bench-hints] [--bench-permutations] [--store PATH]"
+			<< " [--daemon PATH] [--bench-daemon PATH]"
+			<< " [--batch [--input PATH] [--output PATH] [--format text|json|binary] [--threads N] [--make-corpus PATH] [--checkpoint PATH]]" << std::endl;
+		return 1;
+	}
+
+	// the peephole test loads its own table, and every test runs, so one that fails can't hide the others
+	if (command.test)
+	{
+		bool (*const tests[])() = { testOptimizer, testPeephole, testRestrictedSolves, testRobotSchedules,
+			testConcurrentSolves, testBatchSolves, testAllocationFreeSolves, testAnytimeSolves, testPhaseStreaming,
+			testSolutionPhases, testPackedSolutions, testPackedStates, testSessions, testHints, testSolveBetween,
+			testPermutations, testCachedSolutions, testSolutionStore, testBatchStream, testCorpusPipeline,
+			testCheckpointResume, testScheduler, testDaemon, testCInterface };
+		bool passed = true;
+		for (bool (*test)() : tests)
+			passed = test() && passed;
+		return passed ? 0 : 1;
+	}
+
+	// map the optimal sequence table, building it on the first run
+	loadPeepholeTable("peephole.table");
+
+	if (command.bench)
+	{
+		benchmarkBatch();
+		return 0;
+	}
+	if (command.benchCache)
+	{
+		benchmarkCache();
+		return 0;
+	}
+	if (command.benchAnytime)
+	{
+		benchmarkAnytime(options);
+		return 0;
+	}
+	if (command.benchStream)
+	{
+		benchmarkStreaming();
+		return 0;
+	}
+	if (command.benchWeb)
+	{
+		benchmarkWeb(command.threads);
+		return 0;
+	}
+	if (command.benchSession)
+	{
+		benchmarkSession(options);
+		return 0;
+	}
+	if (command.benchHints)
+	{
+		benchmarkHints();
+		return 0;
+	}
+	if (command.benchPermutations)
+	{
+		benchmarkPermutations();
+		return 0;
+	}
+	if (!command.benchDaemonPath.empty())
+	{
+		benchmarkDaemon(command.benchDaemonPath, options, command.threads);
+		return 0;
+	}
+	if (!command.daemonPath.empty())
+	{
+		Daemon daemon(options, command.threads);
+		if (!daemon.listen(command.daemonPath))
+		{
+			std::cerr << "Couldn't listen on " << command.daemonPath << std::endl;
+			return 1;
+		}
+		std::cerr << "Listening on " << command.daemonPath << std::endl;
+		daemon.serve();
+		return 0;
+	}
+	if (command.batch)
+		return runBatch(options, command);
+
+	// get a scramble from the user
+	std::string scramble;
+	std::cout << "Enter scramble: ";
+	std::getline(std::cin, scramble);
+
+	// get the solution
+	Cube c;
+	c.readMoves(scramble);
+
+	// the robot only turns faces, so write the solution it performs in them
+	if (command.schedule)
+		options.moveSet = MOVE_SET::FACE_TURNS;
+
+	// reuse solutions from earlier runs, writing new ones unless another process is
+	SolutionStore store;
+	if (!command.storePath.empty() && !store.openForWriting(command.storePath, options, STORE_CAPACITY, true) &&
+		!store.open(command.storePath, options))
+		std::cout << "Couldn't open the solution store at " << command.storePath << std::endl;
+
+	Solution solution;
+	if (!options.restriction.isDefault() || options.minimizeTime)
+	{
+		// restricted solutions are already optimized
+		solution = store.isOpen() ? store.solve(c) : solve(c, options);
+		if (!solution.solved)
+			std::cout << "\nSome moves can't be made from the allowed moves.\n";
+		else
+		{
+			std::cout << "\nSolution (" << solution.size() << " moves, cost "
+				<< solutionCost(solution.toMoves(), options.restriction) << "):\n\n";
+			printSolution(solution);
+		}
+	}
+	else
+	{
+		SolveOptions stepOptions = options;
+		stepOptions.optimize = false;
+		solution = solve(c, stepOptions);
+		std::cout << "\nSolution:\n\n";
+		printSolution(solution);
+
+		solution = store.isOpen() ? store.solve(c) : solve(c, options);
+		std::cout << "\nOptimized (" << countMoves(solution.toMoves(), options.metric) << " moves, "
+			<< metricToString(options.metric) << "):\n\n";
+		printSolution(solution);
+	}
+
+	if (command.schedule && solution.solved)
+	{
+		Schedule robotSchedule = scheduleSolution(solution.toMoves(), options.timing);
+		std::cout << "\nSchedule (" << robotSchedule.steps.size() << " steps, " << robotSchedule.time << " ms):\n\n"
+			<< scheduleToString(robotSchedule) << std::endl;
+	}
 
 	std::cout << "\nPress Enter to exit" << std::endl;
 	std::cin.get();
@@ -0,0 +1,176 @@
+#include <string.h>
+
+#include "Client.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+SolverClient::SolverClient() : socket(-1), input(MAX_FRAME_SIZE * 16), begin(0), end(0) {}
+
+SolverClient::~SolverClient() { close(); }
+
+/**
+ * Connect to the daemon listening at the given path.
+ */
+bool SolverClient::connect(const std::string& path)
+{
+	close();
+#ifndef _WIN32
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path))
+		return false;
+	memcpy(address.sun_path, path.c_str(), path.size());
+
+	socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket >= 0 && ::connect(socket, (const sockaddr*)&address, sizeof(address)) != 0)
+		close();
+#endif
+	return socket >= 0;
+}
+
+/**
+ * Close the connection, dropping any queued requests and unread
+ * responses.
+ */
+void SolverClient::close()
+{
+#ifndef _WIN32
+	if (socket >= 0)
+		::close(socket);
+#endif
+	socket = -1;
+	output.clear();
+	begin = end = 0;
+}
+
+/**
+ * Queue a request to solve the given cube.
+ */
+void SolverClient::send(uint32_t id, const Cube& cube)
+{
+	writeStateRequest(id, cube, output);
+}
+
+/**
+ * Queue a request to solve the given line of batch input.
+ */
+void SolverClient::send(uint32_t id, const std::string& moves)
+{
+	writeMovesRequest(id, moves, output);
+}
+
+/**
+ * Send the queued requests.
+ */
+bool SolverClient::flush()
+{
+	if (socket < 0)
+		return false;
+	bool sent = sendAll(socket, output.data(), output.size());
+	output.clear();
+	return sent;
+}
+
+/**
+ * Queue a request to set the class of later requests.
+ */
+void SolverClient::setClass(PRIORITY priority, uint32_t deadlineMicroseconds, bool dropLate)
+{
+	writeClassRequest(priority, deadlineMicroseconds, dropLate, output);
+}
+
+/**
+ * Queue a request to cancel the request with the given id.
+ */
+void SolverClient::cancel(uint32_t id)
+{
+	writeCancelRequest(id, output);
+}
+
+/**
+ * Wait for the next response's frame, flushing first. Responses are
+ * read a block at a time, so a run of pipelined responses mostly comes
+ * out of the buffer. The frame's payload stays in the buffer until the
+ * next one is read.
+ */
+bool SolverClient::receiveFrame(Frame& frame)
+{
+	if (!output.empty() && !flush())
+		return false;
+
+	size_t length;
+	while (socket >= 0)
+	{
+		if (!readFrame(input.data() + begin, end - begin, frame, length))
+			break;
+		if (length > 0)
+		{
+			begin += length;
+			return true;
+		}
+
+		memmove(input.data(), input.data() + begin, end - begin);
+		end -= begin;
+		begin = 0;
+		size_t received = receiveSome(socket, input.data() + end, input.size() - end);
+		if (received == 0)
+			break;
+		end += received;
+	}
+	close();
+	return false;
+}
+
+/**
+ * Wait for the next response.
+ */
+bool SolverClient::receive(uint32_t& id, RESPONSE& status, Solution& solution)
+{
+	Frame frame;
+	if (!receiveFrame(frame))
+		return false;
+	id = frame.id;
+	status = (RESPONSE)frame.type;
+	solution = Solution();
+	if (status != RESPONSE::OK && status != RESPONSE::DEGRADED)
+		return true;
+	return unpackSolution(frame.payload, frame.payloadSize, solution) > 0;
+}
+
+/**
+ * Solve the given cube, waiting for the response.
+ */
+bool SolverClient::solve(const Cube& cube, RESPONSE& status, Solution& solution)
+{
+	uint32_t id;
+	send(0, cube);
+	return receive(id, status, solution);
+}
+
+/**
+ * Solve the given line of batch input, waiting for the response.
+ */
+bool SolverClient::solve(const std::string& moves, RESPONSE& status, Solution& solution)
+{
+	uint32_t id;
+	send(0, moves);
+	return receive(id, status, solution);
+}
+
+/**
+ * Read the daemon's stats, waiting for the response.
+ */
+bool SolverClient::stats(std::string& text)
+{
+	writeStatsRequest(0, output);
+	Frame frame;
+	if (!receiveFrame(frame) || frame.type != (uint8_t)RESPONSE::OK)
+		return false;
+	text.assign((const char*)frame.payload, frame.payloadSize);
+	return true;
+}
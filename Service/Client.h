@@ -0,0 +1,93 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Protocol.h"
+
+class SolverClient
+{
+	/**
+	 * This class sends solve requests to a daemon (see Daemon.h) over its
+	 * socket.
+	 *
+	 * Requests are queued until they're flushed (or a response is waited
+	 * for), so many can be sent with one write, and any number can be in
+	 * flight at once. Responses come back in the order their requests
+	 * were sent.
+	 */
+
+public:
+	SolverClient();
+	~SolverClient();
+
+	/**
+	 * Connect to the daemon listening at the given path, returning false
+	 * if there isn't one.
+	 */
+	bool connect(const std::string& path);
+	void close();
+	bool isConnected() const { return socket >= 0; }
+
+	/**
+	 * Queue a request to solve the given cube, or the given line of
+	 * batch input (a scramble or a state), with the given id.
+	 */
+	void send(uint32_t id, const Cube& cube);
+	void send(uint32_t id, const std::string& moves);
+
+	/**
+	 * Queue a request to give later requests the given priority class and
+	 * deadline (in microseconds after each one arrives, 0 for none),
+	 * dropping them if they'd miss it rather than solving them fast.
+	 */
+	void setClass(PRIORITY priority, uint32_t deadlineMicroseconds = 0, bool dropLate = false);
+
+	/**
+	 * Queue a request to cancel the request with the given id.
+	 */
+	void cancel(uint32_t id);
+
+	/**
+	 * Send the queued requests, returning false if the connection is
+	 * closed.
+	 */
+	bool flush();
+
+	/**
+	 * Wait for the next response, flushing first, and read its id,
+	 * status and solution (which has no moves unless it's OK or
+	 * DEGRADED). Return false if the connection closes first.
+	 */
+	bool receive(uint32_t& id, RESPONSE& status, Solution& solution);
+
+	/**
+	 * Solve the given cube, or line of batch input, waiting for the
+	 * response. Only use these with no other requests in flight.
+	 */
+	bool solve(const Cube& cube, RESPONSE& status, Solution& solution);
+	bool solve(const std::string& moves, RESPONSE& status, Solution& solution);
+
+	/**
+	 * Read the daemon's stats for each priority class, as lines of JSON
+	 * (see statsToJson). Only use this with no other requests in flight.
+	 */
+	bool stats(std::string& text);
+
+private:
+	SolverClient(const SolverClient&);
+	SolverClient& operator=(const SolverClient&);
+
+	bool receiveFrame(Frame& frame);
+
+	int socket;
+	std::vector<uint8_t> output;
+	std::vector<uint8_t> input;
+	size_t begin;
+	size_t end;
+};
+
+#endif
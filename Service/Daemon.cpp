@@ -0,0 +1,344 @@
+#include <string.h>
+#include <vector>
+
+#include "Daemon.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+Daemon::Daemon(const SolveOptions& options, size_t numThreads) :
+	scheduler(options, numThreads), listener(-1), stopping(false), numServed(0) {}
+
+Daemon::~Daemon()
+{
+	stop();
+#ifndef _WIN32
+	// listening without ever serving
+	if (listener >= 0)
+	{
+		::close(listener);
+		unlink(path.c_str());
+	}
+#endif
+}
+
+/**
+ * Listen on a socket at the given path. Only a socket is replaced, so a
+ * mistyped path can't delete a file.
+ */
+bool Daemon::listen(const std::string& path)
+{
+#ifndef _WIN32
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (listener >= 0 || path.empty() || path.size() >= sizeof(address.sun_path))
+		return false;
+	memcpy(address.sun_path, path.c_str(), path.size());
+
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+		unlink(path.c_str());
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		return false;
+	if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0)
+	{
+		::close(listener);
+		listener = -1;
+		return false;
+	}
+	this->path = path;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Accept connections until stop is called, giving each one a thread.
+ * Threads whose connections have closed are joined as new ones arrive.
+ */
+void Daemon::serve()
+{
+#ifndef _WIN32
+	while (!stopping)
+	{
+		int socket = accept(listener, nullptr, nullptr);
+		if (socket < 0)
+		{
+			if (!stopping && (errno == EINTR || errno == ECONNABORTED))
+				continue;
+			break;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		reapConnections();
+		if (stopping)
+		{
+			::close(socket);
+			break;
+		}
+		connections.emplace_back();
+		Connection* connection = &connections.back();
+		connection->socket = socket;
+		connection->thread = std::thread(&Daemon::serveConnection, this, connection);
+	}
+
+	stopping = true;
+	// the connections are moved out under the lock, so a stop from another thread never sees them freed
+	std::list<Connection> closing;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Connection& connection : connections)
+		{
+			if (!connection.done)
+				shutdown(connection.socket, SHUT_RDWR);
+		}
+		closing.splice(closing.end(), connections);
+		::close(listener);
+		listener = -1;
+		unlink(path.c_str());
+	}
+	// the threads need the lock to finish
+	for (Connection& connection : closing)
+		connection.thread.join();
+#endif
+}
+
+/**
+ * Stop serving. Shutting the sockets down wakes the threads waiting on
+ * them.
+ */
+void Daemon::stop()
+{
+#ifndef _WIN32
+	stopping = true;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (listener >= 0)
+		shutdown(listener, SHUT_RDWR);
+	for (Connection& connection : connections)
+	{
+		if (!connection.done)
+			shutdown(connection.socket, SHUT_RDWR);
+	}
+#endif
+}
+
+/**
+ * Join the threads of connections that have closed. The lock must be
+ * held.
+ */
+void Daemon::reapConnections()
+{
+	for (std::list<Connection>::iterator i = connections.begin(); i != connections.end();)
+	{
+		if (i->done)
+		{
+			i->thread.join();
+			i = connections.erase(i);
+		}
+		else
+			i++;
+	}
+}
+
+/**
+ * Read one connection's requests until it closes or sends something
+ * that isn't a frame, then cancel the requests it's still waiting on
+ * and wait for the writer to finish with them.
+ *
+ * Frames are read straight out of the input buffer. Once none are left,
+ * any partial frame moves to the front of the buffer before reading
+ * more, so a buffer of several frames always has room.
+ */
+void Daemon::serveConnection(Connection* connection)
+{
+	std::thread writer(&Daemon::writeResponses, this, connection);
+	std::vector<uint8_t> input(MAX_FRAME_SIZE * 16);
+	size_t begin = 0;
+	size_t end = 0;
+	Frame frame;
+	size_t length;
+	while (readFrame(input.data() + begin, end - begin, frame, length))
+	{
+		if (length > 0)
+		{
+			begin += length;
+			readRequest(connection, frame);
+			continue;
+		}
+		memmove(input.data(), input.data() + begin, end - begin);
+		end -= begin;
+		begin = 0;
+		size_t received = receiveSome(connection->socket, input.data() + end, input.size() - end);
+		if (received == 0)
+			break;
+		end += received;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(connection->mutex);
+		connection->closing = true;
+		for (std::unique_ptr<Request>& request : connection->pending)
+			request->job.cancelled = true;
+	}
+	connection->changed.notify_all();
+	writer.join();
+
+#ifndef _WIN32
+	std::lock_guard<std::mutex> lock(mutex);
+	::close(connection->socket);
+	connection->done = true;
+#endif
+}
+
+/**
+ * Act on one request: change the connection's class, cancel a request,
+ * or add a request to the ones waiting for responses, handing it to the
+ * scheduler if it's a valid cube to solve.
+ */
+void Daemon::readRequest(Connection* connection, const Frame& frame)
+{
+	std::unique_ptr<Request> request(new Request());
+	request->id = frame.id;
+	request->status = RESPONSE::OK;
+	request->finished = true;
+	request->connection = connection;
+
+	if (frame.type == (uint8_t)REQUEST::SET_CLASS)
+	{
+		if (frame.payloadSize == CLASS_PAYLOAD_SIZE && frame.payload[0] < NUM_PRIORITIES)
+		{
+			connection->priority = (PRIORITY)frame.payload[0];
+			connection->deadline = (uint32_t)readLittleEndian(frame.payload + 1, 4);
+			connection->dropLate = frame.payload[5] != 0;
+			return;
+		}
+		request->status = RESPONSE::BAD_REQUEST;
+	}
+	else if (frame.type == (uint8_t)REQUEST::CANCEL)
+	{
+		std::lock_guard<std::mutex> lock(connection->mutex);
+		for (std::unique_ptr<Request>& waiting : connection->pending)
+		{
+			if (waiting->id == frame.id)
+				waiting->job.cancelled = true;
+		}
+		return;
+	}
+	else if (frame.type == (uint8_t)REQUEST::STATS)
+	{
+		for (uint8_t p = 0; p < NUM_PRIORITIES; p++)
+			request->text += statsToJson((PRIORITY)p, scheduler.stats((PRIORITY)p));
+	}
+	else if (frame.type == (uint8_t)REQUEST::SOLVE_STATE || frame.type == (uint8_t)REQUEST::SOLVE_MOVES)
+	{
+		request->status = readSolveRequest(frame, request->job.cube);
+		if (request->status == RESPONSE::OK)
+		{
+			SolveJob& job = request->job;
+			job.priority = connection->priority;
+			if (connection->deadline > 0)
+				job.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(connection->deadline);
+			job.dropLate = connection->dropLate;
+			job.finished = &Daemon::finishJob;
+			job.context = request.get();
+			request->finished = false;
+		}
+	}
+	else
+		request->status = RESPONSE::BAD_REQUEST;
+
+	Request* queued = request.get();
+	{
+		std::unique_lock<std::mutex> lock(connection->mutex);
+		connection->changed.wait(lock, [connection]() { return connection->pending.size() < MAX_PENDING_REQUESTS; });
+		connection->pending.push_back(std::move(request));
+	}
+	if (queued->finished)
+		connection->changed.notify_all();
+	else
+		scheduler.submit(&queued->job);
+}
+
+/**
+ * Set the response to a request the scheduler has finished, and wake
+ * its connection's writer.
+ */
+void Daemon::finishJob(SolveJob* job, void* context)
+{
+	Request* request = (Request*)context;
+	Connection* connection = request->connection;
+	{
+		std::lock_guard<std::mutex> lock(connection->mutex);
+		if (job->dropped)
+			request->status = RESPONSE::DROPPED;
+		else if (job->cancelled && !job->solution.solved)
+			request->status = RESPONSE::CANCELLED;
+		else if (!job->solution.solved)
+			request->status = RESPONSE::UNSOLVED;
+		else
+			request->status = job->degraded ? RESPONSE::DEGRADED : RESPONSE::OK;
+		request->finished = true;
+		// still under the lock, since the connection can close as soon as it's released
+		connection->changed.notify_all();
+	}
+}
+
+/**
+ * Send the responses to a connection's requests, in the order the
+ * requests arrived, until it's closing and every request is answered.
+ *
+ * Each run of finished requests at the front is sent with one write,
+ * without holding the lock. If the client has gone, the rest are still
+ * waited for (they're cancelled, so that's quick) but not sent.
+ */
+void Daemon::writeResponses(Connection* connection)
+{
+	std::vector<uint8_t> output;
+	std::vector<std::unique_ptr<Request>> answered;
+	bool open = true;
+	std::unique_lock<std::mutex> lock(connection->mutex);
+	while (true)
+	{
+		connection->changed.wait(lock, [connection]() {
+			return connection->pending.empty() ? connection->closing : connection->pending.front()->finished;
+		});
+		if (connection->pending.empty())
+			break;
+
+		output.clear();
+		while (!connection->pending.empty() && connection->pending.front()->finished)
+		{
+			Request& request = *connection->pending.front();
+			if (request.text.empty())
+				writeResponse(request.id, request.status, request.job.solution, output);
+			else
+				writeTextResponse(request.id, request.text, output);
+			answered.push_back(std::move(connection->pending.front()));
+			connection->pending.pop_front();
+		}
+		// there's room for the reader again
+		connection->changed.notify_all();
+
+		lock.unlock();
+		if (open && !sendAll(connection->socket, output.data(), output.size()))
+		{
+			open = false;
+#ifndef _WIN32
+			// wake the reader, so it closes the connection
+			shutdown(connection->socket, SHUT_RDWR);
+#endif
+		}
+		numServed += answered.size();
+		answered.clear();
+		lock.lock();
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Protocol.h"
+#include "Scheduler.h"
+#include "Solver.h"
+
+class Daemon
+{
+	/**
+	 * This class serves solve requests over a Unix domain socket, so the
+	 * solver's tables are set up once rather than on every run.
+	 *
+	 * Each connection has a thread that reads its requests (see
+	 * Protocol.h) and hands them to the scheduler as they arrive, so a
+	 * client that pipelines its requests has them solved in parallel,
+	 * in order of their priority class and deadline. Another thread per
+	 * connection sends the responses, in the order the requests came,
+	 * as they finish, with one write for every run of finished ones.
+	 */
+
+public:
+	/**
+	 * Create a daemon that solves with the given options on the given
+	 * number of threads (zero uses one per hardware thread).
+	 */
+	explicit Daemon(const SolveOptions& options, size_t numThreads = 0);
+	~Daemon();
+
+	/**
+	 * Listen on a socket at the given path, replacing any socket left
+	 * there, returning false if it can't.
+	 */
+	bool listen(const std::string& path);
+
+	/**
+	 * Accept connections and serve their requests until stop is called,
+	 * then close them all and remove the socket.
+	 */
+	void serve();
+
+	/**
+	 * Stop serving, from any thread.
+	 */
+	void stop();
+
+	/**
+	 * Number of requests answered so far, and the counts for the given
+	 * priority class.
+	 */
+	size_t served() const { return numServed; }
+	ClassStats stats(PRIORITY priority) const { return scheduler.stats(priority); }
+
+private:
+	Daemon(const Daemon&);
+	Daemon& operator=(const Daemon&);
+
+	/**
+	 * Most requests a connection can have waiting for responses. Past
+	 * that, it stops reading until some are answered.
+	 */
+	static const size_t MAX_PENDING_REQUESTS = 4096;
+
+	struct Connection;
+
+	/**
+	 * A request read from a connection, and its response once it's
+	 * finished.
+	 */
+	struct Request
+	{
+		uint32_t id;
+		RESPONSE status;
+		bool finished;
+		SolveJob job;
+		std::string text;
+		Connection* connection;
+	};
+
+	/**
+	 * A connection's socket and threads, the class its requests are
+	 * given (deadlines in microseconds, 0 for none) and the requests it's
+	 * waiting to answer, in the order they arrived.
+	 */
+	struct Connection
+	{
+		int socket;
+		std::thread thread;
+		bool done = false;
+
+		PRIORITY priority = PRIORITY::NORMAL;
+		uint32_t deadline = 0;
+		bool dropLate = false;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::deque<std::unique_ptr<Request>> pending;
+		bool closing = false;
+	};
+
+	void serveConnection(Connection* connection);
+	void readRequest(Connection* connection, const Frame& frame);
+	void writeResponses(Connection* connection);
+	void reapConnections();
+	static void finishJob(SolveJob* job, void* context);
+
+	Scheduler scheduler;
+	std::string path;
+	int listener;
+	std::atomic<bool> stopping;
+	std::atomic<size_t> numServed;
+
+	std::mutex mutex;
+	std::list<Connection> connections;
+};
+
+#endif
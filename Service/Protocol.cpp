@@ -0,0 +1,232 @@
+#include <algorithm>
+
+#include "Batch.h"
+#include "PackedMoves.h"
+#include "Protocol.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
+/**
+ * Name of a response status.
+ */
+const char* responseToString(RESPONSE status)
+{
+	switch (status)
+	{
+	case RESPONSE::OK:
+		return "ok";
+	case RESPONSE::BAD_REQUEST:
+		return "bad request";
+	case RESPONSE::INVALID_CUBE:
+		return "invalid cube";
+	case RESPONSE::UNSOLVED:
+		return "unsolved";
+	case RESPONSE::DEGRADED:
+		return "degraded";
+	case RESPONSE::DROPPED:
+		return "dropped";
+	case RESPONSE::CANCELLED:
+		return "cancelled";
+	}
+	return "unknown";
+}
+
+/**
+ * Append a frame's header to the given bytes, with the length left to
+ * be filled in once the payload is written, returning where it starts.
+ */
+size_t beginFrame(uint32_t id, uint8_t type, std::vector<uint8_t>& bytes)
+{
+	size_t start = bytes.size();
+	bytes.resize(start + FRAME_HEADER_SIZE);
+	writeLittleEndian(id, 4, &bytes[start + 4]);
+	bytes[start + 8] = type;
+	return start;
+}
+
+/**
+ * Fill in the length of the frame that starts at the given offset.
+ */
+void endFrame(size_t start, std::vector<uint8_t>& bytes)
+{
+	writeLittleEndian(bytes.size() - start - 4, 4, &bytes[start]);
+}
+
+/**
+ * Append a request to solve the given cube.
+ */
+void writeStateRequest(uint32_t id, const Cube& cube, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)REQUEST::SOLVE_STATE, bytes);
+	bytes.resize(bytes.size() + PACKED_STATE_BYTES);
+	packState(cube, &bytes[bytes.size() - PACKED_STATE_BYTES]);
+	endFrame(start, bytes);
+}
+
+/**
+ * Append a request to solve the given line of batch input, cut short
+ * if it doesn't fit in a frame.
+ */
+void writeMovesRequest(uint32_t id, const std::string& moves, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)REQUEST::SOLVE_MOVES, bytes);
+	bytes.insert(bytes.end(), moves.begin(), moves.begin() + std::min(moves.size(), MAX_FRAME_SIZE - FRAME_HEADER_SIZE));
+	endFrame(start, bytes);
+}
+
+/**
+ * Append a request to set the class of later requests.
+ */
+void writeClassRequest(PRIORITY priority, uint32_t deadlineMicroseconds, bool dropLate, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(0, (uint8_t)REQUEST::SET_CLASS, bytes);
+	bytes.resize(bytes.size() + CLASS_PAYLOAD_SIZE);
+	uint8_t* payload = &bytes[bytes.size() - CLASS_PAYLOAD_SIZE];
+	payload[0] = (uint8_t)priority;
+	writeLittleEndian(deadlineMicroseconds, 4, payload + 1);
+	payload[5] = dropLate;
+	endFrame(start, bytes);
+}
+
+/**
+ * Append a request to cancel the request with the given id.
+ */
+void writeCancelRequest(uint32_t id, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)REQUEST::CANCEL, bytes);
+	endFrame(start, bytes);
+}
+
+/**
+ * Append a request for the daemon's stats.
+ */
+void writeStatsRequest(uint32_t id, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)REQUEST::STATS, bytes);
+	endFrame(start, bytes);
+}
+
+/**
+ * Append a response with the given status.
+ */
+void writeResponse(uint32_t id, RESPONSE status, const Solution& solution, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)status, bytes);
+	if (status == RESPONSE::OK || status == RESPONSE::DEGRADED)
+		packSolution(solution, bytes);
+	endFrame(start, bytes);
+}
+
+/**
+ * Append an OK response holding the given text, cut short if it doesn't
+ * fit in a frame.
+ */
+void writeTextResponse(uint32_t id, const std::string& text, std::vector<uint8_t>& bytes)
+{
+	size_t start = beginFrame(id, (uint8_t)RESPONSE::OK, bytes);
+	bytes.insert(bytes.end(), text.begin(), text.begin() + std::min(text.size(), MAX_FRAME_SIZE - FRAME_HEADER_SIZE));
+	endFrame(start, bytes);
+}
+
+/**
+ * Write the given class's stats as a line of JSON.
+ */
+std::string statsToJson(PRIORITY priority, const ClassStats& stats)
+{
+	return std::string("{\"class\":\"") + priorityToString(priority) + "\",\"finished\":" + std::to_string(stats.finished) +
+		",\"degraded\":" + std::to_string(stats.degraded) + ",\"dropped\":" + std::to_string(stats.dropped) +
+		",\"cancelled\":" + std::to_string(stats.cancelled) + ",\"deadline_misses\":" + std::to_string(stats.deadlineMisses) +
+		",\"wait_mean_us\":" + std::to_string((uint64_t)(stats.meanWait() * 1e6)) +
+		",\"wait_p50_us\":" + std::to_string((uint64_t)(stats.waitPercentile(0.5) * 1e6)) +
+		",\"wait_p99_us\":" + std::to_string((uint64_t)(stats.waitPercentile(0.99) * 1e6)) +
+		",\"wait_max_us\":" + std::to_string((uint64_t)(stats.maxWait * 1e6)) + "}\n";
+}
+
+/**
+ * Read the frame at the start of the given bytes.
+ */
+bool readFrame(const uint8_t* bytes, size_t size, Frame& frame, size_t& length)
+{
+	length = 0;
+	if (size < 4)
+		return true;
+	size_t frameSize = (size_t)readLittleEndian(bytes, 4) + 4;
+	if (frameSize < FRAME_HEADER_SIZE || frameSize > MAX_FRAME_SIZE)
+		return false;
+	if (size < frameSize)
+		return true;
+
+	frame.id = (uint32_t)readLittleEndian(bytes + 4, 4);
+	frame.type = bytes[8];
+	frame.payload = bytes + FRAME_HEADER_SIZE;
+	frame.payloadSize = frameSize - FRAME_HEADER_SIZE;
+	length = frameSize;
+	return true;
+}
+
+/**
+ * Read the cube from the given solve request, returning the response's
+ * status if it isn't valid, or OK otherwise.
+ */
+RESPONSE readSolveRequest(const Frame& frame, Cube& cube)
+{
+	if (frame.type == (uint8_t)REQUEST::SOLVE_STATE)
+	{
+		if (frame.payloadSize != PACKED_STATE_BYTES)
+			return RESPONSE::BAD_REQUEST;
+		return unpackState(frame.payload, cube) ? RESPONSE::OK : RESPONSE::INVALID_CUBE;
+	}
+	std::string line((const char*)frame.payload, frame.payloadSize);
+	return parseCube(line.c_str(), cube) == nullptr ? RESPONSE::OK : RESPONSE::INVALID_CUBE;
+}
+
+/**
+ * Send all the given bytes on the given socket, retrying if it's
+ * interrupted or takes only part of them.
+ */
+bool sendAll(int socket, const uint8_t* bytes, size_t size)
+{
+#ifndef _WIN32
+	// a peer that hangs up shouldn't kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	while (size > 0)
+	{
+		ssize_t sent = send(socket, bytes, size, flags);
+		if (sent < 0 && errno == EINTR)
+			continue;
+		if (sent <= 0)
+			return false;
+		bytes += sent;
+		size -= (size_t)sent;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Receive whatever bytes have arrived on the given socket, waiting for
+ * at least one.
+ */
+size_t receiveSome(int socket, uint8_t* bytes, size_t size)
+{
+#ifndef _WIN32
+	while (true)
+	{
+		ssize_t received = recv(socket, bytes, size, 0);
+		if (received < 0 && errno == EINTR)
+			continue;
+		return received > 0 ? (size_t)received : 0;
+	}
+#else
+	return 0;
+#endif
+}
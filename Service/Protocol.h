@@ -0,0 +1,123 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Cube.h"
+#include "Scheduler.h"
+#include "Solution.h"
+
+/**
+ * The daemon's wire protocol. Every message is a frame: the length of
+ * the rest of the frame (4 bytes), the request's id (4 bytes, chosen by
+ * the client), a type or status byte, then a payload, all little endian.
+ *
+ * A SOLVE_STATE request's payload is a cube packed into 3 words (see
+ * Cube::pack), and a SOLVE_MOVES request's is a line of batch input (a
+ * scramble or a state, see parseCube). A response's payload is its
+ * solution, packed (see packSolution), if it's OK or DEGRADED (solved
+ * by the fast path to meet its deadline), and nothing otherwise.
+ *
+ * A SET_CLASS request sets the priority class (1 byte), deadline (4
+ * bytes of microseconds after each request arrives, 0 for none) and
+ * whether to drop requests that would miss it (1 byte) for the
+ * connection's later requests. A CANCEL request has the id of a request
+ * to stop solving, and no payload, and that request is answered
+ * CANCELLED unless it's already solved. Neither gets a response, unless
+ * it's malformed, which gets BAD_REQUEST. A STATS request's response is
+ * a line of JSON per priority class (see statsToJson).
+ *
+ * A client can send any number of requests without waiting for their
+ * responses, which come back in the same order.
+ */
+const size_t FRAME_HEADER_SIZE = 9;
+const size_t MAX_FRAME_SIZE = 4096;
+const size_t CLASS_PAYLOAD_SIZE = 6;
+
+/**
+ * 8-bit enums for the type of a request and the status of a response.
+ */
+enum class REQUEST : uint8_t { SOLVE_STATE = 1, SOLVE_MOVES, SET_CLASS, CANCEL, STATS };
+enum class RESPONSE : uint8_t { OK, BAD_REQUEST, INVALID_CUBE, UNSOLVED, DEGRADED, DROPPED, CANCELLED };
+
+/**
+ * Name of a response status.
+ */
+const char* responseToString(RESPONSE status);
+
+/**
+ * A frame read from the wire, whose payload points into the bytes it
+ * was read from.
+ */
+struct Frame
+{
+	uint32_t id;
+	uint8_t type;
+	const uint8_t* payload;
+	size_t payloadSize;
+};
+
+/**
+ * Append the header of a frame with the given id and type to the given
+ * bytes, returning where it starts, and fill in its length once its
+ * payload has been appended after it.
+ */
+size_t beginFrame(uint32_t id, uint8_t type, std::vector<uint8_t>& bytes);
+void endFrame(size_t start, std::vector<uint8_t>& bytes);
+
+/**
+ * Append a request to solve the given cube, or the given line of batch
+ * input, to the given bytes.
+ */
+void writeStateRequest(uint32_t id, const Cube& cube, std::vector<uint8_t>& bytes);
+void writeMovesRequest(uint32_t id, const std::string& moves, std::vector<uint8_t>& bytes);
+
+/**
+ * Append a request to set the class of later requests, to cancel the
+ * request with the given id, or for the daemon's stats.
+ */
+void writeClassRequest(PRIORITY priority, uint32_t deadlineMicroseconds, bool dropLate, std::vector<uint8_t>& bytes);
+void writeCancelRequest(uint32_t id, std::vector<uint8_t>& bytes);
+void writeStatsRequest(uint32_t id, std::vector<uint8_t>& bytes);
+
+/**
+ * Append a response with the given status, and the given solution if
+ * it's OK, to the given bytes.
+ */
+void writeResponse(uint32_t id, RESPONSE status, const Solution& solution, std::vector<uint8_t>& bytes);
+void writeTextResponse(uint32_t id, const std::string& text, std::vector<uint8_t>& bytes);
+
+/**
+ * Write the given class's stats as a line of JSON: its name, the number
+ * of requests finished, degraded, dropped, cancelled and past their
+ * deadline, and their mean, median, 99th percentile and longest wait
+ * in the queue in microseconds.
+ */
+std::string statsToJson(PRIORITY priority, const ClassStats& stats);
+
+/**
+ * Read the frame at the start of the given bytes, setting its length,
+ * which is 0 if it hasn't all arrived yet. Return false if it's too
+ * short or too long to be a frame.
+ */
+bool readFrame(const uint8_t* bytes, size_t size, Frame& frame, size_t& length);
+
+/**
+ * Read the cube from the given SOLVE_STATE or SOLVE_MOVES request,
+ * returning the status to answer with if it isn't valid, or OK.
+ */
+RESPONSE readSolveRequest(const Frame& frame, Cube& cube);
+
+/**
+ * Send all the given bytes on the given socket, returning false if it's
+ * closed. Receive the bytes that have arrived on it, up to the given
+ * size, waiting for some if there are none, and returning 0 if it's
+ * closed. Sockets are Unix domain sockets, so neither works on Windows.
+ */
+bool sendAll(int socket, const uint8_t* bytes, size_t size);
+size_t receiveSome(int socket, uint8_t* bytes, size_t size);
+
+#endif
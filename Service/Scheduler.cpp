@@ -0,0 +1,193 @@
+#include <algorithm>
+
+#include "Scheduler.h"
+
+/**
+ * Weight of each new solve time in the average, so the estimate follows
+ * the load without jumping on one slow solve.
+ */
+const double SOLVE_TIME_WEIGHT = 1.0 / 16;
+
+/**
+ * Name of a priority class.
+ */
+const char* priorityToString(PRIORITY priority)
+{
+	switch (priority)
+	{
+	case PRIORITY::INTERACTIVE:
+		return "interactive";
+	case PRIORITY::NORMAL:
+		return "normal";
+	case PRIORITY::BULK:
+		return "bulk";
+	}
+	return "unknown";
+}
+
+/**
+ * Read a priority class from its name.
+ */
+bool parsePriority(const std::string& name, PRIORITY& priority)
+{
+	for (uint8_t p = 0; p < NUM_PRIORITIES; p++)
+	{
+		if (name == priorityToString((PRIORITY)p))
+		{
+			priority = (PRIORITY)p;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * The wait that the given fraction of solves waited no longer than,
+ * rounded up to a power of two microseconds.
+ */
+double ClassStats::waitPercentile(double fraction) const
+{
+	size_t total = 0;
+	for (size_t count : waits)
+		total += count;
+	size_t seen = 0;
+	for (uint8_t b = 0; b < NUM_WAIT_BUCKETS; b++)
+	{
+		seen += waits[b];
+		if (seen > 0 && seen >= fraction * total)
+			return (double)(1ull << b) / 1e6;
+	}
+	return 0;
+}
+
+/**
+ * Start the threads.
+ */
+Scheduler::Scheduler(const SolveOptions& options, size_t numThreads) :
+	options(options), sequence(0), stopping(false), fullTime(0)
+{
+	if (numThreads == 0)
+		numThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+	for (size_t t = 0; t < numThreads; t++)
+		workers.emplace_back(&Scheduler::workerLoop, this);
+}
+
+/**
+ * Finish the waiting jobs, then stop the threads.
+ */
+Scheduler::~Scheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	ready.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+/**
+ * Queue the given job in its class.
+ */
+void Scheduler::submit(SolveJob* job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job->queued = std::chrono::steady_clock::now();
+		job->sequence = sequence++;
+		queues[(uint8_t)job->priority].push(job);
+	}
+	ready.notify_one();
+}
+
+/**
+ * Counts so far for the given class.
+ */
+ClassStats Scheduler::stats(PRIORITY priority) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return classStats[(uint8_t)priority];
+}
+
+/**
+ * Take the first job of the highest class with any, deciding whether
+ * it can be solved in full by its deadline, then run it.
+ */
+void Scheduler::workerLoop()
+{
+	while (true)
+	{
+		SolveJob* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				for (uint8_t p = 0; p < NUM_PRIORITIES && job == nullptr; p++)
+				{
+					if (!queues[p].empty())
+					{
+						job = queues[p].top();
+						queues[p].pop();
+					}
+				}
+				if (job != nullptr || stopping)
+					break;
+				ready.wait(lock);
+			}
+			if (job == nullptr)
+				return;
+
+			// a job that's cancelled already is just finished
+			TimePoint now = std::chrono::steady_clock::now();
+			bool late = job->deadline != TimePoint::max() && !job->cancelled &&
+				now + std::chrono::duration_cast<TimePoint::duration>(std::chrono::duration<double>(fullTime)) > job->deadline;
+			job->dropped = late && job->dropLate;
+			job->degraded = late && !job->dropLate;
+		}
+		run(job, std::chrono::duration<double>(std::chrono::steady_clock::now() - job->queued).count());
+	}
+}
+
+/**
+ * Solve the given job (unless it's dropped or cancelled already), then
+ * count it and call its callback.
+ */
+void Scheduler::run(SolveJob* job, double wait)
+{
+	TimePoint start = std::chrono::steady_clock::now();
+	job->solution = Solution();
+	bool solved = !job->dropped && !job->cancelled;
+	if (solved)
+	{
+		SolveOptions jobOptions = options;
+		jobOptions.fast = options.fast || job->degraded;
+		jobOptions.cancel = &job->cancelled;
+		job->solution = solve(job->cube, jobOptions);
+	}
+	TimePoint end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// fast and cancelled solves stop early, so they'd throw the estimate off
+		if (solved && !job->degraded && !job->cancelled)
+			fullTime = fullTime == 0 ? seconds : fullTime + (seconds - fullTime) * SOLVE_TIME_WEIGHT;
+
+		ClassStats& stats = classStats[(uint8_t)job->priority];
+		stats.finished++;
+		stats.degraded += job->degraded;
+		stats.dropped += job->dropped;
+		bool cancelled = job->cancelled && !job->dropped && !job->solution.solved;
+		stats.cancelled += cancelled;
+		stats.deadlineMisses += job->dropped || (!cancelled && end > job->deadline);
+		stats.totalWait += wait;
+		stats.maxWait = std::max(stats.maxWait, wait);
+		uint8_t bucket = 0;
+		while (bucket + 1 < ClassStats::NUM_WAIT_BUCKETS && (double)(1ull << bucket) < wait * 1e6)
+			bucket++;
+		stats.waits[bucket]++;
+	}
+
+	if (job->finished != nullptr)
+		job->finished(job, job->context);
+}
@@ -0,0 +1,157 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Solver.h"
+
+/**
+ * 8-bit enum for the priority class of a solve: interactive requests
+ * go before normal ones, which go before bulk ones.
+ */
+enum class PRIORITY : uint8_t { INTERACTIVE, NORMAL, BULK };
+const uint8_t NUM_PRIORITIES = 3;
+
+/**
+ * Name of a priority class, and the class with the given name,
+ * returning false if the name isn't recognized.
+ */
+const char* priorityToString(PRIORITY priority);
+bool parsePriority(const std::string& name, PRIORITY& priority);
+
+typedef std::chrono::steady_clock::time_point TimePoint;
+
+/**
+ * A cube to solve, with its priority class, its deadline (the latest
+ * time point for none) and whether to drop it rather than solve it
+ * fast when the deadline can't be met.
+ *
+ * Once it's finished, the solution is set, along with whether it was
+ * solved fast, dropped or cancelled, and the finished callback is
+ * called from the thread that ran it. Setting cancelled stops the
+ * solve, whether it's waiting or running.
+ */
+struct SolveJob
+{
+	Cube cube;
+	PRIORITY priority = PRIORITY::NORMAL;
+	TimePoint deadline = TimePoint::max();
+	bool dropLate = false;
+	std::atomic<bool> cancelled{ false };
+
+	Solution solution;
+	bool degraded = false;
+	bool dropped = false;
+	void (*finished)(SolveJob* job, void* context) = nullptr;
+	void* context = nullptr;
+
+	// set by the scheduler
+	TimePoint queued;
+	uint64_t sequence = 0;
+};
+
+/**
+ * Counts for one priority class: how many of its solves finished,
+ * were solved fast, were dropped, were cancelled and missed their
+ * deadline (dropped, or finished after it without being cancelled),
+ * and how long they waited in the queue.
+ */
+struct ClassStats
+{
+	static const uint8_t NUM_WAIT_BUCKETS = 32;
+
+	size_t finished = 0;
+	size_t degraded = 0;
+	size_t dropped = 0;
+	size_t cancelled = 0;
+	size_t deadlineMisses = 0;
+	double totalWait = 0;
+	double maxWait = 0;
+	// waits rounded up to a power of two microseconds
+	size_t waits[NUM_WAIT_BUCKETS] = {};
+
+	/**
+	 * Average wait, and the wait that the given fraction of solves
+	 * waited no longer than (rounded up to a power of two), in seconds.
+	 */
+	double meanWait() const { return finished > 0 ? totalWait / finished : 0; }
+	double waitPercentile(double fraction) const;
+};
+
+class Scheduler
+{
+	/**
+	 * This class solves jobs on a fixed set of threads, in priority
+	 * order: each thread takes the waiting job of the highest class, and
+	 * within a class, the one with the earliest deadline (then the one
+	 * that arrived first). A class waits as long as a higher one has
+	 * work, so bulk jobs only use threads interactive ones leave idle.
+	 *
+	 * When a thread takes a job, it checks whether a full solve would
+	 * finish by the deadline, using the average time recent solves took.
+	 * If not, the job is dropped or solved fast instead (see
+	 * SolveOptions::fast), which takes a fraction of the time.
+	 */
+
+public:
+	/**
+	 * Create a scheduler that solves with the given options on the given
+	 * number of threads (zero uses one per hardware thread).
+	 */
+	explicit Scheduler(const SolveOptions& options, size_t numThreads = 0);
+	~Scheduler();
+
+	/**
+	 * Queue the given job, which must stay alive until it's finished.
+	 */
+	void submit(SolveJob* job);
+
+	/**
+	 * Counts so far for the given class.
+	 */
+	ClassStats stats(PRIORITY priority) const;
+
+	size_t size() const { return workers.size(); }
+
+private:
+	Scheduler(const Scheduler&);
+	Scheduler& operator=(const Scheduler&);
+
+	/**
+	 * Orders a class's queue by deadline, then arrival.
+	 */
+	struct Later
+	{
+		bool operator()(const SolveJob* a, const SolveJob* b) const
+		{
+			return a->deadline != b->deadline ? a->deadline > b->deadline : a->sequence > b->sequence;
+		}
+	};
+
+	void workerLoop();
+	void run(SolveJob* job, double wait);
+
+	SolveOptions options;
+	std::vector<std::thread> workers;
+
+	mutable std::mutex mutex;
+	std::condition_variable ready;
+	std::priority_queue<SolveJob*, std::vector<SolveJob*>, Later> queues[NUM_PRIORITIES];
+	uint64_t sequence;
+	bool stopping;
+
+	// average time of recent full solves, in seconds
+	double fullTime;
+	ClassStats classStats[NUM_PRIORITIES];
+};
+
+#endif
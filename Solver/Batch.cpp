@@ -0,0 +1,342 @@
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "Batch.h"
+
+/**
+ * Solve each of the given cubes with the given options, spread across
+ * the pool's threads, writing each one's solution to the same position
+ * in the given array (which must hold count solutions).
+ *
+ * Every solution is written by exactly one thread, into a slot nobody
+ * else touches, so writing results takes no locks.
+ */
+BatchStats solveBatch(const Cube* cubes, size_t count, const SolveOptions& options, Solution* solutions, ThreadPool& pool)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	pool.parallelFor(count, [cubes, &options, solutions](size_t i) {
+		solutions[i] = solve(cubes[i], options);
+	});
+
+	BatchStats stats;
+	stats.count = count;
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stats.solvesPerSecond = stats.seconds > 0 ? count / stats.seconds : 0;
+	return stats;
+}
+
+/**
+ * Pack the given cube's state into bytes.
+ */
+void packState(const Cube& cube, uint8_t* bytes)
+{
+	uint64_t words[Cube::PACKED_WORDS];
+	cube.pack(words);
+	for (uint8_t w = 0; w < Cube::PACKED_WORDS; w++)
+		writeLittleEndian(words[w], sizeof(uint64_t), bytes + w * sizeof(uint64_t));
+}
+
+/**
+ * Unpack a cube's state from bytes, returning false if it isn't valid
+ * or can't be solved.
+ */
+bool unpackState(const uint8_t* bytes, Cube& cube)
+{
+	uint64_t words[Cube::PACKED_WORDS];
+	for (uint8_t w = 0; w < Cube::PACKED_WORDS; w++)
+		words[w] = readLittleEndian(bytes + w * sizeof(uint64_t), sizeof(uint64_t));
+	// the solver would never finish an impossible state
+	Cube unpacked;
+	if (!unpacked.unpack(words) || !unpacked.isSolvable())
+		return false;
+	cube = unpacked;
+	return true;
+}
+
+/**
+ * Solve the given packed states, writing their solutions in the batch
+ * wire format.
+ *
+ * A state that can't be unpacked is solved as a solved cube (which
+ * takes no time) and its solution replaced afterwards, so every cube
+ * still goes through the same batch.
+ */
+BatchStats solvePacked(const uint8_t* states, size_t count, const SolveOptions& options, ThreadPool* pool,
+	std::vector<uint8_t>& bytes)
+{
+	std::vector<Cube> cubes(count);
+	std::vector<bool> valid(count);
+	for (size_t i = 0; i < count; i++)
+		valid[i] = unpackState(states + i * PACKED_STATE_BYTES, cubes[i]);
+
+	std::vector<Solution> solutions(count);
+	BatchStats stats;
+	if (pool != nullptr)
+		stats = solveBatch(cubes.data(), count, options, solutions.data(), *pool);
+	else
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; i++)
+			solutions[i] = solve(cubes[i], options);
+		stats.count = count;
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stats.solvesPerSecond = stats.seconds > 0 ? count / stats.seconds : 0;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!valid[i])
+			solutions[i] = Solution();
+	}
+	packBatch(solutions.data(), count, bytes);
+	return stats;
+}
+
+/**
+ * Append the given solutions to the given bytes in the batch wire
+ * format.
+ */
+void packBatch(const Solution* solutions, size_t count, std::vector<uint8_t>& bytes)
+{
+	bytes.insert(bytes.end(), BATCH_MAGIC, BATCH_MAGIC + sizeof(BATCH_MAGIC));
+	uint8_t header[MAX_VARINT_BYTES];
+	bytes.insert(bytes.end(), header, header + writeVarint(count, header));
+	for (size_t i = 0; i < count; i++)
+		packSolution(solutions[i], bytes);
+}
+
+/**
+ * Read solutions in the batch wire format from the given bytes,
+ * returning false if they aren't a valid batch.
+ */
+bool unpackBatch(const uint8_t* bytes, size_t size, std::vector<Solution>& solutions)
+{
+	solutions.clear();
+	if (size < sizeof(BATCH_MAGIC) || memcmp(bytes, BATCH_MAGIC, sizeof(BATCH_MAGIC)) != 0)
+		return false;
+
+	size_t offset = sizeof(BATCH_MAGIC);
+	uint64_t count;
+	size_t read = readVarint(bytes + offset, size - offset, count);
+	// every solution takes at least a byte
+	if (read == 0 || count > size - offset - read)
+		return false;
+	offset += read;
+
+	solutions.resize((size_t)count);
+	for (Solution& solution : solutions)
+	{
+		read = unpackSolution(bytes + offset, size - offset, solution);
+		if (read == 0)
+			return false;
+		offset += read;
+	}
+	return offset == size;
+}
+
+/**
+ * Read a batch format from its name, returning false if the name isn't
+ * recognized.
+ */
+bool parseBatchFormat(const std::string& name, BATCH_FORMAT& format)
+{
+	if (name == "text")
+		format = BATCH_FORMAT::TEXT;
+	else if (name == "json")
+		format = BATCH_FORMAT::JSON;
+	else if (name == "binary")
+		format = BATCH_FORMAT::BINARY;
+	else
+		return false;
+	return true;
+}
+
+/**
+ * Read a cube from one line of batch input.
+ *
+ * A line of exactly 54 color letters is a state, and anything else is a
+ * scramble, which is checked move by move before it's performed, since
+ * readMoves skips anything it doesn't recognize. States are checked to
+ * be solvable, as the solver would never finish an impossible one.
+ */
+const char* parseCube(const char* line, Cube& cube)
+{
+	static const char colors[] = "WYROBG";
+	static const char letters[] = "UDFBRLfbudrlMESxyzXYZ";
+
+	size_t length = strlen(line);
+	if (length == 54 && strspn(line, colors) == 54)
+	{
+		std::string state(line, length);
+		cube.copyState(state);
+		return cube.isSolvable() ? nullptr : "state can't be solved";
+	}
+
+	for (const char* c = line; *c != '\0'; c++)
+	{
+		if (*c == ' ' || *c == '\t')
+			continue;
+		if (strchr(letters, *c) == nullptr)
+			return "unknown move";
+		if (c[1] == '2' || c[1] == '\'')
+			c++;
+		// R2' is the same as R2
+		if (c[0] == '2' && c[1] == '\'')
+			c++;
+		if (c[1] != '\0' && c[1] != ' ' && c[1] != '\t')
+			return "unknown move";
+	}
+	cube.reset();
+	MoveBuffer moves;
+	cube.readMoves(line, moves);
+	return nullptr;
+}
+
+/**
+ * Read the next line, refilling the buffer from the file whenever it
+ * runs out partway through a line.
+ */
+bool LineReader::next(std::string& line)
+{
+	line.clear();
+	while (true)
+	{
+		char* start = buffer.data() + begin;
+		char* newline = (char*)memchr(start, '\n', end - begin);
+		if (newline != nullptr)
+		{
+			line.append(start, newline);
+			begin = newline - buffer.data() + 1;
+			break;
+		}
+		line.append(start, end - begin);
+		position += end;
+		begin = end = 0;
+		if (done || (end = fread(buffer.data(), 1, buffer.size(), file)) == 0)
+		{
+			done = true;
+			if (line.empty())
+				return false;
+			break;
+		}
+	}
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+	return true;
+}
+
+/**
+ * Write the text or JSON result for the cube on the given line.
+ */
+void formatResult(size_t number, const Solution& solution, const char* error, BATCH_FORMAT format, std::string& result)
+{
+	if (error == nullptr && !solution.solved)
+		error = "some moves can't be made from the allowed moves";
+
+	result.clear();
+	if (format == BATCH_FORMAT::JSON)
+		result += "{\"line\":" + std::to_string(number);
+	if (error != nullptr)
+	{
+		result += format == BATCH_FORMAT::JSON ? ",\"error\":\"" : "error: ";
+		result += error;
+		result += format == BATCH_FORMAT::JSON ? "\"}\n" : "\n";
+		return;
+	}
+
+	if (format == BATCH_FORMAT::JSON)
+		result += ",\"moves\":" + std::to_string(solution.size()) + ",\"solution\":\"";
+	size_t start = result.size();
+	result.resize(start + solution.size() * (MOVE_CHARS + 1) + 1);
+	size_t length = solutionToString(solution, &result[start], result.size() - start);
+	// drop the space after the last move
+	result.resize(start + (length > 0 ? length - 1 : 0));
+	if (format == BATCH_FORMAT::JSON)
+	{
+		result += "\",\"oll\":\"" + caseToString(PHASE::OLL, solution.oll) + "\",\"pll\":\"" +
+			caseToString(PHASE::PLL, solution.pll) + "\"}";
+	}
+	result += '\n';
+}
+
+/**
+ * Read and solve one line of batch input, writing its result to the
+ * given string.
+ */
+void solveLine(const std::string& line, size_t number, const SolveOptions& options, BATCH_FORMAT format,
+	std::string& result)
+{
+	Cube cube;
+	const char* error = parseCube(line.c_str(), cube);
+	Solution solution;
+	if (error == nullptr)
+		solution = solve(cube, options);
+	formatResult(number, solution, error, format, result);
+}
+
+/**
+ * Solve each line of the given input, writing one result per line.
+ *
+ * Lines are read a chunk at a time, solved across the pool into a
+ * result string each (reused from chunk to chunk), then written in
+ * order with a single write per chunk.
+ */
+BatchStats solveStream(FILE* input, FILE* output, const SolveOptions& options, BATCH_FORMAT format, ThreadPool& pool,
+	Checkpointer* checkpointer)
+{
+	const size_t CHUNK_LINES = 4096;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Checkpoint checkpoint;
+	if (checkpointer != nullptr)
+		checkpoint = checkpointer->start();
+	// an input that ends before the checkpoint has nothing left to solve
+	skipInput(input, checkpoint.inputOffset);
+	LineReader reader(input, checkpoint.inputOffset);
+	std::vector<std::string> lines(CHUNK_LINES);
+	std::vector<size_t> numbers(CHUNK_LINES);
+	std::vector<std::string> results(CHUNK_LINES);
+	std::string written;
+	size_t lineNumber = (size_t)checkpoint.lineNumber;
+	size_t count = 0;
+	bool more = true;
+	while (more)
+	{
+		size_t numLines = 0;
+		while (numLines < CHUNK_LINES && (more = reader.next(lines[numLines])))
+		{
+			lineNumber++;
+			if (lines[numLines].find_first_not_of(" \t") == std::string::npos)
+				continue;
+			numbers[numLines++] = lineNumber;
+		}
+
+		pool.parallelFor(numLines, [&](size_t i) {
+			solveLine(lines[i], numbers[i], options, format, results[i]);
+		});
+
+		written.clear();
+		for (size_t i = 0; i < numLines; i++)
+			written += results[i];
+		fwrite(written.data(), 1, written.size(), output);
+		count += numLines;
+
+		if (checkpointer != nullptr)
+		{
+			checkpoint.inputOffset = reader.offset();
+			checkpoint.lineNumber = lineNumber;
+			checkpoint.count += numLines;
+			if (!more || checkpointer->due())
+				checkpointer->save(output, checkpoint);
+		}
+	}
+	fflush(output);
+
+	BatchStats stats;
+	stats.count = count;
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stats.solvesPerSecond = stats.seconds > 0 ? count / stats.seconds : 0;
+	return stats;
+}
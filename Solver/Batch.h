@@ -0,0 +1,157 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+
+/**
+ * How long a batch took to solve, and how many cubes it solved
+ * per second.
+ */
+struct BatchStats
+{
+	size_t count;
+	double seconds;
+	double solvesPerSecond;
+};
+
+/**
+ * Solve each of the given cubes with the given options, spread across
+ * the pool's threads, writing each one's solution to the same position
+ * in the given array (which must hold count solutions).
+ */
+BatchStats solveBatch(const Cube* cubes, size_t count, const SolveOptions& options, Solution* solutions, ThreadPool& pool);
+
+/**
+ * Bytes of a cube's state packed into bytes: the words of Cube::pack,
+ * each little endian.
+ */
+const size_t PACKED_STATE_BYTES = Cube::PACKED_WORDS * sizeof(uint64_t);
+
+/**
+ * Pack the given cube's state into the given bytes (PACKED_STATE_BYTES
+ * of them), and unpack one, returning false (and leaving the cube as it
+ * was) if it isn't a valid state or can't be solved.
+ */
+void packState(const Cube& cube, uint8_t* bytes);
+bool unpackState(const uint8_t* bytes, Cube& cube);
+
+/**
+ * The wire format for batch output: BATCH_MAGIC, a varint of the number
+ * of solutions, then each solution packed (see packSolution).
+ */
+const char BATCH_MAGIC[4] = { 'C', 'S', 'P', '1' };
+
+/**
+ * Append the given solutions to the given bytes in the batch wire
+ * format, and read them back, returning false if the bytes aren't
+ * a valid batch.
+ */
+void packBatch(const Solution* solutions, size_t count, std::vector<uint8_t>& bytes);
+bool unpackBatch(const uint8_t* bytes, size_t size, std::vector<Solution>& solutions);
+
+/**
+ * Solve the given number of cubes packed one after another in the given
+ * states (see packState) with the given options, spread across the
+ * pool's threads, or on the calling thread if the pool is null, and
+ * append their solutions to the given bytes in the batch wire format. A
+ * state that can't be unpacked gets an unsolved solution.
+ *
+ * Nothing is turned into text on the way in or out, so this is the
+ * cheapest way to solve many cubes from across a language boundary (see
+ * Web.cpp).
+ */
+BatchStats solvePacked(const uint8_t* states, size_t count, const SolveOptions& options, ThreadPool* pool,
+	std::vector<uint8_t>& bytes);
+
+/**
+ * 8-bit enum for the format of streamed batch output: one line of moves
+ * per cube, one JSON object per line (JSON Lines), or the batch wire
+ * format above.
+ */
+enum class BATCH_FORMAT : uint8_t { TEXT, JSON, BINARY };
+
+/**
+ * Read a batch format from its name ("text", "json" or "binary"),
+ * returning false if the name isn't recognized.
+ */
+bool parseBatchFormat(const std::string& name, BATCH_FORMAT& format);
+
+/**
+ * Read a cube from one line of batch input, which holds either a
+ * scramble or a 54 character state (see Cube::copyState), returning an
+ * error message if it's neither or can't be solved, or null otherwise.
+ * The line must end with a null character.
+ */
+const char* parseCube(const char* line, Cube& cube);
+
+/**
+ * Write the text or JSON result for the cube on the given line to the
+ * given string: its solution, or the given error if it isn't null.
+ */
+void formatResult(size_t number, const Solution& solution, const char* error, BATCH_FORMAT format, std::string& result);
+
+class LineReader
+{
+	/**
+	 * This class reads lines from a file a large block at a time.
+	 */
+
+public:
+	/**
+	 * Read from the given file, whose first byte is the given offset
+	 * into the input (if it's been skipped ahead).
+	 */
+	explicit LineReader(FILE* file, uint64_t start = 0) :
+		file(file), buffer(1 << 20), begin(0), end(0), position(start), done(false) {}
+
+	/**
+	 * Read the next line into the given string, without its line ending,
+	 * returning false at the end of the file.
+	 */
+	bool next(std::string& line);
+
+	/**
+	 * Offset into the input of the byte after the last line read.
+	 */
+	uint64_t offset() const { return position + begin; }
+
+private:
+	LineReader(const LineReader&);
+	LineReader& operator=(const LineReader&);
+
+	FILE* file;
+	std::vector<char> buffer;
+	size_t begin;
+	size_t end;
+	// offset into the input of the start of the buffer
+	uint64_t position;
+	bool done;
+};
+
+/**
+ * Solve each line of the given input with the given options, spread
+ * across the pool's threads, writing one result per line to the given
+ * output in the same order. Blank lines are skipped.
+ *
+ * A text result is the solution's moves, and a JSON result holds the
+ * line number, the number of moves, the moves and the last layer
+ * cases. A line that can't be read gives an error instead. The binary
+ * format needs the number of cubes up front, so it isn't supported.
+ *
+ * With a checkpointer, the input is skipped to its start, the output
+ * must already be opened from it (see openCheckpointedOutput), and a
+ * checkpoint is saved between chunks as often as it allows, and once
+ * more at the end.
+ */
+BatchStats solveStream(FILE* input, FILE* output, const SolveOptions& options, BATCH_FORMAT format, ThreadPool& pool,
+	Checkpointer* checkpointer = nullptr);
+
+#endif
@@ -0,0 +1,170 @@
+#include "Cache.h"
+#include "Symmetry.h"
+
+/**
+ * Create a cache of solutions found with the given options, splitting
+ * its capacity evenly between its shards.
+ */
+SolutionCache::SolutionCache(const SolveOptions& options, size_t capacity, bool symmetric, size_t numShards)
+	: solveOptions(options), symmetric(symmetric && options.restriction.isDefault() && !options.minimizeTime),
+	numShards(numShards > 0 ? numShards : 1), hits(0), misses(0), symmetricHits(0), evictions(0)
+{
+	shardCapacity = (capacity + this->numShards - 1) / this->numShards;
+	if (shardCapacity == 0)
+		shardCapacity = 1;
+	shards.reset(new Shard[this->numShards]);
+}
+
+/**
+ * Replace the given cube with its key, returning the symmetry that was
+ * applied to it.
+ */
+uint8_t SolutionCache::canonicalKey(Cube& cube) const
+{
+	return canonicalize(cube, symmetric, symmetric);
+}
+
+/**
+ * Find the shard holding the given hash, using its high bits, since the
+ * low bits pick the bucket within the shard.
+ */
+SolutionCache::Shard& SolutionCache::shardFor(uint64_t hash)
+{
+	return shards[(size_t)(hash >> 32) % numShards];
+}
+
+/**
+ * Find the solution cached for the given key, moving it to the front of
+ * its shard's list. A different cube with the same hash is a miss.
+ */
+bool SolutionCache::lookup(const Cube& key, uint64_t hash, Solution& solution)
+{
+	Shard& shard = shardFor(hash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto found = shard.index.find(hash);
+	if (found == shard.index.end() || !(found->second->key == key))
+		return false;
+	shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+	solution = found->second->solution;
+	return true;
+}
+
+/**
+ * Cache the given solution for the given key, replacing any entry with
+ * the same hash, and dropping the least recently used entry if the shard
+ * is full.
+ */
+void SolutionCache::store(const Cube& key, uint64_t hash, const Solution& solution)
+{
+	Shard& shard = shardFor(hash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto found = shard.index.find(hash);
+	if (found != shard.index.end())
+	{
+		found->second->key = key;
+		found->second->solution = solution;
+		shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+		return;
+	}
+	if (shard.entries.size() >= shardCapacity)
+	{
+		shard.index.erase(shard.entries.back().key.hash());
+		shard.entries.pop_back();
+		evictions++;
+	}
+	shard.entries.push_front({ key, solution });
+	shard.index[hash] = shard.entries.begin();
+}
+
+/**
+ * Solve the given cube, using the cached solution if there is one.
+ *
+ * On a miss, the canonical cube is solved rather than the one given, so
+ * the solution can be cached as it is, then conjugated like a hit. Two
+ * threads missing on the same cube both solve it.
+ */
+Solution SolutionCache::solve(const Cube& cube)
+{
+	Solution solution;
+	if (find(cube, solution))
+		return solution;
+
+	Cube key = cube;
+	uint8_t symmetry = canonicalKey(key);
+	solution = ::solve(key, solveOptions);
+	store(key, key.hash(), solution);
+	if (symmetry != 0)
+		conjugateSolution(solution, symmetry);
+	return solution;
+}
+
+/**
+ * Find the cached solution for the given cube, conjugated back to it,
+ * returning false if there isn't one.
+ */
+bool SolutionCache::find(const Cube& cube, Solution& solution)
+{
+	Cube key = cube;
+	uint8_t symmetry = canonicalKey(key);
+	if (!lookup(key, key.hash(), solution))
+	{
+		misses++;
+		return false;
+	}
+	hits++;
+	if (symmetry != 0)
+	{
+		symmetricHits++;
+		conjugateSolution(solution, symmetry);
+	}
+	return true;
+}
+
+/**
+ * Cache the given solution for the given cube, as the solution for its
+ * canonical form.
+ */
+void SolutionCache::insert(const Cube& cube, const Solution& solution)
+{
+	Cube key = cube;
+	uint8_t symmetry = canonicalKey(key);
+	if (symmetry == 0)
+	{
+		store(key, key.hash(), solution);
+		return;
+	}
+	Solution canonical = solution;
+	conjugateSolution(canonical, symmetry, true);
+	store(key, key.hash(), canonical);
+}
+
+/**
+ * What the cache has done so far, counting the entries in each shard.
+ */
+CacheStats SolutionCache::stats() const
+{
+	CacheStats stats = { hits, misses, symmetricHits, evictions, 0 };
+	for (size_t i = 0; i < numShards; i++)
+	{
+		std::lock_guard<std::mutex> lock(shards[i].mutex);
+		stats.size += shards[i].entries.size();
+	}
+	return stats;
+}
+
+/**
+ * Drop every entry and reset the counts.
+ */
+void SolutionCache::clear()
+{
+	for (size_t i = 0; i < numShards; i++)
+	{
+		std::lock_guard<std::mutex> lock(shards[i].mutex);
+		shards[i].entries.clear();
+		shards[i].index.clear();
+	}
+	hits = 0;
+	misses = 0;
+	symmetricHits = 0;
+	evictions = 0;
+}
@@ -0,0 +1,112 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "Solver.h"
+
+/**
+ * Counts of what a cache has done since it was created or cleared.
+ *
+ * Symmetric hits are the hits whose cached solution had to be turned
+ * or reflected to fit the cube that was asked for.
+ */
+struct CacheStats
+{
+	size_t hits;
+	size_t misses;
+	size_t symmetricHits;
+	size_t evictions;
+	size_t size;
+
+	double hitRate() const { return hits + misses > 0 ? (double)hits / (hits + misses) : 0; }
+};
+
+class SolutionCache
+{
+	/**
+	 * This class keeps the most recently used solutions, in front of solve.
+	 *
+	 * Cubes are keyed by their canonical form (see canonicalize), so the
+	 * same state in a different color scheme shares a solution, and so
+	 * do all its symmetries if the cache is symmetric. A solution is
+	 * cached for the canonical cube, and conjugated back to the cube
+	 * that was asked for on every hit.
+	 *
+	 * Entries are split between shards by their hash, each with its own
+	 * lock and least recently used list, so threads rarely wait on each
+	 * other. A shard drops its least recently used entry once it's full.
+	 */
+
+public:
+	/**
+	 * Create a cache of solutions found with the given options, holding
+	 * up to the given number of them.
+	 *
+	 * Symmetry only applies if the options don't restrict the moves, as
+	 * turning the cube would turn the allowed moves too.
+	 */
+	SolutionCache(const SolveOptions& options, size_t capacity, bool symmetric = false, size_t numShards = 16);
+
+	/**
+	 * Solve the given cube, using the cached solution if there is one.
+	 * Safe to call from many threads at once.
+	 */
+	Solution solve(const Cube& cube);
+
+	/**
+	 * Find the cached solution for the given cube, returning false if
+	 * there isn't one, and cache a solution for it.
+	 */
+	bool find(const Cube& cube, Solution& solution);
+	void insert(const Cube& cube, const Solution& solution);
+
+	/**
+	 * What the cache has done so far, and drop every entry and count.
+	 */
+	CacheStats stats() const;
+	void clear();
+
+	const SolveOptions& options() const { return solveOptions; }
+
+private:
+	SolutionCache(const SolutionCache&);
+	SolutionCache& operator=(const SolutionCache&);
+
+	struct Entry
+	{
+		Cube key;
+		Solution solution;
+	};
+
+	struct Shard
+	{
+		std::mutex mutex;
+		std::list<Entry> entries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+	};
+
+	uint8_t canonicalKey(Cube& cube) const;
+	Shard& shardFor(uint64_t hash);
+	bool lookup(const Cube& key, uint64_t hash, Solution& solution);
+	void store(const Cube& key, uint64_t hash, const Solution& solution);
+
+	SolveOptions solveOptions;
+	bool symmetric;
+	size_t shardCapacity;
+	size_t numShards;
+	std::unique_ptr<Shard[]> shards;
+
+	std::atomic<size_t> hits;
+	std::atomic<size_t> misses;
+	std::atomic<size_t> symmetricHits;
+	std::atomic<size_t> evictions;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+#include "Checkpoint.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+/**
+ * Seek to the given offset of a file, and read its current offset, past
+ * the 2 GB that fseek and ftell can reach.
+ */
+bool seekFile(FILE* file, uint64_t offset, int origin)
+{
+#ifndef _WIN32
+	return fseeko(file, (off_t)offset, origin) == 0;
+#else
+	return _fseeki64(file, (__int64)offset, origin) == 0;
+#endif
+}
+
+uint64_t tellFile(FILE* file)
+{
+#ifndef _WIN32
+	return (uint64_t)ftello(file);
+#else
+	return (uint64_t)_ftelli64(file);
+#endif
+}
+
+/**
+ * Flush the given file all the way to disk. Pipes and terminals can't
+ * be synced, which isn't an error.
+ */
+bool syncFile(FILE* file)
+{
+	if (fflush(file) != 0)
+		return false;
+#ifndef _WIN32
+	return fsync(fileno(file)) == 0 || errno == EINVAL || errno == ENOTSUP;
+#else
+	return _commit(_fileno(file)) == 0;
+#endif
+}
+
+/**
+ * Read the size and modification time of the given input file.
+ */
+bool CheckpointJob::readInput(const std::string& path)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+		return false;
+	inputSize = (uint64_t)info.st_size;
+	inputModified = (int64_t)info.st_mtime;
+	return true;
+}
+
+bool CheckpointJob::operator==(const CheckpointJob& other) const
+{
+	return settings == other.settings && inputSize == other.inputSize && inputModified == other.inputModified;
+}
+
+/**
+ * Use the checkpoint file at the given path for the given job, reading
+ * the checkpoint saved there if there is one. A file that can't be read
+ * (including one saved before checkpoints recorded their job) or that
+ * another job saved is a mismatch.
+ */
+Checkpointer::Checkpointer(const std::string& path, const CheckpointJob& job, double interval) :
+	path(path), job(job), interval(interval), found(false), conflict(false), failed(false),
+	lastSave(std::chrono::steady_clock::now())
+{
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		return;
+	unsigned long long input, line, output, count, settings, size;
+	long long modified;
+	bool read = fscanf(file, "checkpoint 2 input %llu line %llu output %llu count %llu settings %llx size %llu modified %lld",
+		&input, &line, &output, &count, &settings, &size, &modified) == 7;
+	fclose(file);
+
+	CheckpointJob saved;
+	saved.settings = settings;
+	saved.inputSize = size;
+	saved.inputModified = modified;
+	if (!read || saved != job)
+	{
+		conflict = true;
+		return;
+	}
+	found = true;
+	resumed.inputOffset = input;
+	resumed.lineNumber = line;
+	resumed.outputOffset = output;
+	resumed.count = count;
+}
+
+/**
+ * Flush the given output and save the given checkpoint.
+ *
+ * The checkpoint goes to a temporary file that's synced before it's
+ * renamed over the old one, so a crash at any point leaves either the
+ * old checkpoint or the new one, and never one ahead of the output.
+ */
+bool Checkpointer::save(FILE* output, Checkpoint checkpoint)
+{
+	lastSave = std::chrono::steady_clock::now();
+	bool saved = syncFile(output);
+	checkpoint.outputOffset = tellFile(output);
+
+	std::string temporary = path + ".tmp";
+	FILE* file = saved ? fopen(temporary.c_str(), "w") : nullptr;
+	if (file != nullptr)
+	{
+		fprintf(file, "checkpoint 2\ninput %llu\nline %llu\noutput %llu\ncount %llu\nsettings %llx\nsize %llu\nmodified %lld\n",
+			(unsigned long long)checkpoint.inputOffset, (unsigned long long)checkpoint.lineNumber,
+			(unsigned long long)checkpoint.outputOffset, (unsigned long long)checkpoint.count,
+			(unsigned long long)job.settings, (unsigned long long)job.inputSize, (long long)job.inputModified);
+		saved = syncFile(file);
+		saved = fclose(file) == 0 && saved;
+#ifdef _WIN32
+		// rename won't replace a file on Windows
+		remove(path.c_str());
+#endif
+		saved = saved && rename(temporary.c_str(), path.c_str()) == 0;
+	}
+	else
+		saved = false;
+	failed = failed || !saved;
+	return saved;
+}
+
+/**
+ * Whether the interval has passed since the last checkpoint.
+ */
+bool Checkpointer::due() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - lastSave).count() >= interval;
+}
+
+/**
+ * Open the output of a batch job that uses the given checkpointer,
+ * dropping anything written after its checkpoint.
+ */
+FILE* openCheckpointedOutput(const std::string& path, const Checkpointer& checkpointer)
+{
+	if (!checkpointer.hasStart())
+		return fopen(path.c_str(), "wb");
+
+	FILE* file = fopen(path.c_str(), "r+b");
+	if (file == nullptr)
+		return nullptr;
+	uint64_t offset = checkpointer.start().outputOffset;
+	bool truncated = seekFile(file, 0, SEEK_END) && tellFile(file) >= offset;
+	fflush(file);
+#ifndef _WIN32
+	truncated = truncated && ftruncate(fileno(file), (off_t)offset) == 0;
+#else
+	truncated = truncated && _chsize_s(_fileno(file), (__int64)offset) == 0;
+#endif
+	if (!truncated || !seekFile(file, offset, SEEK_SET))
+	{
+		fclose(file);
+		return nullptr;
+	}
+	return file;
+}
+
+/**
+ * Skip the given number of bytes of the given input. Pipes can't seek,
+ * so the bytes are read and thrown away instead.
+ */
+bool skipInput(FILE* input, uint64_t bytes)
+{
+	if (bytes == 0 || seekFile(input, bytes, SEEK_CUR))
+		return true;
+	std::vector<char> buffer(1 << 16);
+	while (bytes > 0)
+	{
+		size_t read = fread(buffer.data(), 1, (size_t)std::min<uint64_t>(bytes, buffer.size()), input);
+		if (read == 0)
+			return false;
+		bytes -= read;
+	}
+	return true;
+}
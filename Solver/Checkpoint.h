@@ -0,0 +1,143 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+/**
+ * How far a batch job had got: where to carry on reading its input (a
+ * byte offset for text, or a cube index for a corpus), the number of
+ * the last line read, how many bytes of output it had written for
+ * everything before that, and how many cubes it had solved.
+ */
+struct Checkpoint
+{
+	uint64_t inputOffset = 0;
+	uint64_t lineNumber = 0;
+	uint64_t outputOffset = 0;
+	uint64_t count = 0;
+};
+
+/**
+ * What a batch job's checkpoints belong to: a hash of the settings that
+ * decide its output (its solve options and output format), and the size
+ * and modification time of its input file. A job only resumes from a
+ * checkpoint saved by the same job.
+ */
+struct CheckpointJob
+{
+	uint64_t settings = 0;
+	uint64_t inputSize = 0;
+	int64_t inputModified = 0;
+
+	/**
+	 * Read the size and modification time of the input file at the given
+	 * path, returning false if it can't be read.
+	 */
+	bool readInput(const std::string& path);
+
+	bool operator==(const CheckpointJob& other) const;
+	bool operator!=(const CheckpointJob& other) const { return !(*this == other); }
+};
+
+class Checkpointer
+{
+	/**
+	 * This class saves a batch job's checkpoints to a file, so the job
+	 * can carry on from the last one if it's stopped.
+	 *
+	 * The output is flushed to disk before each checkpoint is saved, and
+	 * a checkpoint is written to a temporary file that then replaces the
+	 * old one, so the file always holds a whole checkpoint whose output
+	 * is all on disk. Resuming truncates the output to the checkpoint's
+	 * offset, dropping anything written after it, which is then written
+	 * again, so every result ends up in the output exactly once.
+	 *
+	 * Saving takes a couple of disk syncs, so checkpoints are only saved
+	 * once the given interval has passed since the last one.
+	 *
+	 * Each checkpoint records the job it was saved by, so a job with
+	 * other options, another format or a changed input never resumes
+	 * from it and mixes two jobs' results in one output.
+	 */
+
+public:
+	/**
+	 * Use the checkpoint file at the given path for the given job,
+	 * reading the checkpoint saved there if there is one.
+	 */
+	Checkpointer(const std::string& path, const CheckpointJob& job, double interval = 1.0);
+
+	/**
+	 * The checkpoint the job starts from, which is all zeros if there
+	 * wasn't one.
+	 */
+	const Checkpoint& start() const { return resumed; }
+	bool hasStart() const { return found; }
+
+	/**
+	 * Whether the file held a checkpoint this job can't resume from,
+	 * because another job saved it or it can't be read. The job should
+	 * stop rather than start over and overwrite that job's output.
+	 */
+	bool mismatched() const { return conflict; }
+
+	/**
+	 * Whether the interval has passed since the last checkpoint, so it's
+	 * time to save another.
+	 */
+	bool due() const;
+
+	/**
+	 * Flush the given output and save the given checkpoint (with the
+	 * output's position), returning false if either can't be written.
+	 */
+	bool save(FILE* output, Checkpoint checkpoint);
+
+	/**
+	 * Whether every checkpoint so far has been saved.
+	 */
+	bool good() const { return !failed; }
+
+private:
+	std::string path;
+	CheckpointJob job;
+	double interval;
+	Checkpoint resumed;
+	bool found;
+	bool conflict;
+	bool failed;
+	std::chrono::steady_clock::time_point lastSave;
+};
+
+/**
+ * Open the output of a batch job that uses the given checkpointer:
+ * truncated to its start's offset if it's resuming, or empty otherwise.
+ * Return null if it can't be opened, or is shorter than the checkpoint
+ * says it should be.
+ */
+FILE* openCheckpointedOutput(const std::string& path, const Checkpointer& checkpointer);
+
+/**
+ * Skip the given number of bytes of the given input, seeking if it's a
+ * file and reading them otherwise, returning false if it runs out.
+ */
+bool skipInput(FILE* input, uint64_t bytes);
+
+/**
+ * Seek to the given offset of a file (from the given origin, as fseek
+ * takes), and read its current offset, past the 2 GB that fseek and
+ * ftell can reach.
+ */
+bool seekFile(FILE* file, uint64_t offset, int origin);
+uint64_t tellFile(FILE* file);
+
+/**
+ * Flush the given file all the way to disk, returning false if it can't
+ * be (a pipe or terminal, which can't be synced, counts as flushed).
+ */
+bool syncFile(FILE* file);
+
+#endif
@@ -0,0 +1,85 @@
+#include <string.h>
+
+#include "Corpus.h"
+#include "PackedMoves.h"
+
+/**
+ * Map the corpus at the given path, checking that its header matches
+ * its size.
+ */
+bool Corpus::open(const std::string& path)
+{
+	count = 0;
+	if (!file.open(path))
+		return false;
+	const uint8_t* bytes = file.data();
+	if (file.size() < CORPUS_HEADER_SIZE || memcmp(bytes, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0 ||
+		readLittleEndian(bytes + 4, 4) != CORPUS_RECORD_SIZE ||
+		readLittleEndian(bytes + 8, 8) > (file.size() - CORPUS_HEADER_SIZE) / CORPUS_RECORD_SIZE)
+	{
+		file.close();
+		return false;
+	}
+	count = (size_t)readLittleEndian(bytes + 8, 8);
+	return true;
+}
+
+/**
+ * Read the cube with the given index.
+ */
+bool Corpus::cube(size_t index, Cube& cube) const
+{
+	if (index >= count)
+		return false;
+	const uint8_t* record = file.data() + CORPUS_HEADER_SIZE + index * CORPUS_RECORD_SIZE;
+	uint64_t words[Cube::PACKED_WORDS];
+	for (uint8_t w = 0; w < Cube::PACKED_WORDS; w++)
+		words[w] = readLittleEndian(record + w * sizeof(uint64_t), sizeof(uint64_t));
+	return cube.unpack(words);
+}
+
+/**
+ * Create the corpus at the given path, leaving its number of cubes at
+ * 0 until it's closed.
+ */
+bool CorpusWriter::open(const std::string& path)
+{
+	close();
+	file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+	count = 0;
+	uint8_t header[CORPUS_HEADER_SIZE] = {};
+	memcpy(header, CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+	writeLittleEndian(CORPUS_RECORD_SIZE, 4, header + 4);
+	return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+/**
+ * Add the given cube to the end of the corpus.
+ */
+void CorpusWriter::add(const Cube& cube)
+{
+	uint64_t words[Cube::PACKED_WORDS];
+	cube.pack(words);
+	uint8_t record[CORPUS_RECORD_SIZE];
+	for (uint8_t w = 0; w < Cube::PACKED_WORDS; w++)
+		writeLittleEndian(words[w], sizeof(uint64_t), record + w * sizeof(uint64_t));
+	fwrite(record, 1, sizeof(record), file);
+	count++;
+}
+
+/**
+ * Fill in the number of cubes and close the file.
+ */
+bool CorpusWriter::close()
+{
+	if (file == nullptr)
+		return true;
+	uint8_t size[8];
+	writeLittleEndian(count, sizeof(size), size);
+	bool written = !ferror(file) && fseek(file, 8, SEEK_SET) == 0 && fwrite(size, 1, sizeof(size), file) == sizeof(size);
+	written = fclose(file) == 0 && written;
+	file = nullptr;
+	return written;
+}
@@ -0,0 +1,91 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "Cube.h"
+#include "MappedFile.h"
+
+/**
+ * A corpus file holds cubes to solve in a batch: CORPUS_MAGIC, the size
+ * of each record (4 bytes) and the number of records (8 bytes), followed
+ * by each cube packed into 3 words (see Cube::pack), all little endian.
+ *
+ * Every record is the same size, so the index is implicit: cube i
+ * starts CORPUS_HEADER_SIZE + i * CORPUS_RECORD_SIZE bytes in.
+ */
+const char CORPUS_MAGIC[4] = { 'C', 'S', 'C', '1' };
+const size_t CORPUS_HEADER_SIZE = 16;
+const size_t CORPUS_RECORD_SIZE = Cube::PACKED_WORDS * sizeof(uint64_t);
+
+class Corpus
+{
+	/**
+	 * This class reads a corpus file, mapped into memory.
+	 */
+
+public:
+	/**
+	 * Map the corpus at the given path, returning false if it can't be
+	 * opened or isn't a corpus.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * Number of cubes in the corpus.
+	 */
+	size_t size() const { return count; }
+
+	/**
+	 * Read the cube with the given index, returning false if its record
+	 * isn't a valid cube.
+	 */
+	bool cube(size_t index, Cube& cube) const;
+
+private:
+	MappedFile file;
+	size_t count = 0;
+};
+
+class CorpusWriter
+{
+	/**
+	 * This class writes a corpus file a cube at a time, filling in the
+	 * number of cubes once it's closed.
+	 */
+
+public:
+	CorpusWriter() : file(nullptr), count(0) {}
+	~CorpusWriter() { close(); }
+
+	/**
+	 * Create the corpus at the given path, returning false if it can't
+	 * be created.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * Add the given cube to the end of the corpus.
+	 */
+	void add(const Cube& cube);
+
+	/**
+	 * Finish writing the corpus, returning false if it couldn't be
+	 * written.
+	 */
+	bool close();
+
+	size_t size() const { return count; }
+
+private:
+	CorpusWriter(const CorpusWriter&);
+	CorpusWriter& operator=(const CorpusWriter&);
+
+	FILE* file;
+	size_t count;
+};
+
+#endif
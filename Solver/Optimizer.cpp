@@ -0,0 +1,572 @@
+#include "Arena.h"
+#include "Optimizer.h"
+
+typedef Move::PIECES PIECES;
+typedef Move::TYPE TYPE;
+
+/**
+ * Every move turns one or more of the three layers stacked along
+ * one of the cube's three axes:
+ *
+ * Axis 0 runs through U and D (the y axis),
+ * axis 1 runs through F and B (the z axis),
+ * axis 2 runs through R and L (the x axis).
+ *
+ * Layer 0 is the negative face (D, B, L), layer 1 is the slice and
+ * layer 2 is the positive face (U, F, R). Turn amounts are stored as
+ * clockwise quarter turns looking at the positive face, mod 4.
+ *
+ * All moves along the same axis commute, so any run of them can be
+ * summed into one set of layer amounts and re-emitted in its shortest
+ * form.
+ */
+const uint8_t NUM_AXES = 3;
+
+/**
+ * Axis of each outer face, indexed by Move::PIECES.
+ */
+const uint8_t faceAxis[6] = { 0, 0, 1, 1, 2, 2 };
+
+/**
+ * Whether each outer face is the positive face of its axis.
+ */
+const bool facePositive[6] = { true, false, true, false, true, false };
+
+/**
+ * Positive face, negative face, slice and rotation of each axis.
+ */
+const PIECES axisPositiveFace[NUM_AXES] = { PIECES::UP, PIECES::FRONT, PIECES::RIGHT };
+const PIECES axisNegativeFace[NUM_AXES] = { PIECES::DOWN, PIECES::BACK, PIECES::LEFT };
+const PIECES axisSlice[NUM_AXES] = { PIECES::E_SLICE, PIECES::S_SLICE, PIECES::M_SLICE };
+const PIECES axisRotation[NUM_AXES] = { PIECES::Y, PIECES::Z, PIECES::X };
+
+/**
+ * Wide turns of the positive and negative face of each axis.
+ */
+const PIECES axisPositiveWide[NUM_AXES] = { PIECES::UP_WIDE, PIECES::FRONT_WIDE, PIECES::RIGHT_WIDE };
+const PIECES axisNegativeWide[NUM_AXES] = { PIECES::DOWN_WIDE, PIECES::BACK_WIDE, PIECES::LEFT_WIDE };
+
+/**
+ * Whether each axis's slice turns the same direction as its positive
+ * face. E follows D and M follows L, but S follows F.
+ */
+const bool slicePositive[NUM_AXES] = { false, true, false };
+
+/**
+ * Where the contents of each face end up after a clockwise cube
+ * rotation around each axis, indexed by Move::PIECES.
+ *
+ * y: F -> L -> B -> R -> F
+ * z: U -> R -> D -> L -> U
+ * x: F -> U -> B -> D -> F
+ */
+const PIECES rotationTable[NUM_AXES][6] = {
+	{ PIECES::UP, PIECES::DOWN, PIECES::LEFT, PIECES::RIGHT, PIECES::FRONT, PIECES::BACK },
+	{ PIECES::RIGHT, PIECES::LEFT, PIECES::FRONT, PIECES::BACK, PIECES::DOWN, PIECES::UP },
+	{ PIECES::BACK, PIECES::FRONT, PIECES::UP, PIECES::DOWN, PIECES::RIGHT, PIECES::LEFT }
+};
+
+/**
+ * A run of moves along a single axis.
+ */
+struct MoveGroup
+{
+	uint8_t axis;
+	uint8_t amounts[3];
+};
+
+/**
+ * A group split into the moves that make it up in ETM, where a cube
+ * rotation or wide turn costs the same as any other move: amounts of
+ * the rotation, the positive and negative wide turns, and what's left
+ * of each layer, all in clockwise quarter turns looking at the positive
+ * face.
+ */
+struct WideSplit
+{
+	uint8_t rotation;
+	uint8_t positiveWide;
+	uint8_t negativeWide;
+	uint8_t layers[3];
+};
+
+/**
+ * Number of clockwise quarter turns in the given move type.
+ */
+uint8_t typeAmount(TYPE type)
+{
+	switch (type)
+	{
+	case TYPE::NORMAL:
+		return 1;
+	case TYPE::DOUBLE:
+		return 2;
+	case TYPE::PRIME:
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Move type for the given number of clockwise quarter turns.
+ */
+TYPE amountType(uint8_t amount)
+{
+	switch (amount & 3)
+	{
+	case 1:
+		return TYPE::NORMAL;
+	case 2:
+		return TYPE::DOUBLE;
+	case 3:
+		return TYPE::PRIME;
+	default:
+		return TYPE::NO_MOVE;
+	}
+}
+
+/**
+ * Get the name of the given metric.
+ */
+std::string metricToString(METRIC metric)
+{
+	switch (metric)
+	{
+	case METRIC::HTM:
+		return "HTM";
+	case METRIC::QTM:
+		return "QTM";
+	case METRIC::STM:
+		return "STM";
+	case METRIC::ETM:
+		return "ETM";
+	}
+	return "";
+}
+
+/**
+ * Get the name of the given move set.
+ */
+std::string moveSetToString(MOVE_SET moveSet)
+{
+	switch (moveSet)
+	{
+	case MOVE_SET::ANY:
+		return "any";
+	case MOVE_SET::FACE_TURNS:
+		return "faces";
+	case MOVE_SET::SLICE_TURNS:
+		return "slices";
+	}
+	return "";
+}
+
+/**
+ * Lowercase copy of the given name, for comparing names.
+ */
+std::string lowercaseName(const std::string& name)
+{
+	std::string lower = name;
+	for (char& c : lower)
+	{
+		if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+	}
+	return lower;
+}
+
+/**
+ * Read a metric from its name, returning false if the
+ * name isn't recognized.
+ */
+bool parseMetric(const std::string& name, METRIC& metric)
+{
+	std::string lower = lowercaseName(name);
+	for (uint8_t i = 0; i <= (uint8_t)METRIC::ETM; i++)
+	{
+		if (lower == lowercaseName(metricToString((METRIC)i)))
+		{
+			metric = (METRIC)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Read a move set from its name, returning false if the
+ * name isn't recognized.
+ */
+bool parseMoveSet(const std::string& name, MOVE_SET& moveSet)
+{
+	std::string lower = lowercaseName(name);
+	for (uint8_t i = 0; i <= (uint8_t)MOVE_SET::SLICE_TURNS; i++)
+	{
+		if (lower == moveSetToString((MOVE_SET)i))
+		{
+			moveSet = (MOVE_SET)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Count the length of a single move in the given metric.
+ */
+size_t moveLength(const Move& move, METRIC metric)
+{
+	if (move.type == TYPE::NO_MOVE)
+		return 0;
+	if (move.pieces >= PIECES::X)
+		return metric == METRIC::ETM ? 1 : 0;
+	bool slice = move.pieces >= PIECES::M_SLICE;
+	switch (metric)
+	{
+	case METRIC::HTM:
+		return slice ? 2 : 1;
+	case METRIC::QTM:
+		return (slice ? 2 : 1) * (move.type == TYPE::DOUBLE ? 2 : 1);
+	case METRIC::STM:
+	case METRIC::ETM:
+		return 1;
+	}
+	return 1;
+}
+
+/**
+ * Count the length of the given solution in the given metric.
+ */
+size_t countMoves(const std::vector<Move>& solution, METRIC metric)
+{
+	return countMoves(solution.data(), solution.size(), metric);
+}
+
+size_t countMoves(const Move* solution, size_t count, METRIC metric)
+{
+	size_t length = 0;
+	for (size_t i = 0; i < count; i++)
+		length += moveLength(solution[i], metric);
+	return length;
+}
+
+/**
+ * Add the given move to the group it belongs to, after translating it
+ * through the frame of rotations absorbed so far.
+ *
+ * Return the axis the move turns around.
+ */
+uint8_t groupMove(const Move& move, const PIECES (&frame)[6], uint8_t (&amounts)[3])
+{
+	uint8_t amount = typeAmount(move.type);
+	amounts[0] = amounts[1] = amounts[2] = 0;
+
+	// find the face whose clockwise direction this move follows
+	PIECES face;
+	if (move.pieces <= PIECES::LEFT)
+		face = move.pieces;
+	else if (move.pieces <= PIECES::LEFT_WIDE)
+	{
+		const PIECES wideFaces[6] = { PIECES::FRONT, PIECES::BACK, PIECES::UP, PIECES::DOWN, PIECES::RIGHT, PIECES::LEFT };
+		face = wideFaces[(uint8_t)move.pieces - (uint8_t)PIECES::FRONT_WIDE];
+	}
+	else
+	{
+		const PIECES refFaces[6] = { PIECES::LEFT, PIECES::DOWN, PIECES::FRONT, PIECES::RIGHT, PIECES::UP, PIECES::FRONT };
+		face = refFaces[(uint8_t)move.pieces - (uint8_t)PIECES::M_SLICE];
+	}
+	face = frame[(uint8_t)face];
+
+	uint8_t axis = faceAxis[(uint8_t)face];
+	bool positive = facePositive[(uint8_t)face];
+	uint8_t signedAmount = positive ? amount : (4 - amount) & 3;
+	uint8_t outerLayer = positive ? 2 : 0;
+
+	// outer turns move one layer, wide turns two, slices the middle and rotations all three
+	if (move.pieces <= PIECES::LEFT)
+		amounts[outerLayer] = signedAmount;
+	else if (move.pieces <= PIECES::LEFT_WIDE)
+		amounts[outerLayer] = amounts[1] = signedAmount;
+	else if (move.pieces <= PIECES::S_SLICE)
+		amounts[1] = signedAmount;
+	else
+		amounts[0] = amounts[1] = amounts[2] = signedAmount;
+
+	return axis;
+}
+
+/**
+ * Cost of emitting the given layer amounts in the given metric, or
+ * 255 if they need a slice turn and slices aren't allowed.
+ */
+uint8_t groupCost(const uint8_t (&amounts)[3], METRIC metric, bool allowSlices)
+{
+	if (!allowSlices && amounts[1] != 0)
+		return 255;
+
+	uint8_t cost = 0;
+	for (uint8_t layer = 0; layer < 3; layer++)
+	{
+		if (amounts[layer] == 0)
+			continue;
+		// slices are two outer turns in HTM and QTM
+		uint8_t turns = (layer == 1 && (metric == METRIC::HTM || metric == METRIC::QTM)) ? 2 : 1;
+		if (metric == METRIC::QTM && amounts[layer] == 2)
+			turns *= 2;
+		cost += turns;
+	}
+	return cost;
+}
+
+/**
+ * Split the given layer amounts into the fewest rotations, wide turns
+ * and single layer turns. Every part turns the same axis, so they all
+ * commute and each is needed at most once: trying every amount of the
+ * three multi-layer parts finds the shortest split.
+ */
+WideSplit splitWide(const uint8_t (&amounts)[3])
+{
+	WideSplit best = { 0, 0, 0, { amounts[0], amounts[1], amounts[2] } };
+	uint8_t bestCost = 255;
+	for (uint8_t parts = 0; parts < 64; parts++)
+	{
+		WideSplit split;
+		split.rotation = parts & 3;
+		split.positiveWide = (parts >> 2) & 3;
+		split.negativeWide = parts >> 4;
+		split.layers[0] = (amounts[0] + 8 - split.rotation - split.negativeWide) & 3;
+		split.layers[1] = (amounts[1] + 12 - split.rotation - split.positiveWide - split.negativeWide) & 3;
+		split.layers[2] = (amounts[2] + 8 - split.rotation - split.positiveWide) & 3;
+
+		uint8_t cost = (split.rotation != 0) + (split.positiveWide != 0) + (split.negativeWide != 0);
+		for (uint8_t layer = 0; layer < 3; layer++)
+			cost += split.layers[layer] != 0;
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			best = split;
+		}
+	}
+	return best;
+}
+
+/**
+ * Close the given group: split off the cube rotation that makes the
+ * rest of it cheapest in the given metric, and absorb that rotation
+ * into the frame so later moves are translated around it.
+ */
+void closeGroup(MoveGroup& group, METRIC metric, bool allowSlices, PIECES (&frame)[6])
+{
+	// try every rotation, preferring no rotation at all
+	uint8_t bestRotation = 0;
+	uint8_t bestCost = 255;
+	uint8_t rest[3];
+	for (uint8_t rotation = 0; rotation < 4; rotation++)
+	{
+		for (uint8_t layer = 0; layer < 3; layer++)
+			rest[layer] = (group.amounts[layer] + 4 - rotation) & 3;
+		uint8_t cost = groupCost(rest, metric, allowSlices);
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestRotation = rotation;
+		}
+	}
+
+	for (uint8_t layer = 0; layer < 3; layer++)
+		group.amounts[layer] = (group.amounts[layer] + 4 - bestRotation) & 3;
+
+	// later moves happen before the rotation, so undo it on the frame
+	for (uint8_t turn = 0; turn < bestRotation; turn++)
+	{
+		for (uint8_t face = 0; face < 6; face++)
+		{
+			// undoing one quarter rotation is doing three more
+			PIECES mapped = frame[face];
+			for (uint8_t i = 0; i < 3; i++)
+				mapped = rotationTable[group.axis][(uint8_t)mapped];
+			frame[face] = mapped;
+		}
+	}
+}
+
+/**
+ * Append the moves making up the given group to the solution, using
+ * rotations and wide turns where they're fewer moves if keepWides is
+ * set.
+ */
+template <typename Moves>
+void emitGroup(const MoveGroup& group, bool keepWides, Moves& solution)
+{
+	uint8_t axis = group.axis;
+	if (keepWides)
+	{
+		WideSplit split = splitWide(group.amounts);
+		if (split.rotation != 0)
+			solution.push_back(Move(axisRotation[axis], amountType(split.rotation)));
+		if (split.positiveWide != 0)
+			solution.push_back(Move(axisPositiveWide[axis], amountType(split.positiveWide)));
+		if (split.negativeWide != 0)
+			solution.push_back(Move(axisNegativeWide[axis], amountType(4 - split.negativeWide)));
+		MoveGroup rest = { axis, { split.layers[0], split.layers[1], split.layers[2] } };
+		emitGroup(rest, false, solution);
+		return;
+	}
+
+	if (group.amounts[2] != 0)
+		solution.push_back(Move(axisPositiveFace[axis], amountType(group.amounts[2])));
+	if (group.amounts[0] != 0)
+		solution.push_back(Move(axisNegativeFace[axis], amountType(4 - group.amounts[0])));
+	if (group.amounts[1] != 0)
+		solution.push_back(Move(axisSlice[axis], amountType(slicePositive[axis] ? group.amounts[1] : 4 - group.amounts[1])));
+}
+
+/**
+ * Append the cube rotations undoing the given frame to the solution,
+ * using as few rotations as possible.
+ */
+template <typename Moves>
+void emitFrame(const PIECES (&frame)[6], Moves& solution)
+{
+	// the rotation still owed moves each face f to frame[f]'s inverse
+	PIECES target[6];
+	for (uint8_t face = 0; face < 6; face++)
+		target[(uint8_t)frame[face]] = (PIECES)face;
+
+	// check every sequence of up to two rotations
+	for (uint8_t length = 0; length <= 2; length++)
+	{
+		for (uint16_t seq = 0; seq < 81; seq++)
+		{
+			if ((length == 0 && seq > 0) || (length == 1 && seq >= 9))
+				break;
+
+			PIECES faces[6] = { PIECES::UP, PIECES::DOWN, PIECES::FRONT, PIECES::BACK, PIECES::RIGHT, PIECES::LEFT };
+			uint8_t moves[2] = { (uint8_t)(seq % 9), (uint8_t)(seq / 9) };
+			for (uint8_t i = 0; i < length; i++)
+			{
+				uint8_t axis = moves[i] / 3;
+				uint8_t amount = moves[i] % 3 + 1;
+				for (uint8_t face = 0; face < 6; face++)
+					for (uint8_t turn = 0; turn < amount; turn++)
+						faces[face] = rotationTable[axis][(uint8_t)faces[face]];
+			}
+
+			bool matches = true;
+			for (uint8_t face = 0; face < 6; face++)
+				matches = matches && faces[face] == target[face];
+			if (!matches)
+				continue;
+
+			for (uint8_t i = 0; i < length; i++)
+				solution.push_back(Move(axisRotation[moves[i] / 3], amountType(moves[i] % 3 + 1)));
+			return;
+		}
+	}
+}
+
+/**
+ * Optimize the given solution for the given metric.
+ *
+ * Moves are read once, left to right. Each move is translated through
+ * the cube rotations absorbed so far and added to the open group of
+ * moves along its axis. When a move along a different axis arrives,
+ * the open group is closed: it is reduced to its cheapest form, any
+ * whole-cube part of it is absorbed into the frame, and it is pushed
+ * onto a stack. If the group cancelled out entirely, the group below
+ * it on the stack is reopened so cancellations can cascade, which
+ * keeps the whole pass linear in the length of the solution.
+ *
+ * Wide turns and slices are broken into outer turns and rotations
+ * (slices are kept if the move set allows them and they are cheaper).
+ * ETM with the ANY move set is the exception: rotations and wide turns
+ * count as moves there, so they're kept in place instead, and each
+ * group is written with as few of them as possible. Otherwise, with
+ * the ANY move set, the rotations absorbed along the way are
+ * emitted once at the end so the solution leaves the cube in exactly
+ * the same state as before. The other move sets never rotate the cube,
+ * so they drop them: the cube still ends up solved, just possibly in
+ * a different orientation.
+ *
+ * Empty moves (NO_MOVE) are skipped.
+ *
+ * The stack of groups lives in the calling thread's arena, so this
+ * only allocates if the output does.
+ */
+template <typename Moves>
+void optimizeMoves(const Move* solution, size_t count, METRIC metric, MOVE_SET moveSet, Moves& optimized)
+{
+	// with any move set, only use slices if they count as a single move
+	bool allowSlices = moveSet == MOVE_SET::SLICE_TURNS ||
+		(moveSet == MOVE_SET::ANY && (metric == METRIC::STM || metric == METRIC::ETM));
+	// rotations aren't free in ETM, so they stay where they are along with wide turns
+	bool keepWides = moveSet == MOVE_SET::ANY && metric == METRIC::ETM;
+
+	PIECES frame[6] = { PIECES::UP, PIECES::DOWN, PIECES::FRONT, PIECES::BACK, PIECES::RIGHT, PIECES::LEFT };
+	ArenaScope scope(Arena::local());
+	MoveGroup* groups = Arena::local().allocate<MoveGroup>(count);
+	size_t numGroups = 0;
+
+	MoveGroup open = { 0, { 0, 0, 0 } };
+	bool isOpen = false;
+	uint8_t amounts[3];
+	for (size_t i = 0; i < count; i++)
+	{
+		const Move& move = solution[i];
+		if (move.type == TYPE::NO_MOVE)
+			continue;
+
+		uint8_t axis = groupMove(move, frame, amounts);
+		if (isOpen && axis != open.axis)
+		{
+			if (!keepWides)
+				closeGroup(open, metric, allowSlices, frame);
+			// the frame may have changed, so translate the move again
+			axis = groupMove(move, frame, amounts);
+
+			if (open.amounts[0] != 0 || open.amounts[1] != 0 || open.amounts[2] != 0)
+				groups[numGroups++] = open;
+			isOpen = false;
+
+			// reopen the previous group if it's along the same axis
+			if (numGroups > 0 && groups[numGroups - 1].axis == axis)
+			{
+				open = groups[--numGroups];
+				isOpen = true;
+			}
+		}
+		if (!isOpen)
+		{
+			open = { axis, { 0, 0, 0 } };
+			isOpen = true;
+		}
+		for (uint8_t layer = 0; layer < 3; layer++)
+			open.amounts[layer] = (open.amounts[layer] + amounts[layer]) & 3;
+	}
+	if (isOpen)
+	{
+		if (!keepWides)
+			closeGroup(open, metric, allowSlices, frame);
+		groups[numGroups++] = open;
+	}
+
+	for (size_t i = 0; i < numGroups; i++)
+		emitGroup(groups[i], keepWides, optimized);
+	if (moveSet == MOVE_SET::ANY)
+		emitFrame(frame, optimized);
+}
+
+std::vector<Move> optimizeSolution(const std::vector<Move>& solution, METRIC metric, MOVE_SET moveSet)
+{
+	std::vector<Move> optimized;
+	optimized.reserve(solution.size());
+	optimizeMoves(solution.data(), solution.size(), metric, moveSet, optimized);
+	return optimized;
+}
+
+void optimizeSolution(const Move* solution, size_t count, METRIC metric, MOVE_SET moveSet, MoveBuffer& optimized)
+{
+	optimized.clear();
+	optimizeMoves(solution, count, metric, moveSet, optimized);
+}
@@ -0,0 +1,79 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Move.h"
+#include "MoveBuffer.h"
+
+/**
+ * 8-bit enum for the metric used to measure solution length.
+ *
+ * HTM: every outer or wide turn is one move, slices are two.
+ * QTM: quarter turns are one move, half turns are two.
+ * STM: every turn of any layer, including slices, is one move.
+ * ETM: every move is one move, including cube rotations.
+ *
+ * Cube rotations are free in all but ETM.
+ */
+enum class METRIC : uint8_t
+{
+	HTM,
+	QTM,
+	STM,
+	ETM
+};
+
+/**
+ * 8-bit enum for the set of moves a solution can be written in.
+ *
+ * ANY: outer turns, plus slices where the metric makes them cheaper,
+ * and the cube rotations needed to finish in the same orientation.
+ * FACE_TURNS: only the six outer faces, never rotating the cube.
+ * SLICE_TURNS: outer faces and slices, never rotating the cube.
+ */
+enum class MOVE_SET : uint8_t
+{
+	ANY,
+	FACE_TURNS,
+	SLICE_TURNS
+};
+
+/**
+ * Get the name of the given metric or move set.
+ */
+std::string metricToString(METRIC metric);
+std::string moveSetToString(MOVE_SET moveSet);
+
+/**
+ * Read a metric or move set from its name, returning false if
+ * the name isn't recognized. Names are case insensitive.
+ */
+bool parseMetric(const std::string& name, METRIC& metric);
+bool parseMoveSet(const std::string& name, MOVE_SET& moveSet);
+
+/**
+ * Count the length of a single move in the given metric.
+ */
+size_t moveLength(const Move& move, METRIC metric);
+
+/**
+ * Count the length of the given solution in the given metric.
+ */
+size_t countMoves(const std::vector<Move>& solution, METRIC metric);
+size_t countMoves(const Move* solution, size_t count, METRIC metric);
+
+/**
+ * Optimize the given solution for the given metric in a single pass,
+ * cancelling moves across commuting layers and cube rotations, and
+ * rewrite it using only moves from the given move set.
+ *
+ * The second version writes the optimized solution into the given
+ * buffer without allocating.
+ */
+std::vector<Move> optimizeSolution(const std::vector<Move>& solution, METRIC metric, MOVE_SET moveSet = MOVE_SET::ANY);
+void optimizeSolution(const Move* solution, size_t count, METRIC metric, MOVE_SET moveSet, MoveBuffer& optimized);
+
+#endif
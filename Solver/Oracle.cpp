@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <string.h>
+
+#include "Oracle.h"
+#include "Symmetry.h"
+
+typedef Cube::COLOR COLOR;
+typedef Cube::FACE FACE;
+
+constexpr uint8_t CrossTables::NUM_EDGE_STICKERS;
+constexpr uint32_t CrossTables::NUM_CROSS_POSITIONS;
+constexpr uint8_t CrossTables::UNREACHED;
+
+/**
+ * The tables, built by the first thread to need them while any others
+ * wait.
+ */
+const CrossTables& CrossTables::get()
+{
+	static const CrossTables tables;
+	return tables;
+}
+
+/**
+ * Build the tables: each edge sticker's partner, where each face turn
+ * and each rotation that turns a face down take each edge sticker, and
+ * the distances, by a breadth first search from the solved down cross.
+ */
+CrossTables::CrossTables()
+{
+	Cube solved;
+	for (uint8_t s = 0; s < NUM_EDGE_STICKERS; s++)
+		partner[s] = edgeSticker(solved.getAdjacentEdge(edgeLocation(s)));
+
+	for (uint8_t code = 0; code < NUM_FACE_CODES; code++)
+	{
+		Cube turned;
+		turned.executeMove(Move::fromCode(code));
+		trackEdges(solved, turned, moved[code]);
+	}
+
+	// each of the bottom rotations turns a different face down
+	for (uint8_t symmetry = 0; symmetry < NUM_ROTATIONS; symmetry += 4)
+	{
+		Cube turned;
+		applySymmetry(turned, symmetry);
+		uint8_t face = (uint8_t)findCenter(solved, turned.getCenter(FACE::DOWN));
+		trackEdges(solved, turned, toDown[face]);
+		for (uint8_t k = 0; k < 4; k++)
+		{
+			uint8_t sticker = face * 4 + k;
+			uint8_t down = toDown[face][sticker];
+			home[face][down % 4] = sticker;
+		}
+	}
+
+	uint8_t identity[NUM_EDGE_STICKERS];
+	for (uint8_t s = 0; s < NUM_EDGE_STICKERS; s++)
+		identity[s] = s;
+	const uint8_t* goal = home[(uint8_t)FACE::DOWN];
+	distances.assign(NUM_CROSS_POSITIONS, UNREACHED);
+	std::vector<uint32_t> frontier(1, crossIndex(identity, goal));
+	std::vector<uint32_t> next;
+	distances[frontier[0]] = 0;
+	for (uint8_t depth = 1; !frontier.empty(); depth++)
+	{
+		next.clear();
+		for (uint32_t index : frontier)
+		{
+			uint8_t positions[4] = { (uint8_t)(index / 13824), (uint8_t)(index / 576 % 24), (uint8_t)(index / 24 % 24),
+				(uint8_t)(index % 24) };
+			for (uint8_t code = 0; code < NUM_FACE_CODES; code++)
+			{
+				uint32_t neighbor = crossIndex(moved[code], positions);
+				if (distances[neighbor] == UNREACHED)
+				{
+					distances[neighbor] = depth;
+					next.push_back(neighbor);
+				}
+			}
+		}
+		frontier.swap(next);
+	}
+}
+
+/**
+ * Find the edge sticker showing each face's color on each of its cross
+ * edges, in the order of their homes. Edges are told apart by their two
+ * colors, looked up in a table keyed by the centers.
+ */
+void CrossTables::findCrossEdges(const Cube& scrambled, uint8_t positions[6][4]) const
+{
+	Cube cube = scrambled;
+	uint8_t centers[6];
+	for (uint8_t f = 0; f < 6; f++)
+		centers[f] = (uint8_t)cube.getCenter((FACE)f);
+
+	uint8_t keys[64];
+	memset(keys, UNREACHED, sizeof(keys));
+	for (uint8_t f = 0; f < 6; f++)
+	{
+		for (uint8_t k = 0; k < 4; k++)
+		{
+			uint8_t other = partner[home[f][k]] / 4;
+			keys[centers[f] % 8 * 8 + centers[other] % 8] = f * 4 + k;
+			positions[f][k] = home[f][k];
+		}
+	}
+
+	for (uint8_t s = 0; s < NUM_EDGE_STICKERS; s++)
+	{
+		uint8_t first = (uint8_t)cube.getSticker(edgeLocation(s));
+		uint8_t second = (uint8_t)cube.getSticker(edgeLocation(partner[s]));
+		uint8_t key = keys[first % 8 * 8 + second % 8];
+		if (key != UNREACHED)
+			positions[key / 4][key % 4] = s;
+	}
+}
+
+uint8_t CrossTables::lookUp(const uint8_t positions[4], FACE face) const
+{
+	return distances[crossIndex(toDown[(uint8_t)face], positions)];
+}
+
+/**
+ * Find where each edge sticker of the first cube went in the second,
+ * by the colors of its edge.
+ */
+void CrossTables::trackEdges(Cube& before, Cube& after, uint8_t map[NUM_EDGE_STICKERS]) const
+{
+	for (uint8_t from = 0; from < NUM_EDGE_STICKERS; from++)
+	{
+		COLOR first = before.getSticker(edgeLocation(from));
+		COLOR second = before.getSticker(edgeLocation(partner[from]));
+		for (uint8_t to = 0; to < NUM_EDGE_STICKERS; to++)
+		{
+			if (after.getSticker(edgeLocation(to)) == first && after.getSticker(edgeLocation(partner[to])) == second)
+			{
+				map[from] = to;
+				break;
+			}
+		}
+	}
+}
+
+uint32_t CrossTables::crossIndex(const uint8_t map[NUM_EDGE_STICKERS], const uint8_t positions[4])
+{
+	return ((map[positions[0]] * 24 + map[positions[1]]) * 24 + map[positions[2]]) * 24 + map[positions[3]];
+}
+
+/**
+ * Fewest outer face turns that solve the cross on the given face.
+ */
+uint8_t crossDistance(const Cube& cube, FACE face)
+{
+	const CrossTables& tables = CrossTables::get();
+	uint8_t positions[6][4];
+	tables.findCrossEdges(cube, positions);
+	return tables.lookUp(positions[(uint8_t)face], face);
+}
+
+/**
+ * Lower bound on the outer face turns that solve the given cube.
+ */
+uint8_t distanceLowerBound(const Cube& cube)
+{
+	const CrossTables& tables = CrossTables::get();
+	uint8_t positions[6][4];
+	tables.findCrossEdges(cube, positions);
+	uint8_t bound = 0;
+	for (uint8_t f = 0; f < 6; f++)
+		bound = std::max(bound, tables.lookUp(positions[f], (FACE)f));
+	return bound;
+}
+
+HintOracle::HintOracle() : stepPhase(PHASE::CROSS), stepCross(FACE::DOWN), stepPairsLeft(0) {}
+
+/**
+ * Give a hint for the given cube: the cross closest to done (the down
+ * one if it ties), and the next move towards it or of the step the cube
+ * is on.
+ */
+Hint HintOracle::hint(const Cube& cube)
+{
+	const CrossTables& tables = CrossTables::get();
+	uint8_t positions[6][4];
+	tables.findCrossEdges(cube, positions);
+
+	Hint hint;
+	uint8_t distances[6];
+	hint.lowerBound = 0;
+	for (uint8_t f = 0; f < 6; f++)
+	{
+		distances[f] = tables.lookUp(positions[f], (FACE)f);
+		hint.lowerBound = std::max(hint.lowerBound, distances[f]);
+	}
+
+	// a step keeps its own cross, even while its moves break it
+	size_t index = 0;
+	bool onStep = findOnStep(cube, index);
+	FACE cross = onStep ? stepCross : FACE::DOWN;
+	for (uint8_t f = 0; f < 6 && !onStep; f++)
+	{
+		if (distances[f] < distances[(uint8_t)cross])
+			cross = (FACE)f;
+	}
+	Cube copy = cube;
+	hint.crossColor = copy.getCenter(cross);
+	hint.crossDistance = distances[(uint8_t)cross];
+
+	size_t stepLeft;
+	if (onStep)
+	{
+		hint.phase = stepPhase;
+		hint.pairsLeft = stepPairsLeft;
+		hint.next = stepMoves[index];
+		stepLeft = stepMoves.size() - index;
+	}
+	else if (hint.crossDistance > 0)
+	{
+		hint.phase = PHASE::CROSS;
+		hint.pairsLeft = 4;
+		hint.next = Move();
+		for (uint8_t code = 0; code < NUM_FACE_CODES; code++)
+		{
+			uint8_t turned[4];
+			for (uint8_t k = 0; k < 4; k++)
+				turned[k] = tables.turn(code, positions[(uint8_t)cross][k]);
+			if (tables.lookUp(turned, cross) < hint.crossDistance)
+			{
+				hint.next = Move::fromCode(code);
+				break;
+			}
+		}
+		stepLeft = hint.crossDistance;
+	}
+	else
+	{
+		FACE top = copy.getOppositeFace(cross);
+		hint.pairsLeft = 4 - countSolvedPairs(copy, cross);
+		if (hint.pairsLeft > 0)
+			hint.phase = PHASE::F2L;
+		else if (copy.getFace(top) != (uint64_t)copy.getCenter(top) * 0x0101010101010101)
+			hint.phase = PHASE::OLL;
+		else if (!copy.isSolved())
+			hint.phase = PHASE::PLL;
+		else
+		{
+			hint.phase = PHASE::PLL;
+			hint.estimate = 0;
+			hint.next = Move();
+			return hint;
+		}
+		stepPairsLeft = hint.pairsLeft;
+		startStep(cube, hint.phase, cross);
+		hint.next = stepMoves.size() > 0 ? stepMoves[0] : Move();
+		stepLeft = stepMoves.size();
+	}
+
+	// the averages of the phases after this one
+	double rest = AVERAGE_PLL_MOVES;
+	switch (hint.phase)
+	{
+	case PHASE::CROSS:
+		rest += 4 * AVERAGE_PAIR_MOVES + AVERAGE_OLL_MOVES;
+		break;
+	case PHASE::F2L:
+		rest += (hint.pairsLeft - 1) * AVERAGE_PAIR_MOVES + AVERAGE_OLL_MOVES;
+		break;
+	case PHASE::OLL:
+		break;
+	case PHASE::PLL:
+		rest = 0;
+		break;
+	}
+	size_t estimate = stepLeft + (size_t)(rest + 0.5);
+	hint.estimate = (uint8_t)std::min<size_t>(std::max<size_t>(estimate, hint.lowerBound), UINT8_MAX);
+	return hint;
+}
+
+/**
+ * Find the given cube among the states before each of the current
+ * step's moves, comparing hashes before whole states.
+ */
+bool HintOracle::findOnStep(const Cube& cube, size_t& index) const
+{
+	uint64_t hash = cube.hash();
+	for (size_t i = 0; i < stepMoves.size(); i++)
+	{
+		if (stepHashes[i] == hash && stepPath[i] == cube)
+		{
+			index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Solve the given phase's step with the cube turned so the cross is
+ * down, as the solver's steps expect, then map its moves back to the
+ * cube as it's held, and record the state before each of them.
+ */
+void HintOracle::startStep(const Cube& cube, PHASE phase, FACE cross)
+{
+	Cube held = cube;
+	COLOR color = held.getCenter(cross);
+	Cube turned = cube;
+	uint8_t symmetry = 0;
+	for (; symmetry < NUM_ROTATIONS; symmetry += 4)
+	{
+		turned = cube;
+		applySymmetry(turned, symmetry);
+		if (turned.getCenter(FACE::DOWN) == color)
+			break;
+	}
+
+	MoveBuffer moves;
+	switch (phase)
+	{
+	case PHASE::F2L:
+		solveNextF2LPair(turned, moves);
+		break;
+	case PHASE::OLL:
+		solveOLL(turned, moves);
+		break;
+	default:
+		solvePLL(turned, moves);
+		break;
+	}
+
+	// merge the turns where the step's algorithms meet, as a solution would
+	MoveBuffer merged;
+	cleanSolution(moves.data(), moves.size(), false, METRIC::HTM, MOVE_SET::ANY, merged);
+	stepMoves.clear();
+	stepPath.clear();
+	stepHashes.clear();
+	stepPhase = phase;
+	stepCross = cross;
+	for (const Move& move : merged)
+	{
+		stepMoves.push_back(Move::fromCode(conjugateMoveCode(symmetry, move.code())));
+		stepPath.push_back(held);
+		stepHashes.push_back(held.hash());
+		held.executeMove(stepMoves.back());
+	}
+}
@@ -0,0 +1,182 @@
+#ifndef ORACLE_H
+#define ORACLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "Solver.h"
+
+/**
+ * Average moves the solver's own steps take for each F2L pair, OLL and
+ * PLL (including the turns of the up face), measured over random
+ * scrambles, for estimating the moves left in a solve.
+ */
+const double AVERAGE_PAIR_MOVES = 8.3;
+const double AVERAGE_OLL_MOVES = 10.8;
+const double AVERAGE_PLL_MOVES = 14.0;
+
+/**
+ * Fewest outer face turns that solve the cross on the given face, from
+ * a table of every position of the four cross edges (built on first
+ * use, in a few milliseconds).
+ */
+uint8_t crossDistance(const Cube& cube, Cube::FACE face);
+
+/**
+ * A lower bound on the outer face turns that solve the given cube: the
+ * most any of its six crosses needs, since solving the cube solves
+ * them all.
+ */
+uint8_t distanceLowerBound(const Cube& cube);
+
+class CrossTables
+{
+	/**
+	 * This class holds the tables for finding how far each cross is from
+	 * solved, built once and shared by every thread.
+	 *
+	 * Edge stickers are numbered face * 4 + idx / 2. Every cross is
+	 * looked up as the down cross, by turning its face down: each face
+	 * has a map of where the whole cube rotation does that takes each
+	 * edge sticker, and the homes of its cross edges, ordered by the down
+	 * cross edges they're taken to. The table holds the distance of each
+	 * position of the down cross, found by a breadth first search from
+	 * solved.
+	 */
+
+public:
+	/**
+	 * Number of edge stickers, and of positions of the four cross edges
+	 * (where each one's sticker of the cross color is), and the distance
+	 * of positions the search hasn't reached.
+	 */
+	static constexpr uint8_t NUM_EDGE_STICKERS = 24;
+	static constexpr uint32_t NUM_CROSS_POSITIONS = 24 * 24 * 24 * 24;
+	static constexpr uint8_t UNREACHED = 0xff;
+
+	/**
+	 * The tables, built on first use.
+	 */
+	static const CrossTables& get();
+
+	/**
+	 * Find the edge sticker showing each face's color on each of its
+	 * cross edges in the given cube.
+	 */
+	void findCrossEdges(const Cube& scrambled, uint8_t positions[6][4]) const;
+
+	/**
+	 * Fewest outer face turns that solve the cross on the given face,
+	 * with its edges at the given positions.
+	 */
+	uint8_t lookUp(const uint8_t positions[4], Cube::FACE face) const;
+
+	/**
+	 * The edge sticker the outer face turn with the given code takes the
+	 * given one to.
+	 */
+	uint8_t turn(uint8_t code, uint8_t sticker) const { return moved[code][sticker]; }
+
+private:
+	CrossTables();
+	CrossTables(const CrossTables&);
+	CrossTables& operator=(const CrossTables&);
+
+	/**
+	 * Find where each edge sticker of the first cube went in the second.
+	 */
+	void trackEdges(Cube& before, Cube& after, uint8_t map[NUM_EDGE_STICKERS]) const;
+
+	/**
+	 * Index in the distances of the given positions, once the given map
+	 * turns them to the down cross.
+	 */
+	static uint32_t crossIndex(const uint8_t map[NUM_EDGE_STICKERS], const uint8_t positions[4]);
+
+	/**
+	 * The location of the given edge sticker, and the edge sticker at the
+	 * given location.
+	 */
+	static Cube::LOCATION edgeLocation(uint8_t sticker)
+	{
+		return { (Cube::FACE)(sticker / 4), (uint8_t)(sticker % 4 * 2 + 1) };
+	}
+	static uint8_t edgeSticker(Cube::LOCATION loc) { return (uint8_t)loc.face * 4 + loc.idx / 2; }
+
+	uint8_t partner[NUM_EDGE_STICKERS];
+	uint8_t moved[NUM_FACE_CODES][NUM_EDGE_STICKERS];
+	uint8_t toDown[6][NUM_EDGE_STICKERS];
+	uint8_t home[6][4];
+	std::vector<uint8_t> distances;
+};
+
+/**
+ * What a hint knows about a cube: the phase it's in, the cross it's
+ * building (the one closest to done), how many turns that cross needs
+ * and how many F2L pairs are left around it, a lower bound on the turns
+ * to solve the cube, an estimate of the moves the solver's method takes
+ * from here, and the move to make next (an empty move, of type NO_MOVE,
+ * once it's solved).
+ */
+struct Hint
+{
+	PHASE phase;
+	Cube::COLOR crossColor;
+	uint8_t crossDistance;
+	uint8_t pairsLeft;
+	uint8_t lowerBound;
+	uint8_t estimate;
+	Move next;
+};
+
+class HintOracle
+{
+	/**
+	 * This class gives hints for cubes a user is solving, as often as
+	 * after every turn.
+	 *
+	 * Distances come from the cross table alone, so they take the same
+	 * time for any cube. Until the cross is done, the next move is an
+	 * optimal cross move from the same table. After that, it's the next
+	 * move of the solver's own step for the phase the cube is in (one
+	 * F2L pair, OLL or PLL), whose moves are kept, so while the user
+	 * follows them, the hint is looked up rather than found again. A
+	 * cube off those moves starts a new step, which takes a few
+	 * microseconds.
+	 *
+	 * An oracle isn't safe to use from several threads at once; each
+	 * thread should have its own.
+	 */
+
+public:
+	HintOracle();
+
+	/**
+	 * Give a hint for the given cube.
+	 */
+	Hint hint(const Cube& cube);
+
+private:
+	/**
+	 * Find the given cube among the states before each of the current
+	 * step's moves, returning false if it isn't one of them.
+	 */
+	bool findOnStep(const Cube& cube, size_t& index) const;
+
+	/**
+	 * Start the step for the given phase on the given cube, with the
+	 * cross on the given face.
+	 */
+	void startStep(const Cube& cube, PHASE phase, Cube::FACE cross);
+
+	// the moves of the current step, the states before each one, its phase and cross, and the F2L pairs left when it began
+	MoveBuffer stepMoves;
+	std::vector<Cube> stepPath;
+	std::vector<uint64_t> stepHashes;
+	PHASE stepPhase;
+	Cube::FACE stepCross;
+	uint8_t stepPairsLeft;
+};
+
+#endif
@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+#include "Cube.h"
+#include "MappedFile.h"
+#include "Peephole.h"
+
+/**
+ * Length of the longest sequences stored in the table.
+ *
+ * There are 621,649 positions within 5 half turns of solved,
+ * which fit comfortably in an 8MB table. Each sequence is packed
+ * into 28 bits: 3 bits of length followed by 5 bits per move.
+ */
+const uint8_t PEEPHOLE_DEPTH = 5;
+
+/**
+ * Upper bound on the number of positions within each depth,
+ * used to size the table.
+ */
+const uint32_t peepholeStates[PEEPHOLE_DEPTH + 1] = { 1, 19, 262, 3502, 46741, 621649 };
+
+/**
+ * Longest window of moves checked for a shorter replacement.
+ */
+const uint8_t PEEPHOLE_WINDOW = 12;
+
+/**
+ * Header at the start of a saved table, followed by the entries.
+ */
+struct PeepholeHeader
+{
+	char magic[8];
+	uint32_t depth;
+	uint32_t reserved;
+	uint64_t capacity;
+	uint64_t count;
+};
+
+const char PEEPHOLE_MAGIC[8] = { 'C', 'S', 'P', 'E', 'E', 'P', '0', '2' };
+
+/**
+ * The open-addressing table of optimal sequences, keyed by the
+ * hash of the position each sequence reaches from solved.
+ *
+ * Each 64-bit entry holds the top 36 bits of the hash (with the
+ * highest bit always set, so entries are never zero) above the
+ * 28-bit packed sequence, so a lookup touches a single cache line.
+ *
+ * It lives in either the mapped file or the in-memory buffer.
+ */
+struct PeepholeTable
+{
+	const uint64_t* entries;
+	uint64_t capacity;
+};
+
+const uint64_t PEEPHOLE_SEQ_MASK = (1 << 28) - 1;
+
+PeepholeTable peepholeTable = { nullptr, 0 };
+MappedFile peepholeFile;
+std::vector<uint8_t> peepholeBuffer;
+std::string peepholePath;
+bool peepholeMapped = false;
+std::once_flag peepholeOnce;
+
+/**
+ * Hash of a position as stored in the table, with the bits used for
+ * the sequence cleared. Zero marks an empty slot.
+ */
+uint64_t peepholeKey(const Cube& cube)
+{
+	return (cube.hash() | ((uint64_t)1 << 63)) & ~PEEPHOLE_SEQ_MASK;
+}
+
+/**
+ * Unpack the move at the given position in a packed sequence.
+ */
+Move unpackPeepholeMove(uint32_t seq, uint8_t i)
+{
+	uint8_t code = (seq >> (3 + 5 * i)) & 31;
+	return Move((Move::PIECES)(code / 3), (Move::TYPE)(code % 3));
+}
+
+/**
+ * Visit every canonical sequence of exactly the given length,
+ * inserting the position it reaches unless a shorter sequence
+ * already reached it.
+ *
+ * Canonical sequences never turn the same face twice in a row, and
+ * only turn opposite faces in one order, since they commute.
+ */
+void buildPeepholeLevel(const Cube& cube, uint8_t length, uint8_t remaining, uint8_t lastFace, uint32_t seq,
+	uint64_t* entries, uint64_t capacity, uint64_t& count)
+{
+	if (remaining == 0)
+	{
+		uint64_t key = peepholeKey(cube);
+		uint64_t slot = (key >> 28) & (capacity - 1);
+		while (entries[slot] != 0)
+		{
+			if ((entries[slot] & ~PEEPHOLE_SEQ_MASK) == key)
+				return;
+			slot = (slot + 1) & (capacity - 1);
+		}
+		entries[slot] = key | seq | length;
+		count++;
+		return;
+	}
+
+	uint8_t depth = length - remaining;
+	for (uint8_t face = 0; face < 6; face++)
+	{
+		// same face twice, or opposite faces in the wrong order
+		if (lastFace < 6 && (face == lastFace || (face / 2 == lastFace / 2 && face < lastFace)))
+			continue;
+
+		for (uint8_t type = 0; type < 3; type++)
+		{
+			Cube next = cube;
+			next.executeMove(Move((Move::PIECES)face, (Move::TYPE)type));
+			uint32_t code = face * 3 + type;
+			buildPeepholeLevel(next, length, remaining - 1, face, seq | (code << (3 + 5 * depth)), entries, capacity, count);
+		}
+	}
+}
+
+/**
+ * Build the table into the in-memory buffer.
+ *
+ * Sequences are inserted shortest first, so the first sequence
+ * to reach a position is always an optimal one.
+ */
+void buildPeepholeTable()
+{
+	uint64_t capacity = 1;
+	while (capacity < (uint64_t)peepholeStates[PEEPHOLE_DEPTH] * 3 / 2)
+		capacity <<= 1;
+
+	peepholeBuffer.assign(sizeof(PeepholeHeader) + capacity * sizeof(uint64_t), 0);
+	PeepholeHeader* header = (PeepholeHeader*)peepholeBuffer.data();
+	uint64_t* entries = (uint64_t*)(peepholeBuffer.data() + sizeof(PeepholeHeader));
+
+	uint64_t count = 0;
+	Cube solved;
+	for (uint8_t length = 0; length <= PEEPHOLE_DEPTH; length++)
+		buildPeepholeLevel(solved, length, length, 6, 0, entries, capacity, count);
+
+	memcpy(header->magic, PEEPHOLE_MAGIC, sizeof(PEEPHOLE_MAGIC));
+	header->depth = PEEPHOLE_DEPTH;
+	header->capacity = capacity;
+	header->count = count;
+}
+
+/**
+ * Whether the given bytes hold a valid table: besides the header, every
+ * entry must be a sequence of at most PEEPHOLE_DEPTH outer turns, and
+ * at least one slot must be empty, since a lookup only stops at one.
+ * The file may have been changed by anything, so every entry is read.
+ */
+bool isPeepholeTable(const uint8_t* data, size_t size)
+{
+	if (size < sizeof(PeepholeHeader))
+		return false;
+
+	const PeepholeHeader* header = (const PeepholeHeader*)data;
+	if (memcmp(header->magic, PEEPHOLE_MAGIC, sizeof(PEEPHOLE_MAGIC)) != 0 || header->depth != PEEPHOLE_DEPTH)
+		return false;
+
+	uint64_t capacity = header->capacity;
+	if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+		capacity != (size - sizeof(PeepholeHeader)) / sizeof(uint64_t) ||
+		size != sizeof(PeepholeHeader) + capacity * sizeof(uint64_t))
+		return false;
+
+	const uint64_t* entries = (const uint64_t*)(data + sizeof(PeepholeHeader));
+	uint64_t count = 0;
+	for (uint64_t slot = 0; slot < capacity; slot++)
+	{
+		uint64_t entry = entries[slot];
+		if (entry == 0)
+			continue;
+		uint8_t length = entry & 7;
+		if (length > PEEPHOLE_DEPTH)
+			return false;
+		for (uint8_t i = 0; i < length; i++)
+		{
+			if (((entry >> (3 + 5 * i)) & 31) >= NUM_FACE_CODES)
+				return false;
+		}
+		count++;
+	}
+	return count < capacity && count == header->count;
+}
+
+/**
+ * Point the table at the given bytes, if they hold a valid table.
+ */
+bool usePeepholeTable(const uint8_t* data, size_t size)
+{
+	if (!isPeepholeTable(data, size))
+		return false;
+
+	peepholeTable.entries = (const uint64_t*)(data + sizeof(PeepholeHeader));
+	peepholeTable.capacity = ((const PeepholeHeader*)data)->capacity;
+	return true;
+}
+
+/**
+ * Write the in-memory table to the given path.
+ *
+ * It's written to a temporary file first and renamed into place,
+ * so other processes never map a partially written table.
+ */
+bool savePeepholeTable(const std::string& path)
+{
+	std::string tmpPath = path + ".tmp";
+	FILE* file = fopen(tmpPath.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	bool written = fwrite(peepholeBuffer.data(), 1, peepholeBuffer.size(), file) == peepholeBuffer.size();
+	written = fclose(file) == 0 && written;
+	if (!written || rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Map the table from the configured path, or build it (saving it to
+ * the path, if there is one) when it can't be mapped.
+ */
+void initPeepholeTable()
+{
+	if (!peepholePath.empty() && peepholeFile.open(peepholePath))
+	{
+		if (usePeepholeTable(peepholeFile.data(), peepholeFile.size()))
+		{
+			peepholeMapped = true;
+			return;
+		}
+		peepholeFile.close();
+	}
+
+	buildPeepholeTable();
+	if (!peepholePath.empty() && savePeepholeTable(peepholePath) && peepholeFile.open(peepholePath) &&
+		usePeepholeTable(peepholeFile.data(), peepholeFile.size()))
+	{
+		// the mapped copy replaces the buffer
+		std::vector<uint8_t>().swap(peepholeBuffer);
+		peepholeMapped = true;
+		return;
+	}
+	usePeepholeTable(peepholeBuffer.data(), peepholeBuffer.size());
+}
+
+/**
+ * Load the table of optimal move sequences from the given file,
+ * building it and saving it there first if it doesn't exist yet.
+ */
+bool loadPeepholeTable(const std::string& path)
+{
+	std::call_once(peepholeOnce, [&path]() {
+		peepholePath = path;
+		initPeepholeTable();
+	});
+	return peepholeMapped;
+}
+
+/**
+ * Slot where the search for the given key starts.
+ */
+uint64_t peepholeSlot(uint64_t key) { return (key >> 28) & (peepholeTable.capacity - 1); }
+
+/**
+ * Find the optimal sequence for the given key, which reaches a
+ * position from solved.
+ *
+ * Return the packed sequence, or 0 if the position isn't in the table.
+ * (An empty sequence is never returned, since windows never cancel
+ * out entirely after the solution has been optimized.)
+ */
+uint32_t findPeepholeSeq(uint64_t key)
+{
+	uint64_t mask = peepholeTable.capacity - 1;
+	for (uint64_t slot = peepholeSlot(key); peepholeTable.entries[slot] != 0; slot = (slot + 1) & mask)
+	{
+		if ((peepholeTable.entries[slot] & ~PEEPHOLE_SEQ_MASK) == key)
+			return (uint32_t)(peepholeTable.entries[slot] & PEEPHOLE_SEQ_MASK);
+	}
+	return 0;
+}
+
+/**
+ * Shorten the given solution by replacing short windows of
+ * outer turns with optimal sequences that have the same effect.
+ *
+ * Starting at each move, the window is grown one move at a time
+ * while tracking the position it reaches from solved. Any window
+ * whose position is in the table with a cheaper sequence (in the
+ * given metric) is a candidate, and the one saving the most moves is
+ * replaced. Windows stop at anything that isn't an outer turn.
+ *
+ * Every window's position is worked out before any of them are
+ * looked up, so the table lookups (which nearly always miss the
+ * cache) can all be in flight at once.
+ *
+ * The solution should already be optimized, so that newly adjacent
+ * moves can be merged by optimizing it again afterwards.
+ */
+template <typename Moves>
+void peepholeMoves(const Move* solution, size_t count, METRIC metric, Moves& result)
+{
+	std::call_once(peepholeOnce, initPeepholeTable);
+
+	Cube windows[PEEPHOLE_WINDOW];
+	uint64_t keys[PEEPHOLE_WINDOW];
+	size_t windowLengths[PEEPHOLE_WINDOW];
+
+	size_t i = 0;
+	while (i < count)
+	{
+		// find the position reached by each window starting here
+		uint8_t numWindows = 0;
+		Cube window;
+		size_t windowLength = 0;
+		for (size_t j = i; j < count && numWindows < PEEPHOLE_WINDOW; j++)
+		{
+			const Move& move = solution[j];
+			if (move.type == Move::TYPE::NO_MOVE || move.pieces > Move::PIECES::LEFT)
+				break;
+			window.executeMove(move);
+			windowLength += moveLength(move, metric);
+
+			windows[numWindows] = window;
+			keys[numWindows] = peepholeKey(window);
+			windowLengths[numWindows] = windowLength;
+#if defined(__GNUC__)
+			__builtin_prefetch(&peepholeTable.entries[peepholeSlot(keys[numWindows])]);
+#endif
+			numWindows++;
+		}
+
+		// single moves are already optimal, so start with two
+		uint8_t bestWindow = 0;
+		size_t bestSaving = 0;
+		uint32_t bestSeq = 0;
+		for (uint8_t k = 1; k < numWindows; k++)
+		{
+			uint32_t seq = findPeepholeSeq(keys[k]);
+			if (seq == 0)
+				continue;
+
+			size_t seqLength = 0;
+			for (uint8_t m = 0; m < (seq & 7); m++)
+				seqLength += moveLength(unpackPeepholeMove(seq, m), metric);
+			if (seqLength + bestSaving >= windowLengths[k])
+				continue;
+
+			// make sure this isn't a hash collision
+			Cube replacement;
+			for (uint8_t m = 0; m < (seq & 7); m++)
+				replacement.executeMove(unpackPeepholeMove(seq, m));
+			if (!(replacement == windows[k]))
+				continue;
+
+			bestWindow = k;
+			bestSaving = windowLengths[k] - seqLength;
+			bestSeq = seq;
+		}
+
+		if (bestSaving > 0)
+		{
+			for (uint8_t m = 0; m < (bestSeq & 7); m++)
+				result.push_back(unpackPeepholeMove(bestSeq, m));
+			i += bestWindow + 1;
+		}
+		else
+			result.push_back(solution[i++]);
+	}
+}
+
+std::vector<Move> peepholeSolution(const std::vector<Move>& solution, METRIC metric)
+{
+	std::vector<Move> result;
+	result.reserve(solution.size());
+	peepholeMoves(solution.data(), solution.size(), metric, result);
+	return result;
+}
+
+void peepholeSolution(const Move* solution, size_t count, METRIC metric, MoveBuffer& result)
+{
+	result.clear();
+	peepholeMoves(solution, count, metric, result);
+}
@@ -0,0 +1,38 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <string>
+#include <vector>
+
+#include "Move.h"
+#include "MoveBuffer.h"
+#include "Optimizer.h"
+
+/**
+ * Load the table of optimal move sequences from the given file,
+ * building it and saving it there first if it doesn't exist yet.
+ *
+ * Must be called before the first call to peepholeSolution to
+ * have any effect; otherwise the table is built in memory the first
+ * time it's needed. Returns false if the table couldn't be saved or
+ * mapped (it's still built in memory in that case).
+ */
+bool loadPeepholeTable(const std::string& path);
+
+/**
+ * Whether the given bytes (the contents of a table's file) hold a valid
+ * table. A table that isn't is never used, and is rebuilt instead.
+ */
+bool isPeepholeTable(const uint8_t* data, size_t size);
+
+/**
+ * Shorten the given solution by replacing short windows of
+ * outer turns with optimal sequences that have the same effect.
+ *
+ * The second version writes the shortened solution into the given
+ * buffer without allocating.
+ */
+std::vector<Move> peepholeSolution(const std::vector<Move>& solution, METRIC metric);
+void peepholeSolution(const Move* solution, size_t count, METRIC metric, MoveBuffer& result);
+
+#endif
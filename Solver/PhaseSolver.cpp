@@ -0,0 +1,146 @@
+#include "PhaseSolver.h"
+
+typedef Move::PIECES PIECES;
+typedef Move::TYPE TYPE;
+
+/**
+ * The cube rotation each wide turn, slice and rotation turns the centers
+ * by, and whether it's the rotation's inverse, indexed by Move::PIECES
+ * from FRONT_WIDE. A wide turn turns them with its face, and a slice
+ * with the face it follows (M follows L, E follows D, S follows F).
+ */
+const PIECES centerRotations[12] = { PIECES::Z, PIECES::Z, PIECES::Y, PIECES::Y, PIECES::X, PIECES::X, PIECES::X,
+	PIECES::Y, PIECES::Z, PIECES::X, PIECES::Y, PIECES::Z };
+const bool centerRotationInverted[12] = { false, true, false, true, false, true, true, true, false, false, false,
+	false };
+
+/**
+ * The cube rotation the given move turns the centers by, which is an
+ * empty move for outer face turns.
+ */
+Move centerRotation(const Move& move)
+{
+	if (move.pieces < PIECES::FRONT_WIDE || move.type == TYPE::NO_MOVE)
+		return Move();
+	uint8_t index = (uint8_t)move.pieces - (uint8_t)PIECES::FRONT_WIDE;
+	TYPE type = move.type;
+	if (centerRotationInverted[index] && type != TYPE::DOUBLE)
+		type = type == TYPE::NORMAL ? TYPE::PRIME : TYPE::NORMAL;
+	return Move(centerRotations[index], type);
+}
+
+/**
+ * Start solving the given cube, finding the robot's substitutions up
+ * front.
+ */
+PhaseSolver::PhaseSolver(const Cube& cube, const SolveOptions& options) :
+	cube(cube), options(options), robot(!options.restriction.isDefault() || options.minimizeTime), numDone(0),
+	failed(false)
+{
+	if (robot)
+	{
+		substitutions = findSubstitutions(options.restriction);
+		failed = !substitutions.complete;
+	}
+}
+
+/**
+ * Solve the next phase and clean its moves.
+ *
+ * Written without rotations, a phase leaves the cube turned differently
+ * from how the solver's moves expect it (its rotations, wide turns and
+ * slices all turn the centers). So those phases are optimized after the
+ * rotations the earlier phases turned the centers by, which rewrites
+ * their moves for the cube as it's really turned.
+ */
+bool PhaseSolver::next(PhaseMoves& phase)
+{
+	if (numDone == MAX_PHASES || failed)
+		return false;
+	if (isCancelled(options))
+	{
+		failed = true;
+		return false;
+	}
+
+	MoveBuffer steps;
+	phase.llCase = { NO_CASE, 0, 0 };
+	if (numDone == 0)
+	{
+		phase.phase = PHASE::CROSS;
+		solveCross(cube, steps);
+	}
+	else if (numDone <= 4)
+	{
+		phase.phase = PHASE::F2L;
+		solveNextF2LPair(cube, steps);
+	}
+	else if (numDone == 5)
+	{
+		phase.phase = PHASE::OLL;
+		phase.llCase = solveOLL(cube, steps);
+	}
+	else
+	{
+		phase.phase = PHASE::PLL;
+		phase.llCase = solvePLL(cube, steps);
+	}
+	numDone++;
+
+	bool optimize = robot || (options.optimize && !options.fast);
+	MOVE_SET moveSet = robot ? MOVE_SET::FACE_TURNS : options.moveSet;
+	METRIC metric = robot ? robotMetric(options, substitutions) : options.metric;
+	if (!optimize || moveSet == MOVE_SET::ANY)
+		cleanSolution(steps.data(), steps.size(), optimize, metric, moveSet, phase.moves);
+	else
+	{
+		MoveBuffer turned = frame;
+		for (const Move& move : steps)
+		{
+			turned.push_back(move);
+			Move rotation = centerRotation(move);
+			if (rotation.type != TYPE::NO_MOVE)
+				frame.push_back(rotation);
+		}
+		cleanSolution(turned.data(), turned.size(), true, metric, moveSet, phase.moves);
+		failed = turned.overflow() || frame.overflow();
+	}
+
+	if (robot)
+	{
+		std::vector<Move> restricted = restrictSolution(std::vector<Move>(phase.moves.begin(), phase.moves.end()),
+			options.restriction, substitutions);
+		phase.moves.clear();
+		for (const Move& move : restricted)
+			phase.moves.push_back(move);
+	}
+
+	failed = failed || steps.overflow() || phase.moves.overflow() || (numDone == MAX_PHASES && !cube.isSolved());
+	return !failed;
+}
+
+/**
+ * Solve the given cube a phase at a time, passing each phase to the
+ * given callback.
+ */
+bool solveByPhase(const Cube& cube, const SolveOptions& options, PhaseCallback callback, void* context)
+{
+	PhaseSolver solver(cube, options);
+	PhaseMoves phase;
+	while (solver.next(phase))
+		callback(phase, context);
+	return solver.solved();
+}
+
+#ifdef SOLVER_COROUTINES
+/**
+ * Solve the given cube a phase at a time, yielding each phase.
+ */
+PhaseGenerator solvePhases(Cube cube, SolveOptions options)
+{
+	PhaseSolver solver(cube, options);
+	PhaseMoves phase;
+	while (solver.next(phase))
+		co_yield phase;
+}
+#endif
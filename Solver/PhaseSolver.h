@@ -0,0 +1,149 @@
+#ifndef PHASE_SOLVER_H
+#define PHASE_SOLVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Solver.h"
+
+#ifdef SOLVER_COROUTINES
+#include <coroutine>
+#include <exception>
+#endif
+
+/**
+ * The moves of one phase of a solve, and for OLL and PLL, the case that
+ * was recognized (NO_CASE for the other phases, or a skipped step).
+ */
+struct PhaseMoves
+{
+	PHASE phase;
+	MoveBuffer moves;
+	LastLayerCase llCase;
+};
+
+class PhaseSolver
+{
+	/**
+	 * This class solves a cube one phase at a time: the cross, each F2L
+	 * pair, OLL and PLL. Each phase's moves are ready as soon as that
+	 * phase is solved, so a robot can start performing them while the
+	 * next phase is found.
+	 *
+	 * Each phase is cleaned (and optimized, unless that's turned off) by
+	 * itself, since the moves before it may be performed already, so the
+	 * whole solution is a few moves longer than solve() would give. A
+	 * robot's phases (with a restriction, or minimizing time) are made
+	 * of allowed outer face turns, from the cube's own orientation only,
+	 * as in a fast solve. A budget is ignored.
+	 */
+
+public:
+	/**
+	 * Start solving the given cube with the given options. The cancel
+	 * flag (if there is one) is checked before each phase.
+	 */
+	PhaseSolver(const Cube& cube, const SolveOptions& options);
+
+	/**
+	 * Solve the next phase, writing its moves into the given phase.
+	 * Every solve has all seven phases, even when some are done already
+	 * (their moves are empty). Return false once they're all done, or if
+	 * the solve failed or was cancelled.
+	 */
+	bool next(PhaseMoves& phase);
+
+	/**
+	 * Whether every phase is done and the cube was solved.
+	 */
+	bool solved() const { return numDone == MAX_PHASES && !failed; }
+
+private:
+	Cube cube;
+	SolveOptions options;
+	MoveSubstitutions substitutions;
+	bool robot;
+	uint8_t numDone;
+	bool failed;
+
+	// rotations the phases so far were written without, which later phases start from
+	MoveBuffer frame;
+};
+
+/**
+ * Called with each phase of a solve as soon as it's found.
+ */
+typedef void (*PhaseCallback)(const PhaseMoves& phase, void* context);
+
+/**
+ * Solve the given cube a phase at a time (see PhaseSolver), calling the
+ * given callback with each phase from the calling thread as soon as it's
+ * found. Return false if the cube wasn't solved.
+ */
+bool solveByPhase(const Cube& cube, const SolveOptions& options, PhaseCallback callback, void* context);
+
+#ifdef SOLVER_COROUTINES
+class PhaseGenerator
+{
+	/**
+	 * This class is a coroutine that yields each phase of a solve as
+	 * it's found (see solvePhases). Only built with C++20, when
+	 * SOLVER_COROUTINES is defined.
+	 */
+
+public:
+	struct promise_type
+	{
+		const PhaseMoves* current = nullptr;
+
+		PhaseGenerator get_return_object()
+		{
+			return PhaseGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		std::suspend_always yield_value(const PhaseMoves& phase)
+		{
+			current = &phase;
+			return {};
+		}
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	PhaseGenerator(PhaseGenerator&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+	~PhaseGenerator()
+	{
+		if (handle)
+			handle.destroy();
+	}
+
+	/**
+	 * Solve until the next phase is found, returning false once the
+	 * solve is over. The phase stays valid until next is called again.
+	 */
+	bool next()
+	{
+		handle.resume();
+		return !handle.done();
+	}
+	const PhaseMoves& phase() const { return *handle.promise().current; }
+
+private:
+	PhaseGenerator(const PhaseGenerator&);
+	PhaseGenerator& operator=(const PhaseGenerator&);
+
+	explicit PhaseGenerator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * Solve the given cube a phase at a time (see PhaseSolver), yielding
+ * each phase as it's found. The cube and options are copied into the
+ * coroutine, so they needn't outlive the call.
+ */
+PhaseGenerator solvePhases(Cube cube, SolveOptions options);
+#endif
+
+#endif
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+#include "Pipeline.h"
+
+/**
+ * Number of cubes passed between stages at once, enough that the
+ * queues are touched a few thousand times a second at most.
+ */
+const size_t PIPELINE_BLOCK_SIZE = 256;
+
+/**
+ * A block of cubes and their solutions. Blocks are made once and passed
+ * around the pipeline, so each solution's moves keep their memory from
+ * one block to the next.
+ */
+struct PipelineBlock
+{
+	size_t first;
+	size_t count;
+	Cube cubes[PIPELINE_BLOCK_SIZE];
+	bool valid[PIPELINE_BLOCK_SIZE];
+	Solution solutions[PIPELINE_BLOCK_SIZE];
+};
+
+/**
+ * Write the results of the given block to the given bytes, in the given
+ * format.
+ */
+void writeBlock(const PipelineBlock& block, BATCH_FORMAT format, std::vector<uint8_t>& bytes, std::string& line)
+{
+	for (size_t i = 0; i < block.count; i++)
+	{
+		if (format == BATCH_FORMAT::BINARY)
+		{
+			packSolution(block.solutions[i], bytes);
+			continue;
+		}
+		formatResult(block.first + i + 1, block.solutions[i], block.valid[i] ? nullptr : "state can't be solved",
+			format, line);
+		bytes.insert(bytes.end(), line.begin(), line.end());
+	}
+}
+
+/**
+ * Solve every cube in the given corpus, writing the results in order.
+ *
+ * Blocks cycle from a free queue to the reader, the solvers, the writer
+ * and back, so there are never more than a few per thread. Solvers
+ * finish blocks out of order, so the writer holds on to any that are
+ * early. A null block tells each solver to stop.
+ */
+BatchStats solveCorpus(const Corpus& corpus, FILE* output, const SolveOptions& options, BATCH_FORMAT format,
+	size_t numThreads, Checkpointer* checkpointer)
+{
+	const size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (numThreads == 0)
+		numThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+	Checkpoint checkpoint;
+	if (checkpointer != nullptr)
+		checkpoint = checkpointer->start();
+	size_t first = (size_t)std::min<uint64_t>(checkpoint.inputOffset, corpus.size());
+	size_t numBlocks = (corpus.size() - first + PIPELINE_BLOCK_SIZE - 1) / PIPELINE_BLOCK_SIZE;
+
+	size_t poolSize = numThreads * 2 + 2;
+	std::unique_ptr<PipelineBlock[]> blocks(new PipelineBlock[poolSize]);
+	BoundedQueue<PipelineBlock*> freeBlocks(poolSize);
+	BoundedQueue<PipelineBlock*> toSolve(poolSize + numThreads);
+	BoundedQueue<PipelineBlock*> toWrite(poolSize);
+	for (size_t i = 0; i < poolSize; i++)
+		freeBlocks.push(&blocks[i]);
+
+	std::thread reader([&]() {
+		for (size_t b = 0; b < numBlocks; b++)
+		{
+			PipelineBlock* block = freeBlocks.pop();
+			block->first = first + b * PIPELINE_BLOCK_SIZE;
+			block->count = std::min(PIPELINE_BLOCK_SIZE, corpus.size() - block->first);
+			for (size_t i = 0; i < block->count; i++)
+				block->valid[i] = corpus.cube(block->first + i, block->cubes[i]) && block->cubes[i].isSolvable();
+			toSolve.push(block);
+		}
+		for (size_t t = 0; t < numThreads; t++)
+			toSolve.push(nullptr);
+	});
+
+	std::vector<std::thread> solvers;
+	for (size_t t = 0; t < numThreads; t++)
+	{
+		solvers.emplace_back([&]() {
+			for (PipelineBlock* block = toSolve.pop(); block != nullptr; block = toSolve.pop())
+			{
+				for (size_t i = 0; i < block->count; i++)
+				{
+					if (block->valid[i])
+						block->solutions[i] = solve(block->cubes[i], options);
+					else
+						block->solutions[i] = Solution();
+				}
+				toWrite.push(block);
+			}
+		});
+	}
+
+	std::vector<uint8_t> bytes;
+	bytes.reserve(OUTPUT_BUFFER_SIZE + PIPELINE_BLOCK_SIZE * 1024);
+	// a resumed binary output already has its header
+	if (format == BATCH_FORMAT::BINARY && first == 0)
+	{
+		bytes.insert(bytes.end(), BATCH_MAGIC, BATCH_MAGIC + sizeof(BATCH_MAGIC));
+		uint8_t count[MAX_VARINT_BYTES];
+		bytes.insert(bytes.end(), count, count + writeVarint(corpus.size(), count));
+	}
+	std::string line;
+	std::vector<PipelineBlock*> early;
+	for (size_t next = 0; next < numBlocks;)
+	{
+		PipelineBlock* block = toWrite.pop();
+		early.push_back(block);
+		// write every block that's now next in line
+		for (size_t i = 0; i < early.size();)
+		{
+			if (early[i]->first != first + next * PIPELINE_BLOCK_SIZE)
+			{
+				i++;
+				continue;
+			}
+			writeBlock(*early[i], format, bytes, line);
+			freeBlocks.push(early[i]);
+			early.erase(early.begin() + i);
+			next++;
+			i = 0;
+		}
+		bool checkpointDue = checkpointer != nullptr && checkpointer->due();
+		if (bytes.size() >= OUTPUT_BUFFER_SIZE || checkpointDue)
+		{
+			fwrite(bytes.data(), 1, bytes.size(), output);
+			bytes.clear();
+		}
+		if (checkpointDue)
+		{
+			checkpoint.inputOffset = std::min(first + next * PIPELINE_BLOCK_SIZE, corpus.size());
+			checkpoint.lineNumber = checkpoint.count = checkpoint.inputOffset;
+			checkpointer->save(output, checkpoint);
+		}
+	}
+	fwrite(bytes.data(), 1, bytes.size(), output);
+	fflush(output);
+	if (checkpointer != nullptr)
+	{
+		checkpoint.inputOffset = checkpoint.lineNumber = checkpoint.count = corpus.size();
+		checkpointer->save(output, checkpoint);
+	}
+
+	reader.join();
+	for (std::thread& solver : solvers)
+		solver.join();
+
+	BatchStats stats;
+	stats.count = corpus.size() - first;
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stats.solvesPerSecond = stats.seconds > 0 ? stats.count / stats.seconds : 0;
+	return stats;
+}
@@ -0,0 +1,35 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "Batch.h"
+#include "Checkpoint.h"
+#include "Corpus.h"
+#include "Solver.h"
+
+/**
+ * Solve every cube in the given corpus with the given options, writing
+ * the results to the given output in the given format, in the same
+ * order as the corpus. The binary format is the batch wire format (see
+ * packBatch), and a cube that can't be solved gets an unsolved solution
+ * with no moves.
+ *
+ * The work runs as a pipeline of three stages: a reader thread unpacks
+ * blocks of cubes from the corpus, the given number of solver threads
+ * (zero uses one per hardware thread) solve them, and the calling
+ * thread writes each block's results once the blocks before it are
+ * written. Stages pass blocks through bounded lock-free queues, so a
+ * stage that gets ahead waits for the others rather than piling up
+ * blocks.
+ *
+ * With a checkpointer, solving starts from the cube its start's input
+ * offset gives, the output must already be opened from it (see
+ * openCheckpointedOutput), and the writer saves a checkpoint after
+ * flushing its output as often as it allows, and once more at the end.
+ */
+BatchStats solveCorpus(const Corpus& corpus, FILE* output, const SolveOptions& options, BATCH_FORMAT format,
+	size_t numThreads = 0, Checkpointer* checkpointer = nullptr);
+
+#endif
@@ -0,0 +1,261 @@
+#include "Cube.h"
+#include "Restriction.h"
+
+typedef Move::PIECES PIECES;
+typedef Move::TYPE TYPE;
+
+/**
+ * Clockwise quarter turns in each move type, and the type for each
+ * number of quarter turns (mod 4).
+ */
+const uint8_t restrictedAmounts[3] = { 1, 3, 2 };
+const TYPE restrictedTypes[4] = { TYPE::NO_MOVE, TYPE::NORMAL, TYPE::DOUBLE, TYPE::PRIME };
+
+/**
+ * Cost given to moves that can't be made.
+ */
+const float UNREACHABLE = 1e30f;
+
+/**
+ * Build a move mask allowing each of the given outer face turns.
+ */
+uint32_t faceMoveMask(const std::vector<Move>& moves)
+{
+	uint32_t mask = 0;
+	for (const Move& move : moves)
+	{
+		if (move.pieces <= PIECES::LEFT && move.type != TYPE::NO_MOVE)
+			mask |= (uint32_t)1 << faceMoveIndex(move);
+	}
+	return mask;
+}
+
+/**
+ * Allow every move, each costing 1.
+ */
+MoveRestriction::MoveRestriction() : allowed(ALL_FACE_MOVES)
+{
+	for (uint8_t i = 0; i < NUM_FACE_MOVES; i++)
+		costs[i] = 1;
+}
+
+/**
+ * Check if this allows every move, each costing 1.
+ */
+bool MoveRestriction::isDefault() const
+{
+	if (allowed != ALL_FACE_MOVES)
+		return false;
+	for (uint8_t i = 0; i < NUM_FACE_MOVES; i++)
+	{
+		if (costs[i] != 1)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Find the cheapest way to turn the given face by the given number of
+ * quarter turns, using up to three allowed turns of that face alone.
+ */
+void substituteFaceTurn(const MoveRestriction& restriction, PIECES face, uint8_t amount,
+	std::vector<Move>& moves, float& cost)
+{
+	moves.clear();
+	cost = UNREACHABLE;
+
+	// costs of each allowed turn of this face, by quarter turns
+	float turnCosts[4] = { UNREACHABLE, UNREACHABLE, UNREACHABLE, UNREACHABLE };
+	for (uint8_t type = 0; type < 3; type++)
+	{
+		Move move(face, (TYPE)type);
+		if (restriction.isAllowed(move))
+			turnCosts[restrictedAmounts[type]] = restriction.cost(move);
+	}
+
+	// one, two or three turns, as quarter turn amounts (0 is unused)
+	for (uint8_t a = 1; a < 4; a++)
+	{
+		for (uint8_t b = 0; b < 4; b++)
+		{
+			for (uint8_t c = 0; c < 4; c++)
+			{
+				if ((b == 0 && c != 0) || ((a + b + c) & 3) != amount)
+					continue;
+				float total = turnCosts[a] + (b ? turnCosts[b] : 0) + (c ? turnCosts[c] : 0);
+				if (total >= cost || total >= UNREACHABLE)
+					continue;
+
+				cost = total;
+				moves.clear();
+				for (uint8_t turn : { a, b, c })
+				{
+					if (turn != 0)
+						moves.push_back(Move(face, restrictedTypes[turn]));
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Find the cheapest sequence of allowed moves for each outer face turn.
+ *
+ * Turns are first made from other turns of the same face (U' as U U U).
+ * A face that can't be turned that way is turned by conjugating its
+ * opposite face with a sequence that swaps the two layers, like
+ * B = (U D' R2 L2 U D') F (D U' L2 R2 D U'), using the cheapest of the
+ * four such sequences made from the other two axes.
+ */
+MoveSubstitutions findSubstitutions(const MoveRestriction& restriction)
+{
+	MoveSubstitutions substitutions;
+	for (uint8_t face = 0; face < 6; face++)
+	{
+		for (uint8_t type = 0; type < 3; type++)
+		{
+			uint8_t i = face * 3 + type;
+			substituteFaceTurn(restriction, (PIECES)face, restrictedAmounts[type], substitutions.moves[i],
+				substitutions.costs[i]);
+		}
+	}
+
+	substitutions.complete = true;
+	for (uint8_t face = 0; face < 6; face++)
+	{
+		for (uint8_t type = 0; type < 3; type++)
+		{
+			uint8_t i = face * 3 + type;
+			if (substitutions.costs[i] < UNREACHABLE)
+				continue;
+
+			Move target((PIECES)face, (TYPE)type);
+			Cube targetCube;
+			targetCube.executeMove(target);
+
+			// faces come in opposite pairs, in Move::PIECES order
+			uint8_t opposite = face ^ 1;
+			uint8_t axis = face / 2;
+			std::vector<Move> best;
+			float bestCost = UNREACHABLE;
+			for (uint8_t outer = 0; outer < 3; outer++)
+			{
+				if (outer == axis)
+					continue;
+				uint8_t inner = 3 - axis - outer;
+				for (uint8_t sign = 0; sign < 2; sign++)
+				{
+					// the layer swap, e.g. U D' R2 L2 U D'
+					TYPE first = sign ? TYPE::PRIME : TYPE::NORMAL;
+					TYPE second = sign ? TYPE::NORMAL : TYPE::PRIME;
+					Move swap[6] = {
+						Move((PIECES)(outer * 2), first), Move((PIECES)(outer * 2 + 1), second),
+						Move((PIECES)(inner * 2), TYPE::DOUBLE), Move((PIECES)(inner * 2 + 1), TYPE::DOUBLE),
+						Move((PIECES)(outer * 2), first), Move((PIECES)(outer * 2 + 1), second)
+					};
+
+					// swap, turn the opposite face, swap back
+					std::vector<Move> moves;
+					float cost = 0;
+					for (uint8_t m = 0; m < 13; m++)
+					{
+						Move move = m < 6 ? swap[m] : Move((PIECES)opposite, (TYPE)type);
+						if (m > 6)
+						{
+							move = swap[12 - m];
+							move.type = restrictedTypes[(4 - restrictedAmounts[(uint8_t)move.type]) & 3];
+						}
+						uint8_t j = faceMoveIndex(move);
+						cost += substitutions.costs[j];
+						moves.insert(moves.end(), substitutions.moves[j].begin(), substitutions.moves[j].end());
+					}
+					if (cost >= bestCost)
+						continue;
+
+					Cube cube;
+					cube.executeMoves(moves);
+					if (cube == targetCube)
+					{
+						best.swap(moves);
+						bestCost = cost;
+					}
+				}
+			}
+
+			substitutions.moves[i].swap(best);
+			substitutions.costs[i] = bestCost;
+			if (bestCost >= UNREACHABLE)
+				substitutions.complete = false;
+		}
+	}
+	return substitutions;
+}
+
+/**
+ * Add the given allowed move to the end of the restricted solution,
+ * merging it with the last turn of the same face (even if a turn of
+ * the opposite face is in between, since they commute) if that's
+ * allowed and no more expensive.
+ */
+void pushRestrictedMove(std::vector<Move>& solution, const Move& move, const MoveRestriction& restriction)
+{
+	size_t n = solution.size();
+	size_t target = n;
+	if (n > 0 && solution[n - 1].pieces == move.pieces)
+		target = n - 1;
+	else if (n > 1 && ((uint8_t)solution[n - 1].pieces ^ 1) == (uint8_t)move.pieces && solution[n - 2].pieces == move.pieces)
+		target = n - 2;
+
+	if (target < n)
+	{
+		uint8_t amount = (restrictedAmounts[(uint8_t)solution[target].type] + restrictedAmounts[(uint8_t)move.type]) & 3;
+		if (amount == 0)
+		{
+			solution.erase(solution.begin() + target);
+			return;
+		}
+		Move merged(move.pieces, restrictedTypes[amount]);
+		if (restriction.isAllowed(merged) && restriction.cost(merged) <= restriction.cost(solution[target]) + restriction.cost(move))
+		{
+			solution[target] = merged;
+			return;
+		}
+	}
+	solution.push_back(move);
+}
+
+/**
+ * Rewrite the given solution of outer face turns using only allowed
+ * moves, cancelling and merging moves where that makes it cheaper.
+ *
+ * Anything other than an outer face turn is dropped, so the solution
+ * should already be written in face turns only.
+ */
+std::vector<Move> restrictSolution(const std::vector<Move>& solution, const MoveRestriction& restriction,
+	const MoveSubstitutions& substitutions)
+{
+	std::vector<Move> restricted;
+	restricted.reserve(solution.size() * 2);
+	for (const Move& move : solution)
+	{
+		if (move.pieces > PIECES::LEFT || move.type == TYPE::NO_MOVE)
+			continue;
+		for (const Move& substitute : substitutions.moves[faceMoveIndex(move)])
+			pushRestrictedMove(restricted, substitute, restriction);
+	}
+	return restricted;
+}
+
+/**
+ * Total cost of the given solution of outer face turns.
+ */
+float solutionCost(const std::vector<Move>& solution, const MoveRestriction& restriction)
+{
+	float cost = 0;
+	for (const Move& move : solution)
+	{
+		if (move.pieces <= PIECES::LEFT && move.type != TYPE::NO_MOVE)
+			cost += restriction.cost(move);
+	}
+	return cost;
+}
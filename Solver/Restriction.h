@@ -0,0 +1,85 @@
+#ifndef RESTRICTION_H
+#define RESTRICTION_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "Move.h"
+
+/**
+ * Number of outer face turns (6 faces, 3 types each).
+ *
+ * Move masks and cost vectors are indexed by face * 3 + type,
+ * using the Move::PIECES and Move::TYPE values.
+ */
+const uint8_t NUM_FACE_MOVES = 18;
+const uint32_t ALL_FACE_MOVES = ((uint32_t)1 << NUM_FACE_MOVES) - 1;
+
+/**
+ * Index of the given outer face turn in move masks and cost vectors.
+ */
+inline uint8_t faceMoveIndex(const Move& move) { return move.code(); }
+
+/**
+ * Build a move mask allowing each of the given outer face turns.
+ */
+uint32_t faceMoveMask(const std::vector<Move>& moves);
+
+/**
+ * The outer face turns a solution may use, and what each one costs
+ * (for example, how long it takes a robot to perform).
+ */
+struct MoveRestriction
+{
+	/**
+	 * Bit faceMoveIndex(move) is set if the move is allowed.
+	 */
+	uint32_t allowed;
+	float costs[NUM_FACE_MOVES];
+
+	/**
+	 * Allow every move, each costing 1.
+	 */
+	MoveRestriction();
+
+	/**
+	 * Check if this allows every move, each costing 1.
+	 */
+	bool isDefault() const;
+
+	bool isAllowed(const Move& move) const { return (allowed >> faceMoveIndex(move)) & 1; }
+	float cost(const Move& move) const { return costs[faceMoveIndex(move)]; }
+};
+
+/**
+ * The cheapest sequence of allowed moves found for each outer face turn.
+ *
+ * Complete is false if some turn couldn't be made from the allowed
+ * moves, which happens when both faces on an axis are missing half or
+ * all of their turns.
+ */
+struct MoveSubstitutions
+{
+	std::vector<Move> moves[NUM_FACE_MOVES];
+	float costs[NUM_FACE_MOVES];
+	bool complete;
+};
+
+/**
+ * Find the cheapest sequence of allowed moves for each outer face turn.
+ */
+MoveSubstitutions findSubstitutions(const MoveRestriction& restriction);
+
+/**
+ * Rewrite the given solution of outer face turns using only allowed
+ * moves, cancelling and merging moves where that makes it cheaper.
+ */
+std::vector<Move> restrictSolution(const std::vector<Move>& solution, const MoveRestriction& restriction,
+	const MoveSubstitutions& substitutions);
+
+/**
+ * Total cost of the given solution of outer face turns.
+ */
+float solutionCost(const std::vector<Move>& solution, const MoveRestriction& restriction);
+
+#endif
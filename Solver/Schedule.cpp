@@ -0,0 +1,118 @@
+#include "Cube.h"
+#include "Optimizer.h"
+#include "Schedule.h"
+
+typedef Move::PIECES PIECES;
+typedef Move::TYPE TYPE;
+
+/**
+ * Check if the given solution is made of outer face turns only.
+ */
+bool isFaceTurns(const std::vector<Move>& solution)
+{
+	for (const Move& move : solution)
+	{
+		if (move.pieces > PIECES::LEFT || move.type == TYPE::NO_MOVE)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Number of moves in the step starting at the given move: two if the
+ * next move turns the opposite face, which the robot can turn at the
+ * same time since they commute, otherwise one.
+ */
+uint8_t stepLength(const std::vector<Move>& moves, size_t i)
+{
+	if (i + 1 < moves.size() && ((uint8_t)moves[i].pieces ^ 1) == (uint8_t)moves[i + 1].pieces)
+		return 2;
+	return 1;
+}
+
+/**
+ * Duration of the step starting at the given move, with the given
+ * number of moves.
+ */
+uint32_t stepDuration(const std::vector<Move>& moves, size_t i, uint8_t length, const RobotTiming& timing)
+{
+	uint32_t duration = timing.duration(moves[i]);
+	if (length == 2 && timing.duration(moves[i + 1]) > duration)
+		duration = timing.duration(moves[i + 1]);
+	return duration;
+}
+
+/**
+ * Schedule the given solution for a robot with the given timing.
+ *
+ * Consecutive turns of opposite faces (R L', U2 D) become a single step,
+ * taking as long as the slower of the two. Each step starts once the one
+ * before it has finished and settled. The solution is first rewritten in
+ * outer face turns if it has wide turns, slices or rotations in it
+ * (which always leaves opposite face turns next to each other). That
+ * drops any rotation they add up to, so the solution isn't scheduled
+ * unless the rewritten one leaves the cube in the same state.
+ */
+Schedule scheduleSolution(const std::vector<Move>& solution, const RobotTiming& timing)
+{
+	Schedule schedule;
+	schedule.time = 0;
+	schedule.valid = true;
+
+	bool faceOnly = isFaceTurns(solution);
+	std::vector<Move> faceTurns;
+	if (!faceOnly)
+	{
+		faceTurns = optimizeSolution(solution, METRIC::HTM, MOVE_SET::FACE_TURNS);
+		Cube original, rewritten;
+		original.executeMoves(solution);
+		rewritten.executeMoves(faceTurns);
+		if (!(original == rewritten))
+		{
+			schedule.valid = false;
+			return schedule;
+		}
+	}
+	const std::vector<Move>& moves = faceOnly ? solution : faceTurns;
+
+	for (size_t i = 0; i < moves.size();)
+	{
+		uint8_t length = stepLength(moves, i);
+		ScheduleStep step = { { moves[i], moves[i + length - 1] }, length, schedule.time,
+			stepDuration(moves, i, length, timing) };
+		schedule.steps.push_back(step);
+		schedule.time += step.duration + timing.settle;
+		i += length;
+	}
+	return schedule;
+}
+
+/**
+ * Predicted time to perform the given solution, or UINT32_MAX if it
+ * can't be scheduled.
+ */
+uint32_t scheduledTime(const std::vector<Move>& solution, const RobotTiming& timing)
+{
+	Schedule schedule = scheduleSolution(solution, timing);
+	return schedule.valid ? schedule.time : UINT32_MAX;
+}
+
+/**
+ * Return a compact string value of the schedule: each step's start
+ * time and its turns, like "0:R+L' 110:U2 280:F".
+ */
+std::string scheduleToString(const Schedule& schedule)
+{
+	std::string str = "";
+	for (const ScheduleStep& step : schedule.steps)
+	{
+		str += std::to_string(step.start) + ":";
+		for (uint8_t m = 0; m < step.count; m++)
+		{
+			Move move = step.moves[m];
+			str += (m > 0 ? "+" : "") + move.toString();
+		}
+		str += " ";
+	}
+	return str;
+}
@@ -0,0 +1,75 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Move.h"
+
+/**
+ * How long a robot takes to perform each kind of turn, in milliseconds.
+ *
+ * Each step also waits for the settle time after its turns finish,
+ * before the next step starts.
+ */
+struct RobotTiming
+{
+	uint32_t quarterTurn;
+	uint32_t halfTurn;
+	uint32_t settle;
+
+	RobotTiming() : quarterTurn(100), halfTurn(160), settle(10) {}
+	RobotTiming(uint32_t quarter, uint32_t half, uint32_t settleTime) : quarterTurn(quarter), halfTurn(half), settle(settleTime) {}
+
+	/**
+	 * Duration of a single outer face turn.
+	 */
+	uint32_t duration(const Move& move) const { return move.type == Move::TYPE::DOUBLE ? halfTurn : quarterTurn; }
+};
+
+/**
+ * One step of a schedule: one outer face turn, or two turns of
+ * opposite faces performed at the same time.
+ */
+struct ScheduleStep
+{
+	Move moves[2];
+	uint8_t count;
+	uint32_t start;
+	uint32_t duration;
+};
+
+/**
+ * A timed motor schedule, and the predicted time to perform it.
+ *
+ * Valid is false if the solution couldn't be scheduled because it
+ * leaves the cube rotated, which the robot can't do (the schedule is
+ * empty then).
+ */
+struct Schedule
+{
+	std::vector<ScheduleStep> steps;
+	uint32_t time;
+	bool valid;
+};
+
+/**
+ * Schedule the given solution for a robot with the given timing,
+ * turning opposite faces at the same time.
+ */
+Schedule scheduleSolution(const std::vector<Move>& solution, const RobotTiming& timing);
+
+/**
+ * Predicted time to perform the given solution, or UINT32_MAX if it
+ * can't be scheduled.
+ */
+uint32_t scheduledTime(const std::vector<Move>& solution, const RobotTiming& timing);
+
+/**
+ * Return a compact string value of the schedule: each step's start
+ * time and its turns, like "0:R+L' 110:U2 280:F".
+ */
+std::string scheduleToString(const Schedule& schedule);
+
+#endif
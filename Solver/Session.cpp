@@ -0,0 +1,252 @@
+#include <algorithm>
+
+#include "Session.h"
+
+typedef Cube::COLOR COLOR;
+typedef Cube::FACE FACE;
+
+/**
+ * Color of the cross the given solution solved first: the center of the
+ * face whose edges are all solved once its cross phase is done.
+ */
+COLOR SolverSession::findCrossColor(const Cube& scrambled, const Solution& solution)
+{
+	Cube cube = scrambled;
+	for (size_t i = 0; i < solution.phases[0].end; i++)
+		cube.executeMove(solution.move(i));
+	for (uint8_t f = 0; f < 6; f++)
+	{
+		bool cross = true;
+		for (uint8_t idx = 1; idx < 8 && cross; idx += 2)
+			cross = cube.isPieceSolved({ (FACE)f, idx });
+		if (cross)
+			return cube.getCenter((FACE)f);
+	}
+	return cube.getCenter(FACE::DOWN);
+}
+
+/**
+ * The last layer case of the given phase for a solution reused from the
+ * given index of the given one: the same case if its algorithm is still
+ * all to come, none if it's done and the cube is still on the path, and
+ * unknown otherwise.
+ */
+LastLayerCase SolverSession::reusedCase(const Solution& solution, PHASE phase, const LastLayerCase& llCase,
+	size_t anchor, bool drifted)
+{
+	for (uint8_t p = 0; p < solution.numPhases; p++)
+	{
+		const PhaseSpan& span = solution.phases[p];
+		if (span.phase != phase)
+			continue;
+		if (anchor <= span.begin)
+			return llCase;
+		if (anchor >= span.end && !drifted)
+			return { NO_CASE, 0, 0 };
+		break;
+	}
+	return { UNKNOWN_CASE, 0, 0 };
+}
+
+/**
+ * Start a session on a solved cube, which needs no solution.
+ */
+SolverSession::SolverSession(const SolveOptions& options) :
+	options(options), robot(!options.restriction.isDefault() || options.minimizeTime),
+	crossColor(COLOR::EMPTY), anchor(0), lost(true), answered(false), counts({ 0, 0, 0 }) {}
+
+/**
+ * Apply each of the given moves in turn.
+ */
+void SolverSession::apply(const std::string& moves)
+{
+	Cube parser;
+	MoveBuffer parsed;
+	parser.readMoves(moves.c_str(), parsed);
+	for (const Move& move : parsed)
+		apply(move);
+}
+
+/**
+ * Apply the given move, following the cube along the last solution's
+ * path, or counting it as a move off the path.
+ */
+void SolverSession::apply(const Move& move)
+{
+	current.executeMove(move);
+	answered = false;
+	if (lost)
+		return;
+
+	size_t index;
+	if (findOnPath(current, index))
+	{
+		anchor = index;
+		drift.clear();
+	}
+	else if (drift.size() < MAX_SESSION_DRIFT && canUndo(move))
+		drift.push_back(move);
+	else
+		lost = true;
+}
+
+/**
+ * Replace the cube with the given state, and find it on the last
+ * solution's path, or one outer face turn away from it.
+ */
+void SolverSession::setState(const Cube& cube)
+{
+	current = cube;
+	answered = false;
+	drift.clear();
+	lost = path.empty();
+	if (lost || findOnPath(current, anchor))
+		return;
+
+	for (uint8_t code = 0; code < NUM_FACE_CODES; code++)
+	{
+		// the turn that takes the cube back to the path undoes the one that took it off
+		Move undo = Move::fromCode(code);
+		Cube neighbor = current;
+		neighbor.executeMove(undo);
+		if (findOnPath(neighbor, anchor) && canUndo(undo.inverse()))
+		{
+			drift.push_back(undo.inverse());
+			return;
+		}
+	}
+	lost = true;
+}
+
+/**
+ * Solve the cube as it is now, reusing the last solution if the cube is
+ * on its path or close enough to it.
+ */
+const Solution& SolverSession::solve()
+{
+	if (answered)
+		return answer;
+	answered = true;
+	if (lost)
+	{
+		solveFresh();
+		return answer;
+	}
+
+	MoveBuffer joined;
+	for (size_t i = drift.size(); i-- > 0;)
+		joined.push_back(drift[i].inverse());
+	for (size_t i = anchor; i < base.size(); i++)
+		joined.push_back(base.move(i));
+	if (joined.overflow())
+	{
+		solveFresh();
+		return answer;
+	}
+
+	MoveBuffer merged;
+	cleanSolution(joined.data(), joined.size(), false, options.metric, options.moveSet, merged);
+	answer = Solution();
+	answer.setMoves(merged.data(), merged.size());
+	answer.solved = true;
+	if (drift.empty())
+	{
+		// the rest of the solution, whose phases are the rest of its phases
+		answer.numPhases = base.numPhases;
+		for (uint8_t p = 0; p < base.numPhases; p++)
+		{
+			const PhaseSpan& span = base.phases[p];
+			answer.phases[p] = { span.phase, (uint16_t)(std::max<size_t>(span.begin, anchor) - anchor),
+				(uint16_t)(std::max<size_t>(span.end, anchor) - anchor) };
+		}
+	}
+	else
+		findPhases(current, crossColor, answer);
+	answer.oll = reusedCase(base, PHASE::OLL, base.oll, anchor, !drift.empty());
+	answer.pll = reusedCase(base, PHASE::PLL, base.pll, anchor, !drift.empty());
+	if (drift.empty())
+		counts.followed++;
+	else
+		counts.reused++;
+	return answer;
+}
+
+/**
+ * Get the next move of the cube's solution.
+ */
+Move SolverSession::hint()
+{
+	const Solution& solution = solve();
+	return solution.solved && solution.size() > 0 ? solution.move(0) : Move();
+}
+
+/**
+ * Find the given cube on the last solution's path, comparing hashes
+ * before whole states.
+ */
+bool SolverSession::findOnPath(const Cube& cube, size_t& index) const
+{
+	uint64_t hash = cube.hash();
+	for (size_t i = 0; i < pathHashes.size(); i++)
+	{
+		if (pathHashes[i] == hash && path[i] == cube)
+		{
+			index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Check the given move can be undone by its inverse in a solution. A
+ * robot's moves are restricted, and the other move sets can't rotate
+ * the cube back, so only their own moves are undone.
+ */
+bool SolverSession::canUndo(const Move& move) const
+{
+	if (robot)
+		return false;
+	uint8_t code = move.code();
+	switch (options.moveSet)
+	{
+	case MOVE_SET::FACE_TURNS:
+		return code < NUM_FACE_CODES;
+	case MOVE_SET::SLICE_TURNS:
+		return code < NUM_FACE_CODES || move.pieces == Move::PIECES::M_SLICE || move.pieces == Move::PIECES::E_SLICE ||
+			move.pieces == Move::PIECES::S_SLICE;
+	default:
+		return true;
+	}
+}
+
+/**
+ * Solve the cube from scratch, and record the state after each move of
+ * the solution as the new path.
+ */
+void SolverSession::solveFresh()
+{
+	base = ::solve(current, options);
+	answer = base;
+	counts.solves++;
+
+	path.clear();
+	pathHashes.clear();
+	drift.clear();
+	anchor = 0;
+	lost = !base.solved;
+	if (lost)
+		return;
+
+	Cube cube = current;
+	path.reserve(base.size() + 1);
+	pathHashes.reserve(base.size() + 1);
+	for (size_t i = 0; i <= base.size(); i++)
+	{
+		if (i > 0)
+			cube.executeMove(base.move(i - 1));
+		path.push_back(cube);
+		pathHashes.push_back(cube.hash());
+	}
+	crossColor = findCrossColor(current, base);
+}
@@ -0,0 +1,136 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+
+/**
+ * Most moves a session's cube can stray from its last solution before
+ * the next solution is found from scratch rather than by undoing them.
+ */
+const size_t MAX_SESSION_DRIFT = 4;
+
+/**
+ * Counts of how a session answered: solutions found from scratch, ones
+ * that were the rest of the last solution (the moves since followed
+ * it), and ones that undid a few moves and then took the rest of it.
+ */
+struct SessionStats
+{
+	size_t solves;
+	size_t followed;
+	size_t reused;
+};
+
+class SolverSession
+{
+	/**
+	 * This class keeps a cube in sync with an interactive front end,
+	 * which applies moves to it as they're made and asks for a solution
+	 * (or just the next move) whenever it likes.
+	 *
+	 * Each solution found from scratch is kept along with the state
+	 * after each of its moves. While the cube stays on that path (the
+	 * user is following the solution, or went back to it), the answer
+	 * is the rest of the solution, with nothing to solve. A cube a few
+	 * moves off the path is answered by undoing those moves and taking
+	 * the rest of the solution from where they left it, merging the
+	 * moves where the two meet, so it can be a few moves longer than a
+	 * fresh solve would give. Further off than MAX_SESSION_DRIFT, or
+	 * with moves the options' move set or robot can't undo, the cube is
+	 * solved from scratch.
+	 *
+	 * A session isn't safe to use from several threads at once.
+	 */
+
+public:
+	/**
+	 * Start a session on a solved cube, solving with the given options.
+	 */
+	explicit SolverSession(const SolveOptions& options = SolveOptions());
+
+	/**
+	 * Apply the given moves to the cube, or a single move.
+	 */
+	void apply(const std::string& moves);
+	void apply(const Move& move);
+
+	/**
+	 * Replace the cube with the given state, as a front end that only
+	 * sends whole states does. A state one outer face turn away from
+	 * the path of the last solution still reuses it.
+	 */
+	void setState(const Cube& cube);
+
+	/**
+	 * The solution for the cube as it is now, which stays valid until
+	 * the cube changes. Its last layer cases are unknown if the
+	 * algorithm was partly done when it was reused.
+	 */
+	const Solution& solve();
+
+	/**
+	 * The next move of the solution, or an empty move (of type NO_MOVE)
+	 * if the cube is solved or couldn't be.
+	 */
+	Move hint();
+
+	const Cube& cube() const { return current; }
+	const SessionStats& stats() const { return counts; }
+
+private:
+	/**
+	 * Find where the given cube is on the last solution's path, returning
+	 * false if it's not on it.
+	 */
+	bool findOnPath(const Cube& cube, size_t& index) const;
+
+	/**
+	 * Whether the given move can be undone in the options' move set.
+	 */
+	bool canUndo(const Move& move) const;
+
+	/**
+	 * Solve the cube from scratch, starting a new path.
+	 */
+	void solveFresh();
+
+	/**
+	 * Color of the cross the given solution of the given cube solved
+	 * first.
+	 */
+	static Cube::COLOR findCrossColor(const Cube& scrambled, const Solution& solution);
+
+	/**
+	 * The last layer case of the given phase for a solution reused from
+	 * the given index of the given one, whose case for it was the given
+	 * one.
+	 */
+	static LastLayerCase reusedCase(const Solution& solution, PHASE phase, const LastLayerCase& llCase, size_t anchor,
+		bool drifted);
+
+	SolveOptions options;
+	bool robot;
+	Cube current;
+
+	// the last solution found from scratch, and the states along it
+	Solution base;
+	Cube::COLOR crossColor;
+	std::vector<Cube> path;
+	std::vector<uint64_t> pathHashes;
+
+	// where the cube left the path and the moves made since, unless it's too far off to find its way back
+	size_t anchor;
+	MoveBuffer drift;
+	bool lost;
+
+	Solution answer;
+	bool answered;
+	SessionStats counts;
+};
+
+#endif
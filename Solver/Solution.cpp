@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <algorithm>
+
+#include "Solution.h"
+#include "Solver.h"
+#include "SolverOLL.h"
+#include "SolverPLL.h"
+#include "Symmetry.h"
+
+typedef Cube::LOCATION LOCATION;
+typedef Cube::COLOR COLOR;
+typedef Cube::FACE FACE;
+
+/**
+ * The phase of each span, in order.
+ */
+const PHASE phaseOrder[MAX_PHASES] = { PHASE::CROSS, PHASE::F2L, PHASE::F2L, PHASE::F2L, PHASE::F2L, PHASE::OLL, PHASE::PLL };
+
+Solution::Solution() : numPhases(0), oll({ NO_CASE, 0, 0 }), pll({ NO_CASE, 0, 0 }), solved(false) {}
+
+/**
+ * Set the moves of this solution.
+ */
+void Solution::setMoves(const Move* solution, size_t count)
+{
+	moves.resize(count);
+	for (size_t i = 0; i < count; i++)
+		moves[i] = solution[i].code();
+}
+
+/**
+ * Get the moves of this solution as a vector.
+ */
+std::vector<Move> Solution::toMoves() const
+{
+	std::vector<Move> solution;
+	solution.reserve(moves.size());
+	for (uint8_t code : moves)
+		solution.push_back(Move::fromCode(code));
+	return solution;
+}
+
+/**
+ * Find the face with the given center color.
+ */
+FACE findCenter(Cube& cube, COLOR color)
+{
+	for (uint8_t face = 0; face < 6; face++)
+	{
+		if (cube.getCenter((FACE)face) == color)
+			return (FACE)face;
+	}
+	return FACE::DOWN;
+}
+
+/**
+ * Count the F2L pairs solved around the given face: each solved corner
+ * on it, along with the edge between the corner's other two faces.
+ */
+uint8_t countSolvedPairs(Cube& cube, FACE face)
+{
+	uint8_t count = 0;
+	for (uint8_t idx = 0; idx < 8; idx += 2)
+	{
+		if (!cube.isPieceSolved({ face, idx }))
+			continue;
+		std::pair<LOCATION, LOCATION> sides = cube.getAdjacentCorner({ face, idx });
+		for (uint8_t edge = 1; edge < 8; edge += 2)
+		{
+			LOCATION loc = { sides.first.face, edge };
+			if (cube.getAdjacentEdge(loc).face == sides.second.face)
+			{
+				if (cube.isPieceSolved(loc))
+					count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+/**
+ * Check if the phase with the given index is complete, with the cross
+ * on the given face.
+ */
+bool isPhaseDone(Cube& cube, FACE cross, uint8_t phase)
+{
+	for (uint8_t idx = 1; idx < 8; idx += 2)
+	{
+		if (!cube.isPieceSolved({ cross, idx }))
+			return false;
+	}
+	if (phase == 0)
+		return true;
+	uint8_t pairs = countSolvedPairs(cube, cross);
+	if (phaseOrder[phase] == PHASE::F2L)
+		return pairs >= phase;
+	if (pairs < 4)
+		return false;
+	if (phaseOrder[phase] == PHASE::OLL)
+	{
+		FACE top = cube.getOppositeFace(cross);
+		return cube.getFace(top) == (uint64_t)cube.getCenter(top) * 0x0101010101010101;
+	}
+	return cube.isSolved();
+}
+
+/**
+ * Find where each phase of the given solution ends by performing it on
+ * the given scrambled cube, solving the cross in the given color.
+ *
+ * The cross face is looked up by its center before every move, since
+ * rotations and slices move it. PLL takes the rest of the solution,
+ * including any rotations at the end. If the solution doesn't complete
+ * a phase, that phase takes the rest of it and the ones after are empty.
+ */
+void findPhases(const Cube& scrambled, COLOR crossColor, Solution& solution)
+{
+	Cube cube = scrambled;
+	size_t count = solution.size();
+	uint16_t begin = 0;
+	solution.numPhases = 0;
+	for (size_t i = 0; i <= count; i++)
+	{
+		FACE cross = findCenter(cube, crossColor);
+		while (solution.numPhases < MAX_PHASES - 1 && isPhaseDone(cube, cross, solution.numPhases))
+		{
+			solution.phases[solution.numPhases] = { phaseOrder[solution.numPhases], begin, (uint16_t)i };
+			solution.numPhases++;
+			begin = (uint16_t)i;
+		}
+		if (solution.numPhases == MAX_PHASES - 1 || i == count)
+			break;
+		cube.executeMove(solution.move(i));
+	}
+	while (solution.numPhases < MAX_PHASES)
+	{
+		solution.phases[solution.numPhases] = { phaseOrder[solution.numPhases], begin, (uint16_t)count };
+		solution.numPhases++;
+		begin = (uint16_t)count;
+	}
+}
+
+/**
+ * Replace the given solution with its conjugate under the given symmetry.
+ *
+ * Each move maps to a single move, so the phase spans still hold, and
+ * rotating the cube doesn't change its last layer cases. A reflection
+ * does, to the mirror image of each case, so their ids become unknown
+ * and their turns of the up face are reversed.
+ */
+void conjugateSolution(Solution& solution, uint8_t symmetry, bool inverse)
+{
+	for (uint8_t& code : solution.moves)
+		code = inverse ? inverseConjugateMoveCode(symmetry, code) : conjugateMoveCode(symmetry, code);
+	if (symmetry < NUM_ROTATIONS)
+		return;
+	for (LastLayerCase* llCase : { &solution.oll, &solution.pll })
+	{
+		if (llCase->id == NO_CASE)
+			continue;
+		llCase->id = UNKNOWN_CASE;
+		llCase->preAUF = (4 - llCase->preAUF) & 3;
+		llCase->postAUF = (4 - llCase->postAUF) & 3;
+	}
+}
+
+/**
+ * Name of the phase with the given index, with the pair's number for
+ * F2L pairs.
+ */
+std::string phaseToString(const Solution& solution, uint8_t phase)
+{
+	switch (solution.phases[phase].phase)
+	{
+	case PHASE::CROSS:
+		return "Cross";
+	case PHASE::F2L:
+	{
+		uint8_t pair = 1;
+		for (uint8_t i = 0; i < phase; i++)
+			pair += solution.phases[i].phase == PHASE::F2L;
+		return "F2L " + std::to_string(pair);
+	}
+	case PHASE::OLL:
+		return "OLL";
+	case PHASE::PLL:
+		return "PLL";
+	}
+	return "";
+}
+
+/**
+ * Name of the given last layer case, or "skip" if there wasn't one.
+ */
+std::string caseToString(PHASE phase, const LastLayerCase& llCase)
+{
+	if (llCase.id == NO_CASE)
+		return "skip";
+	if (llCase.id == UNKNOWN_CASE)
+		return "unknown";
+	if (phase == PHASE::OLL && llCase.id < NUM_OLLS)
+		return ollNames[llCase.id];
+	if (phase == PHASE::PLL && llCase.id < NUM_PLLS)
+		return pllNames[llCase.id];
+	return "";
+}
+
+/**
+ * Print the given solution, with each phase on its own line (along
+ * with its case for the last layer).
+ */
+void printSolution(const Solution& solution)
+{
+	for (uint8_t i = 0; i < solution.numPhases; i++)
+	{
+		const PhaseSpan& span = solution.phases[i];
+		printf("%s", phaseToString(solution, i).c_str());
+		if (span.phase == PHASE::OLL)
+			printf(" (%s)", caseToString(span.phase, solution.oll).c_str());
+		else if (span.phase == PHASE::PLL)
+			printf(" (%s)", caseToString(span.phase, solution.pll).c_str());
+		putchar(':');
+		for (uint16_t m = span.begin; m < span.end; m++)
+			printf(" %s", solution.move(m).toString().c_str());
+		putchar('\n');
+	}
+}
+
+/**
+ * Write a string value of the solution's moves into the given buffer,
+ * with a space after each move, without allocating: its moves are
+ * written a few at a time, each run carrying on from where the last
+ * one stopped.
+ */
+size_t solutionToString(const Solution& solution, char* buffer, size_t size)
+{
+	const size_t RUN = 32;
+	Move moves[RUN];
+	size_t length = 0;
+	for (size_t begin = 0; begin < solution.size() || begin == 0; begin += RUN)
+	{
+		size_t count = std::min(RUN, solution.size() - begin);
+		for (size_t i = 0; i < count; i++)
+			moves[i] = solution.move(begin + i);
+		length += solutionToString(moves, count, buffer + std::min(length, size), length < size ? size - length : 0);
+	}
+	return length;
+}
+
+/**
+ * Append the given solution to the given bytes, packed.
+ */
+void packSolution(const Solution& solution, std::vector<uint8_t>& bytes)
+{
+	size_t start = bytes.size();
+	bytes.resize(start + MAX_VARINT_BYTES + packedBytes(solution.moves.data(), solution.size()));
+	size_t written = writeVarint((uint64_t)solution.size() * 2 + solution.solved, bytes.data() + start);
+	written += packMoves(solution.moves.data(), solution.size(), bytes.data() + start + written);
+	bytes.resize(start + written);
+}
+
+/**
+ * Unpack a solution from the given bytes, returning the number of bytes
+ * read, or 0 if they don't hold a valid solution.
+ */
+size_t unpackSolution(const uint8_t* bytes, size_t size, Solution& solution)
+{
+	uint64_t header;
+	size_t read = readVarint(bytes, size, header);
+	// every move takes at least 5 bits
+	if (read == 0 || header / 2 > (size - read) * 8 / PACKED_MOVE_BITS)
+		return 0;
+
+	solution = Solution();
+	solution.solved = header & 1;
+	solution.moves.resize((size_t)(header / 2));
+	size_t packed = unpackMoves(bytes + read, size - read, solution.size(), solution.moves.data());
+	if (packed == 0 && solution.size() > 0)
+		return 0;
+	return read + packed;
+}
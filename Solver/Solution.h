@@ -0,0 +1,138 @@
+#ifndef SOLUTION_H
+#define SOLUTION_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Cube.h"
+#include "Move.h"
+#include "PackedMoves.h"
+
+/**
+ * 8-bit enum for each phase of a solve.
+ */
+enum class PHASE : uint8_t { CROSS, F2L, OLL, PLL };
+
+/**
+ * Most phases in a solution: the cross, four F2L pairs, OLL and PLL.
+ */
+const uint8_t MAX_PHASES = 7;
+
+/**
+ * Case id of a last layer step that was skipped.
+ */
+const uint8_t NO_CASE = 0xff;
+
+/**
+ * Case id of a last layer step whose case isn't known, such as one
+ * that was reflected from a cached solution.
+ */
+const uint8_t UNKNOWN_CASE = 0xfe;
+
+/**
+ * A last layer case the solver recognized: its id (an OLL_CASE or an
+ * index into the PLLs), and the clockwise quarter turns of the up face
+ * made before and after its algorithm.
+ */
+struct LastLayerCase
+{
+	uint8_t id;
+	uint8_t preAUF;
+	uint8_t postAUF;
+};
+
+/**
+ * The moves of one phase, from begin up to (not including) end.
+ */
+struct PhaseSpan
+{
+	PHASE phase;
+	uint16_t begin;
+	uint16_t end;
+};
+
+/**
+ * A solution found by the solver.
+ *
+ * Moves are stored as one byte codes (see Move::code). Each phase's
+ * span ends at the first move that completes it, so spans are exact
+ * even after the solution is optimized across phases. A phase that was
+ * already done has an empty span.
+ *
+ * Solved is false if the cube couldn't be solved with the given options.
+ */
+struct Solution
+{
+	std::vector<uint8_t> moves;
+	PhaseSpan phases[MAX_PHASES];
+	uint8_t numPhases;
+	LastLayerCase oll;
+	LastLayerCase pll;
+	bool solved;
+
+	Solution();
+
+	size_t size() const { return moves.size(); }
+	Move move(size_t i) const { return Move::fromCode(moves[i]); }
+
+	/**
+	 * Set the moves, or get them as a vector.
+	 */
+	void setMoves(const Move* solution, size_t count);
+	std::vector<Move> toMoves() const;
+};
+
+/**
+ * Find where each phase of the given solution ends by performing it on
+ * the given scrambled cube, solving the cross in the given color.
+ */
+void findPhases(const Cube& scrambled, Cube::COLOR crossColor, Solution& solution);
+
+/**
+ * Find the face with the given center color, and count the F2L pairs
+ * solved around the given face.
+ */
+Cube::FACE findCenter(Cube& cube, Cube::COLOR color);
+uint8_t countSolvedPairs(Cube& cube, Cube::FACE face);
+
+/**
+ * Replace the given solution for a cube with the solution for the same
+ * cube with the given symmetry applied to it (see Symmetry.h), or with
+ * the inverse, the solution for the cube the symmetry was applied to.
+ */
+void conjugateSolution(Solution& solution, uint8_t symmetry, bool inverse = false);
+
+/**
+ * Name of a phase, with the pair's number for F2L pairs, and the name
+ * of a last layer case.
+ */
+std::string phaseToString(const Solution& solution, uint8_t phase);
+std::string caseToString(PHASE phase, const LastLayerCase& llCase);
+
+/**
+ * Print the given solution, with each phase on its own line.
+ */
+void printSolution(const Solution& solution);
+
+/**
+ * Write a string value of the solution's moves into the given buffer,
+ * returning its whole length (it's cut short if the buffer is too small).
+ */
+size_t solutionToString(const Solution& solution, char* buffer, size_t size);
+
+/**
+ * Append the given solution to the given bytes, packed: a varint of its
+ * number of moves times two, plus one if it's solved, followed by its
+ * moves packed 5 bits each (see PackedMoves.h). Phases and cases aren't
+ * kept.
+ */
+void packSolution(const Solution& solution, std::vector<uint8_t>& bytes);
+
+/**
+ * Unpack a solution from the given bytes, returning the number of bytes
+ * read, or 0 if they don't hold a valid solution.
+ */
+size_t unpackSolution(const uint8_t* bytes, size_t size, Solution& solution);
+
+#endif
@@ -1,6 +1,10 @@
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
 
+#include "Arena.h"
 #include "Solver.h"
+#include "Symmetry.h"
 
 /**
  * Find which layer the given location is in.
@@ -20,70 +24,116 @@ LAYER getLayer(LOCATION l)
 }
 
 /**
- * Clean the given solution by continually merging
- * adjacent moves until no more merges are possible.
- *
- * Optionally perform an optimized clean where the
- * newline markers are moved from the solution, potentially
- * leading to shorter solution lengths.
+ * Merge adjacent moves on the same pieces, appending the result
+ * to the given moves.
  */
-std::vector<Move> cleanSolution(std::vector<Move>& solution, bool optimized)
+template <typename Moves>
+void mergeMoves(const Move* solution, size_t count, Moves& cleaned)
 {
-	std::vector<Move> cleaned;
-	while (solution.size() > 0)
+	for (size_t i = 0; i < count; i++)
 	{
-		// if cleaned is empty, add first element from solution
-		if (cleaned.size() == 0)
-			cleaned.push_back(solution[0]);
-		// otherwise
+		const Move& move = solution[i];
+		// check if end of cleaned can merge with this move
+		if (cleaned.size() > 0 && cleaned.back().canMergeWith(move))
+		{
+			// replace old end of cleaned with the merged move, unless it cancelled out
+			Move mergedMove = cleaned.back().merge(move);
+			cleaned.pop_back();
+			if (mergedMove.type != Move::TYPE::NO_MOVE)
+				cleaned.push_back(mergedMove);
+		}
 		else
+			cleaned.push_back(move);
+	}
+}
+
+/**
+ * Clean the given solution by merging adjacent moves
+ * on the same pieces, in a single pass.
+ *
+ * Optionally perform an optimized clean where moves
+ * are cancelled across commuting layers and cube rotations,
+ * measuring length in the given metric. Short windows of the
+ * optimized solution are then replaced by optimal sequences,
+ * for as long as that keeps shortening it. The result only
+ * uses moves from the given move set.
+ */
+std::vector<Move> cleanSolution(const std::vector<Move>& solution, bool optimized, METRIC metric, MOVE_SET moveSet)
+{
+	if (optimized)
+	{
+		std::vector<Move> cleaned = optimizeSolution(solution, metric, moveSet);
+		size_t length = countMoves(cleaned, metric);
+		while (true)
 		{
-			// check if end of cleaned can merge with front of solution
-			if (cleaned[cleaned.size() - 1].canMergeWith(solution[0]))
-			{
-				// get merged move
-				Move mergedMove = cleaned[cleaned.size() - 1].merge(solution[0]);
-				// delete old end of cleaned
-				cleaned.erase(cleaned.end() - 1, cleaned.end());
-				// only add to cleaned if merged move is not NO_MOVE
-				if (mergedMove.type != Move::TYPE::NO_MOVE)
-					cleaned.push_back(mergedMove);
-			}
-			// if not, add all moves if unoptimized, or add all non NO_MOVE moves if optimized
-			else if (!optimized || solution[0].type != Move::TYPE::NO_MOVE)
-				cleaned.push_back(solution[0]);
+			std::vector<Move> shortened = optimizeSolution(peepholeSolution(cleaned, metric), metric, moveSet);
+			size_t shortenedLength = countMoves(shortened, metric);
+			if (shortenedLength >= length)
+				break;
+			cleaned.swap(shortened);
+			length = shortenedLength;
 		}
-		// delete old start of solution
-		solution.erase(solution.begin(), solution.begin() + 1);
+		return cleaned;
 	}
+
+	std::vector<Move> cleaned;
+	cleaned.reserve(solution.size());
+	mergeMoves(solution.data(), solution.size(), cleaned);
 	return cleaned;
 }
 
+/**
+ * Clean the given solution the same way, writing it into the given
+ * buffer without allocating. Scratch buffers come from the calling
+ * thread's arena.
+ */
+void cleanSolution(const Move* solution, size_t count, bool optimized, METRIC metric, MOVE_SET moveSet, MoveBuffer& cleaned)
+{
+	cleaned.clear();
+	if (!optimized)
+	{
+		mergeMoves(solution, count, cleaned);
+		return;
+	}
+
+	ArenaScope scope(Arena::local());
+	MoveBuffer* scratch = Arena::local().allocate<MoveBuffer>(2);
+	optimizeSolution(solution, count, metric, moveSet, cleaned);
+	size_t length = countMoves(cleaned.data(), cleaned.size(), metric);
+	while (true)
+	{
+		peepholeSolution(cleaned.data(), cleaned.size(), metric, scratch[0]);
+		optimizeSolution(scratch[0].data(), scratch[0].size(), metric, moveSet, scratch[1]);
+		size_t shortenedLength = countMoves(scratch[1].data(), scratch[1].size(), metric);
+		if (shortenedLength >= length)
+			break;
+		cleaned = scratch[1];
+		length = shortenedLength;
+	}
+}
+
 /**
  * Print the given solution.
  */
-void printSolution(std::vector<Move>& solution)
+void printSolution(const std::vector<Move>& solution)
 {
-	for (auto& move : solution)
+	for (const Move& move : solution)
 	{
 		// don't print moves of type no move
 		if (move.type != Move::TYPE::NO_MOVE)
-			std::cout << move.toString() << " ";
-		// encode pieces = Y and type = no move to mean add a newline
-		else if (move.pieces == Move::PIECES::Y)
-			std::cout << std::endl;
+			printf("%s ", move.toString().c_str());
 	}
-	std::cout << std::endl;
+	putchar('\n');
 }
 
 /**
  * Return a string value of the solution.
  */
-std::string solutionToString(std::vector<Move>& solution)
+std::string solutionToString(const std::vector<Move>& solution)
 {
 	std::string str;
 
-	for (Move& move : solution)
+	for (const Move& move : solution)
 	{
 		// don't add moves of type no move
 		if (move.type != Move::TYPE::NO_MOVE)
@@ -93,18 +143,405 @@ std::string solutionToString(std::vector<Move>& solution)
 	return str;
 }
 
+/**
+ * Write the given solution into the given buffer as a string, with a
+ * space after each move, without allocating.
+ *
+ * Return the length of the whole string, which was cut short if it's
+ * not less than the buffer's size (the buffer is always terminated).
+ */
+size_t solutionToString(const Move* solution, size_t count, char* buffer, size_t size)
+{
+	size_t length = 0;
+	char move[MOVE_CHARS + 1];
+	for (size_t i = 0; i < count; i++)
+	{
+		// don't add moves of type no move
+		if (solution[i].type == Move::TYPE::NO_MOVE)
+			continue;
+		size_t moveLength = solution[i].toChars(move);
+		move[moveLength++] = ' ';
+		for (size_t c = 0; c < moveLength; c++, length++)
+		{
+			if (length + 1 < size)
+				buffer[length] = move[c];
+		}
+	}
+	if (size > 0)
+		buffer[length < size ? length : size - 1] = '\0';
+	return length;
+}
+
+/**
+ * Solve the given Rubik's Cube step by step, adding the moves of each
+ * step to the given buffer and recording the last layer cases. The F2L
+ * pairs are solved in the given order (see solveF2L).
+ */
+void solveSteps(Cube& cube, MoveBuffer& solution, LastLayerCase& oll, LastLayerCase& pll, uint8_t order = 0)
+{
+	solveCross(cube, solution);
+	solveF2L(cube, solution, order);
+	oll = solveOLL(cube, solution);
+	pll = solvePLL(cube, solution);
+}
+
 /**
  * Solve the given Rubik's Cube.
  */
 std::vector<Move> solve(Cube& cube)
 {
-	// vector of moves in the solution
-	std::vector<Move> solution;
+	MoveBuffer solution;
+	LastLayerCase oll, pll;
+	solveSteps(cube, solution, oll, pll);
 
-	solveCross(cube, solution);
-	solveF2L(cube, solution);
-	solveOLL(cube, solution);
-	solvePLL(cube, solution);
+	MoveBuffer cleaned;
+	cleanSolution(solution.data(), solution.size(), false, METRIC::HTM, MOVE_SET::ANY, cleaned);
+	return std::vector<Move>(cleaned.begin(), cleaned.end());
+}
+
+/**
+ * Metric to optimize a robot's solution in: quarter turn metric when
+ * half turns cost (or take) more than two quarter turns would, and half
+ * turn metric otherwise.
+ */
+METRIC robotMetric(const SolveOptions& options, const MoveSubstitutions& substitutions)
+{
+	float quarterCost = 0;
+	float halfCost = 0;
+	for (uint8_t face = 0; face < 6; face++)
+	{
+		quarterCost += substitutions.costs[face * 3 + (uint8_t)Move::TYPE::NORMAL];
+		halfCost += substitutions.costs[face * 3 + (uint8_t)Move::TYPE::DOUBLE];
+	}
+	if (options.minimizeTime)
+	{
+		quarterCost = (float)options.timing.quarterTurn + options.timing.settle;
+		halfCost = (float)options.timing.halfTurn;
+	}
+	return halfCost > 2 * quarterCost ? METRIC::QTM : METRIC::HTM;
+}
+
+/**
+ * Solve the given Rubik's Cube for a robot, using only the allowed
+ * moves, at the lowest total cost (or scheduled time) found.
+ *
+ * The cube is solved from each of its 24 orientations (each giving a
+ * different cross and F2L), and each solution is written in outer face
+ * turns before its disallowed moves are replaced. The cheapest result
+ * is kept. Solutions are optimized in the robot's metric (see
+ * robotMetric).
+ *
+ * With a budget, the orientations stop once it's spent, keeping the best
+ * so far (the cube's own orientation is always tried).
+ *
+ * Return an empty, unsolved solution if some move can't be made from
+ * the allowed ones, or the solve is cancelled.
+ */
+Solution solveForRobot(const Cube& cube, const SolveOptions& options)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Solution solution;
+	const MoveRestriction& restriction = options.restriction;
+	MoveSubstitutions substitutions = findSubstitutions(restriction);
+	if (!substitutions.complete)
+		return solution;
+
+	METRIC metric = robotMetric(options, substitutions);
+
+	std::vector<Move> best;
+	float bestCost = -1;
+	COLOR crossColor = COLOR::EMPTY;
+	// a fast solve only takes the first orientation, which is the cube's own
+	for (const Move& bottom : bottomRotations)
+	{
+		for (const Move& side : sideRotations)
+		{
+			if (isCancelled(options))
+				return Solution();
+			if (bestCost >= 0 && (options.fast || (options.budget > 0 &&
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= options.budget)))
+				break;
+			Cube rotated = cube;
+			MoveBuffer steps;
+			for (const Move& rotation : { bottom, side })
+			{
+				rotated.executeMove(rotation);
+				steps.push_back(rotation);
+			}
+			COLOR color = rotated.getCenter(FACE::DOWN);
+			LastLayerCase oll, pll;
+			solveSteps(rotated, steps, oll, pll);
+
+			MoveBuffer cleaned;
+			cleanSolution(steps.data(), steps.size(), true, metric, MOVE_SET::FACE_TURNS, cleaned);
+			std::vector<Move> restricted = restrictSolution(std::vector<Move>(cleaned.begin(), cleaned.end()),
+				restriction, substitutions);
+			float cost = options.minimizeTime ? (float)scheduledTime(restricted, options.timing) : solutionCost(restricted, restriction);
+			if (bestCost < 0 || cost < bestCost)
+			{
+				best.swap(restricted);
+				bestCost = cost;
+				crossColor = color;
+				solution.oll = oll;
+				solution.pll = pll;
+			}
+		}
+	}
+
+	Cube scratch = cube;
+	scratch.executeMoves(best);
+	solution.setMoves(best.data(), best.size());
+	solution.solved = scratch.isSolved();
+	findPhases(cube, crossColor, solution);
+	return solution;
+}
+
+/**
+ * Solve the given cube once the given symmetry is applied to it, with
+ * the F2L pairs in the given order, optimizing the solution if asked.
+ * Write the solution, mapped back move by move to the cube as it's
+ * given, into the given buffer (using the other two for scratch), and
+ * record the cross color and last layer cases.
+ *
+ * Return the solution's length in the options' metric, or -1 if it
+ * didn't solve the cube.
+ */
+int solveCandidate(const Cube& cube, uint8_t symmetry, uint8_t order, bool optimize, const SolveOptions& options,
+	MoveBuffer* scratch, MoveBuffer& solution, COLOR& crossColor, LastLayerCase& oll, LastLayerCase& pll)
+{
+	Cube transformed = cube;
+	applySymmetry(transformed, symmetry);
+	crossColor = transformed.getCenter(FACE::DOWN);
+	scratch[0].clear();
+	solveSteps(transformed, scratch[0], oll, pll, order);
+	cleanSolution(scratch[0].data(), scratch[0].size(), optimize, options.metric, options.moveSet, scratch[1]);
+	if (!transformed.isSolved() || scratch[0].overflow() || scratch[1].overflow())
+		return -1;
+
+	solution.clear();
+	for (const Move& move : scratch[1])
+		solution.push_back(Move::fromCode(conjugateMoveCode(symmetry, move.code())));
+	// reflected cases are seen from the other side
+	if (symmetry >= NUM_ROTATIONS)
+	{
+		for (LastLayerCase* llCase : { &oll, &pll })
+		{
+			if (llCase->id == NO_CASE)
+				continue;
+			llCase->id = UNKNOWN_CASE;
+			llCase->preAUF = (4 - llCase->preAUF) & 3;
+			llCase->postAUF = (4 - llCase->postAUF) & 3;
+		}
+	}
+	return (int)countMoves(solution.data(), solution.size(), options.metric);
+}
+
+/**
+ * Solve the given Rubik's Cube within the options' budget, returning the
+ * shortest solution found.
+ *
+ * The first candidate is the usual solution, which is always found
+ * however small the budget is, so an anytime solve is never longer than
+ * the usual one. Next comes the cube solved under each of its other 47
+ * symmetries (each one has a different cross and F2L, and maps back move
+ * by move), then each symmetry again with the F2L pairs in each other
+ * order, the symmetries with the shortest solutions first. Each of these
+ * is only started if the average time of the ones before it leaves room
+ * for it, so the budget is kept to within the time of one candidate.
+ */
+Solution solveAnytime(const Cube& cube, const SolveOptions& options)
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	ArenaScope scope(Arena::local());
+	MoveBuffer* buffers = Arena::local().allocate<MoveBuffer>(4);
+	MoveBuffer& best = buffers[2];
+	MoveBuffer& candidate = buffers[3];
+	int bestLength = -1;
+	COLOR bestColor = COLOR::EMPTY;
+	LastLayerCase bestOLL, bestPLL;
+
+	// the length of each symmetry's solution, in the order to try their F2L orders
+	int lengths[NUM_SYMMETRIES] = {};
+	uint8_t symmetries[NUM_SYMMETRIES];
+	const size_t numCandidates = NUM_SYMMETRIES * NUM_F2L_ORDERS;
+	for (size_t c = 0; c < numCandidates; c++)
+	{
+		// only the candidates after the usual solution depend on the budget
+		if (c > 0)
+		{
+			double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			if (isCancelled(options))
+				return Solution();
+			if (elapsed + elapsed / c > options.budget)
+				break;
+		}
+
+		uint8_t symmetry, order;
+		if (c < NUM_SYMMETRIES)
+		{
+			symmetry = (uint8_t)c;
+			order = 0;
+		}
+		else
+		{
+			if (c == NUM_SYMMETRIES)
+			{
+				for (uint8_t s = 0; s < NUM_SYMMETRIES; s++)
+					symmetries[s] = s;
+				std::stable_sort(symmetries, symmetries + NUM_SYMMETRIES, [&lengths](uint8_t a, uint8_t b) {
+					return (unsigned int)lengths[a] < (unsigned int)lengths[b];
+				});
+			}
+			size_t index = c - NUM_SYMMETRIES;
+			symmetry = symmetries[index / (NUM_F2L_ORDERS - 1)];
+			order = (uint8_t)(1 + index % (NUM_F2L_ORDERS - 1));
+			// unsolvable under one symmetry is unsolvable under all
+			if (lengths[symmetry] < 0)
+				continue;
+		}
+
+		COLOR crossColor;
+		LastLayerCase oll, pll;
+		int length = solveCandidate(cube, symmetry, order, options.optimize, options, buffers, candidate, crossColor,
+			oll, pll);
+		if (c < NUM_SYMMETRIES)
+			lengths[symmetry] = length;
+		if (length >= 0 && (bestLength < 0 || length < bestLength))
+		{
+			best = candidate;
+			bestLength = length;
+			bestColor = crossColor;
+			bestOLL = oll;
+			bestPLL = pll;
+		}
+	}
+
+	Solution solution;
+	if (bestLength < 0)
+		return solution;
+	solution.setMoves(best.data(), best.size());
+	solution.oll = bestOLL;
+	solution.pll = bestPLL;
+	solution.solved = true;
+	findPhases(cube, bestColor, solution);
+	return solution;
+}
+
+/**
+ * Solve the given Rubik's Cube with the given options, leaving the
+ * given cube as it is.
+ *
+ * Every call works on its own copy of the cube and its own buffers, and
+ * the tables it reads are never changed once built, so it's safe to call
+ * from many threads at once.
+ *
+ * Solutions for a robot (with a restriction, or minimizing time) are
+ * always optimized and made only of allowed outer face turns. Otherwise
+ * the solution is optimized for the given metric and move set, unless
+ * optimizing is turned off. Either way, the solution records where each
+ * phase ends and which last layer cases were recognized.
+ *
+ * With a budget, the solve keeps looking for a better solution until
+ * it's spent (see solveAnytime and solveForRobot).
+ */
+Solution solve(const Cube& cube, const SolveOptions& options)
+{
+	if (!options.restriction.isDefault() || options.minimizeTime)
+		return solveForRobot(cube, options);
+	if (options.budget > 0 && !options.fast)
+		return solveAnytime(cube, options);
+
+	ArenaScope scope(Arena::local());
+	Solution solution;
+	Cube scratch = cube;
+	COLOR crossColor = scratch.getCenter(FACE::DOWN);
+	MoveBuffer* steps = Arena::local().allocate<MoveBuffer>(2);
+	solveSteps(scratch, steps[0], solution.oll, solution.pll);
+	// optimizing takes most of the time
+	if (isCancelled(options))
+		return Solution();
+	cleanSolution(steps[0].data(), steps[0].size(), options.optimize && !options.fast, options.metric, options.moveSet,
+		steps[1]);
+	solution.setMoves(steps[1].data(), steps[1].size());
+	solution.solved = scratch.isSolved() && !steps[0].overflow() && !steps[1].overflow();
+	findPhases(cube, crossColor, solution);
+	return solution;
+}
+
+/**
+ * Solve the given Rubik's Cube with the given options, writing the
+ * solution into the given buffer without allocating.
+ *
+ * Scratch memory comes from the calling thread's arena, which is
+ * rewound once the solve is done. Like the version above, it leaves the
+ * given cube as it is and is safe to call from many threads at once.
+ *
+ * Return false if the cube wasn't solved, which is also the case for
+ * robot options (a restriction, or minimizing time), since they
+ * aren't supported here.
+ */
+bool solve(const Cube& cube, const SolveOptions& options, MoveBuffer& solution)
+{
+	solution.clear();
+	if (!options.restriction.isDefault() || options.minimizeTime)
+		return false;
 
-	return cleanSolution(solution);
+	ArenaScope scope(Arena::local());
+	Cube scratch = cube;
+	MoveBuffer* steps = Arena::local().allocate<MoveBuffer>(1);
+	LastLayerCase oll, pll;
+	solveSteps(scratch, *steps, oll, pll);
+	if (isCancelled(options))
+		return false;
+	cleanSolution(steps->data(), steps->size(), options.optimize && !options.fast, options.metric, options.moveSet,
+		solution);
+	return scratch.isSolved() && !steps->overflow() && !solution.overflow();
+}
+
+/**
+ * Find moves that take one cube to another.
+ *
+ * Making the moves that solve to^-1 * from on the first cube rearranges
+ * it by from^-1 * to, leaving the second. A solve can finish with the
+ * centers turned (from slices or wide turns, or if the cubes are held
+ * differently), so the rotation that brings them back is added at the
+ * end. A robot can't rotate the cube, so its solution fails if one is
+ * needed.
+ */
+Solution solveBetween(const Cube& from, const Cube& to, const SolveOptions& options)
+{
+	Cube relative = to.inverse();
+	relative.compose(from);
+	Solution solution = solve(relative, options);
+	if (!solution.solved)
+		return solution;
+
+	Cube solved;
+	Cube finished = relative;
+	for (size_t i = 0; i < solution.size(); i++)
+		finished.executeMove(solution.move(i));
+	if (finished == solved)
+		return solution;
+
+	for (uint8_t symmetry = 0; symmetry < NUM_ROTATIONS; symmetry++)
+	{
+		Cube turned = finished;
+		applySymmetry(turned, symmetry);
+		if (!(turned == solved))
+			continue;
+		if (!options.restriction.isDefault() || options.minimizeTime)
+			break;
+		const Move rotations[2] = { bottomRotations[symmetry / 4], sideRotations[symmetry % 4] };
+		for (const Move& rotation : rotations)
+		{
+			if (rotation.type != Move::TYPE::NO_MOVE)
+				solution.moves.push_back(rotation.code());
+		}
+		findPhases(relative, relative.getCenter(FACE::DOWN), solution);
+		return solution;
+	}
+	solution.solved = false;
+	return solution;
 }
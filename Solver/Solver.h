@@ -1,11 +1,17 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <atomic>
 #include <vector>
 #include <string>
 
 #include "Cube.h"
 #include "Move.h"
+#include "Optimizer.h"
+#include "Peephole.h"
+#include "Restriction.h"
+#include "Schedule.h"
+#include "Solution.h"
 #include "SolverCross.h"
 #include "SolverF2L.h"
 #include "SolverOLL.h"
@@ -28,21 +34,90 @@ LAYER getLayer(LOCATION l);
 /**
  * Clean the given solution, removing redundancies.
  */
-std::vector<Move> cleanSolution(std::vector<Move>& solution, bool optimized = false);
+std::vector<Move> cleanSolution(const std::vector<Move>& solution, bool optimized = false, METRIC metric = METRIC::HTM,
+	MOVE_SET moveSet = MOVE_SET::ANY);
+void cleanSolution(const Move* solution, size_t count, bool optimized, METRIC metric, MOVE_SET moveSet, MoveBuffer& cleaned);
 
 /**
  * Print the given solution.
  */
-void printSolution(std::vector<Move>& solution);
+void printSolution(const std::vector<Move>& solution);
 
 /**
  * Return a string value of the solution.
  */
-std::string solutionToString(std::vector<Move>& solution);
+std::string solutionToString(const std::vector<Move>& solution);
+
+/**
+ * Write a string value of the solution into the given buffer, returning
+ * its whole length (it's cut short if the buffer is too small).
+ */
+size_t solutionToString(const Move* solution, size_t count, char* buffer, size_t size);
+
+/**
+ * Options for solving a cube.
+ *
+ * The solution is optimized for the given metric and written using the
+ * given move set, unless optimizing is turned off.
+ *
+ * The restriction limits the solution to certain outer face turns,
+ * choosing the solution with the lowest total cost. Minimizing time
+ * chooses the solution the robot with the given timing can perform
+ * the fastest instead.
+ *
+ * A fast solve takes a single pass of CFOP: it isn't optimized, and a
+ * robot's solution only tries the cube's own orientation (still using
+ * only the allowed moves). A solve gives up, unsolved, once the cancel
+ * flag (if there is one) is set, which it checks between its steps.
+ *
+ * With a budget (in seconds), the solve is anytime: it finds the usual
+ * solution first, then keeps looking for shorter ones (or cheaper ones,
+ * for a robot) until the budget is spent, returning the best it found.
+ */
+struct SolveOptions
+{
+	bool optimize = true;
+	METRIC metric = METRIC::HTM;
+	MOVE_SET moveSet = MOVE_SET::ANY;
+	MoveRestriction restriction;
+	bool minimizeTime = false;
+	RobotTiming timing;
+	bool fast = false;
+	const std::atomic<bool>* cancel = nullptr;
+	double budget = 0;
+};
+
+/**
+ * Whether the given options' cancel flag has been set.
+ */
+inline bool isCancelled(const SolveOptions& options)
+{
+	return options.cancel != nullptr && options.cancel->load(std::memory_order_relaxed);
+}
+
+/**
+ * Metric a robot's solution is optimized in, for the given options and
+ * the substitutions for its restriction.
+ */
+METRIC robotMetric(const SolveOptions& options, const MoveSubstitutions& substitutions);
 
 /**
  * Solve the given Rubik's Cube!
+ *
+ * The first version solves the cube it's given. The others leave it as
+ * it is, and are safe to call from many threads at once. The last one
+ * writes the solution into the given buffer and never allocates, but
+ * doesn't support robot options, and ignores the budget.
  */
 std::vector<Move> solve(Cube& cube);
+Solution solve(const Cube& cube, const SolveOptions& options);
+bool solve(const Cube& cube, const SolveOptions& options, MoveBuffer& solution);
+
+/**
+ * Find moves that take one cube to another (both with the colors of a
+ * reset cube), by solving the cube the second's inverse composed with
+ * the first leads to. Its phases are those of that cube's solve.
+ */
+Solution solveBetween(const Cube& from, const Cube& to, const SolveOptions& options = SolveOptions());
 
 #endif
@@ -1,5 +1,3 @@
-#include <iostream>
-
 #include "Solver2L.h"
 
 /**
@@ -175,7 +173,6 @@ void solveSecondLayer(Cube& cube, std::vector<Move>& solution)
 	while (edgeLoc.second)
 	{
 		solveSecondLayerEdge(cube, edgeLoc.first, solution);
-		solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
 		edgeLoc = findUnsolved2LEdge(cube, color);
 	}
 }
\ No newline at end of file
@@ -1,5 +1,3 @@
-#include <iostream>
-
 #include "SolverCorners.h"
 
 /**
@@ -233,7 +231,6 @@ void solveCorners(Cube& cube, std::vector<Move>& solution)
 	while (cornerLoc.second)
 	{
 		solveCorner(cube, cornerLoc.first, solution);
-		solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
 		cornerLoc = findUnsolvedCorner(cube, color);
 	}
 }
\ No newline at end of file
@@ -1,5 +1,3 @@
-#include <iostream>
-
 #include "SolverCross.h"
 
 /**
@@ -34,7 +32,7 @@ std::pair<LOCATION, bool> findUnsolvedCrossEdge(Cube& cube, COLOR color)
  *
  * Return the piece's new location.
  */
-LOCATION bringEdgeToTopLayer(Cube& cube, LOCATION piece, std::vector<Move>& solution)
+LOCATION bringEdgeToTopLayer(Cube& cube, LOCATION piece, MoveBuffer& solution)
 {
 	// find which layer it currently is
 	LAYER layer = getLayer(piece);
@@ -150,7 +148,7 @@ LOCATION bringEdgeToTopLayer(Cube& cube, LOCATION piece, std::vector<Move>& solu
  *
  * Return the piece's new location.
  */
-LOCATION moveEdgeOverCenter(Cube& cube, LOCATION piece, std::vector<Move>& solution)
+LOCATION moveEdgeOverCenter(Cube& cube, LOCATION piece, MoveBuffer& solution)
 {
 	uint8_t moves = 0;
 	// if cross color is facing up
@@ -199,7 +197,7 @@ LOCATION moveEdgeOverCenter(Cube& cube, LOCATION piece, std::vector<Move>& solut
  * Assumes that the piece is located in the top layer directly
  * over the location it needs to be inserted into.
  */
-void insertCrossEdge(Cube& cube, LOCATION piece, std::vector<Move>& solution)
+void insertCrossEdge(Cube& cube, LOCATION piece, MoveBuffer& solution)
 {
 	// simple case is when white is facing up
 	if (piece.face == FACE::UP)
@@ -228,7 +226,7 @@ void insertCrossEdge(Cube& cube, LOCATION piece, std::vector<Move>& solution)
  * color, and that the cross color's center is already facing
  * down.
  */
-void solveCrossPiece(Cube& cube, LOCATION piece, std::vector<Move>& solution)
+void solveCrossPiece(Cube& cube, LOCATION piece, MoveBuffer& solution)
 {
 	if (cube.isPieceSolved(piece))
 		return;
@@ -241,7 +239,7 @@ void solveCrossPiece(Cube& cube, LOCATION piece, std::vector<Move>& solution)
 /**
  * Orient the cube so the given color is facing down.
  */
-void orientDown(Cube& cube, COLOR color, std::vector<Move>& solution)
+void orientDown(Cube& cube, COLOR color, MoveBuffer& solution)
 {
 	if (cube.getCenter(FACE::UP) == color)
 		solution.push_back(cube.parseMove("z2"));
@@ -265,7 +263,7 @@ void orientDown(Cube& cube, COLOR color, std::vector<Move>& solution)
  * Whichever color is currently on the down face is selected
  * for the cross color.
  */
-void solveCross(Cube& cube, std::vector<Move>& solution)
+void solveCross(Cube& cube, MoveBuffer& solution)
 {
 	// get the cross color
 	COLOR color = cube.getCenter(FACE::DOWN);
@@ -275,7 +273,6 @@ void solveCross(Cube& cube, std::vector<Move>& solution)
 	while (edgeLoc.second)
 	{
 		solveCrossPiece(cube, edgeLoc.first, solution);
-		solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
 		edgeLoc = findUnsolvedCrossEdge(cube, color);
 	}
 }
@@ -10,6 +10,6 @@ typedef Cube::FACE FACE;
 /**
 * Solve the cross on the given cube.
 */
-void solveCross(Cube& cube, std::vector<Move>& solution);
+void solveCross(Cube& cube, MoveBuffer& solution);
 
 #endif
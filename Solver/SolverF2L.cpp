@@ -1,6 +1,5 @@
 #include <vector>
 
-#include <iostream> // TODO: remove
 #include "SolverF2L.h"
 
 /**
@@ -57,13 +56,17 @@ LOCATION findMatchingEdge(Cube& cube, LOCATION cornerLoc)
 * Return it as a <pair, bool> pair. The bool indicates
 * if an unsolved pair was able to be located. The pair
 * is the location of the corner and edge piece, in that
-* order, of the unsolved F2L pair.
+* order, of the unsolved F2L pair. The given choice picks
+* which of the unsolved pairs to return, counting in the
+* order they're found (wrapping around if there are fewer).
 *
 * Cube is assumed to be oriented with cross color down.
 */
-std::pair<std::pair<LOCATION, LOCATION>, bool> findUnsolvedF2LPair(Cube& cube, COLOR crossColor)
+std::pair<std::pair<LOCATION, LOCATION>, bool> findUnsolvedF2LPair(Cube& cube, COLOR crossColor, uint8_t choice = 0)
 {
-	// find an unsolved F2L pair
+	// find the unsolved F2L pairs
+	std::pair<LOCATION, LOCATION> unsolved[4];
+	uint8_t numUnsolved = 0;
 	LOCATION cornerLoc, edgeLoc;
 	// search every corner location
 	for (uint8_t cornerFace = 0; cornerFace < 6; cornerFace++)
@@ -76,14 +79,20 @@ std::pair<std::pair<LOCATION, LOCATION>, bool> findUnsolvedF2LPair(Cube& cube, C
 			{
 				edgeLoc = findMatchingEdge(cube, cornerLoc);
 
-				// return if this pair is unsolved
-				if (!cube.isPieceSolved(cornerLoc) || !cube.isPieceSolved(edgeLoc))
-					return std::make_pair(std::make_pair(cornerLoc, edgeLoc), true);
+				// keep this pair if it's unsolved
+				if ((!cube.isPieceSolved(cornerLoc) || !cube.isPieceSolved(edgeLoc)) && numUnsolved < 4)
+				{
+					unsolved[numUnsolved++] = std::make_pair(cornerLoc, edgeLoc);
+					if (choice < numUnsolved)
+						return std::make_pair(unsolved[choice], true);
+				}
 			}
 		}
 	}
 	// F2L is solved, return false
-	return std::make_pair(std::make_pair(cornerLoc, edgeLoc), false);
+	if (numUnsolved == 0)
+		return std::make_pair(std::make_pair(cornerLoc, edgeLoc), false);
+	return std::make_pair(unsolved[choice % numUnsolved], true);
 }
 
 /**
@@ -291,7 +300,7 @@ uint8_t getUpIdxCorner(LOCATION loc)
 * When possible, make it so this step ends with the pair
 * only requiring a three move insert to be solved.
 */
-void bringF2LToTop(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector<Move>& solution)
+void bringF2LToTop(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, MoveBuffer& solution)
 {
 	LAYER cornerLayer = getLayer(cornerLoc);
 	LAYER edgeLayer = getLayer(edgeLoc);
@@ -558,7 +567,7 @@ void bringF2LToTop(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector
 *
 * If no unsolved slots are present, return 4.
 */
-uint8_t moveToUnsolvedSlot(Cube& cube, uint8_t idx, std::vector<Move>& solution)
+uint8_t moveToUnsolvedSlot(Cube& cube, uint8_t idx, MoveBuffer& solution)
 {
 	if (!isSlotSolved(cube, idx))
 		return 0;
@@ -617,7 +626,7 @@ uint8_t findF2LSlot(Cube& cube, COLOR color0, COLOR color1)
 * If the given colors do not correspond to a valid F2L slot,
 * return 8.
 */
-uint8_t moveToSlot(Cube& cube, uint8_t idx, COLOR color0, COLOR color1, std::vector<Move>& solution)
+uint8_t moveToSlot(Cube& cube, uint8_t idx, COLOR color0, COLOR color1, MoveBuffer& solution)
 {
 	// find the idx of the target slot
 	uint8_t targetIdx = findF2LSlot(cube, color0, color1);
@@ -643,7 +652,7 @@ uint8_t moveToSlot(Cube& cube, uint8_t idx, COLOR color0, COLOR color1, std::vec
 * with different colors facing up, they are split in such a way
 * that sets up a three move insert.
 */
-void splitF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector<Move>& solution)
+void splitF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, MoveBuffer& solution)
 {
 	uint8_t cornerUpIdx = getUpIdxCorner(cornerLoc);
 	uint8_t edgeUpIdx = edgeLoc.face == FACE::UP ? edgeLoc.idx : cube.getAdjacentEdge(edgeLoc).idx;
@@ -703,7 +712,7 @@ void splitF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector<
 * setting them up for a three move insert. Otherwise, ensure
 * the corner and edge piece aren't adjacent.
 */
-void prepF2LToInsert(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector<Move>& solution)
+void prepF2LToInsert(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, MoveBuffer& solution)
 {
 	// do nothing if paired
 	if (isF2LPairPaired(cube, cornerLoc, edgeLoc))
@@ -835,7 +844,7 @@ void prepF2LToInsert(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vect
 * Insert the given F2L pair into its
 * correct slot.
 */
-void insertF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector<Move>& solution)
+void insertF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, MoveBuffer& solution)
 {
 	// get F2L pair colors
 	COLOR color0 = cube.getSticker(edgeLoc);
@@ -974,7 +983,7 @@ void insertF2LPair(Cube& cube, LOCATION cornerLoc, LOCATION edgeLoc, std::vector
 * Solve the given F2L pair without disturbing any
 * other potentially solved pairs.
 */
-void solveF2LPair(Cube& cube, std::pair<LOCATION, LOCATION> pairLoc, std::vector<Move>& solution)
+void solveF2LPair(Cube& cube, std::pair<LOCATION, LOCATION> pairLoc, MoveBuffer& solution)
 {
 	// remember F2L pair's colors (so it can be relocated later)
 	COLOR color0 = cube.getSticker(pairLoc.second);
@@ -993,20 +1002,33 @@ void solveF2LPair(Cube& cube, std::pair<LOCATION, LOCATION> pairLoc, std::vector
 }
 
 /**
-* Solve the first two layers on the given cube.
+* Solve the next F2L pair on the given cube, choosing
+* which of the unsolved pairs to solve the same way as
+* findUnsolvedF2LPair.
 *
-* Assumes the cross is solved and is oriented down.
+* Return false if every pair was solved already.
 */
-void solveF2L(Cube& cube, std::vector<Move>& solution)
+bool solveNextF2LPair(Cube& cube, MoveBuffer& solution, uint8_t choice)
 {
-	// get the cross color
-	COLOR color = cube.getCenter(FACE::DOWN);
+	std::pair<std::pair<LOCATION, LOCATION>, bool> pairLoc =
+		findUnsolvedF2LPair(cube, cube.getCenter(FACE::DOWN), choice);
+	if (!pairLoc.second)
+		return false;
+	solveF2LPair(cube, pairLoc.first, solution);
+	return true;
+}
 
-	std::pair<std::pair<LOCATION, LOCATION>, bool> pairLoc = findUnsolvedF2LPair(cube, color);
-	while (pairLoc.second)
-	{
-		solveF2LPair(cube, pairLoc.first, solution);
-		solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
-		pairLoc = findUnsolvedF2LPair(cube, color);
-	}
+/**
+* Solve the first two layers on the given cube, solving
+* the pairs in the given order (see NUM_F2L_ORDERS).
+*
+* Assumes the cross is solved and is oriented down.
+*/
+void solveF2L(Cube& cube, MoveBuffer& solution, uint8_t order)
+{
+	// each pair solved picks one of the remaining ones: one of 4, then 3, then 2
+	uint8_t choices[4] = { (uint8_t)(order / 6), (uint8_t)(order / 2 % 3), (uint8_t)(order % 2), 0 };
+	uint8_t solved = 0;
+	while (solveNextF2LPair(cube, solution, choices[solved < 4 ? solved : 3]))
+		solved++;
 }
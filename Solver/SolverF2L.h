@@ -8,8 +8,22 @@ typedef Cube::COLOR COLOR;
 typedef Cube::FACE FACE;
 
 /**
-* Solve the first two layers on the given cube.
+* Number of orders the F2L pairs can be solved in.
 */
-void solveF2L(Cube& cube, std::vector<Move>& solution);
+const uint8_t NUM_F2L_ORDERS = 24;
+
+/**
+* Solve the first two layers on the given cube. Order 0
+* solves each pair as it's found; the others solve them
+* in another of the 24 orders, giving other solutions.
+*/
+void solveF2L(Cube& cube, MoveBuffer& solution, uint8_t order = 0);
+
+/**
+* Solve one more F2L pair on the given cube, the one
+* found first unless the given choice picks another,
+* returning false if they're all solved already.
+*/
+bool solveNextF2LPair(Cube& cube, MoveBuffer& solution, uint8_t choice = 0);
 
 #endif
@@ -1,5 +1,3 @@
-#include <iostream>
-
 #include "SolverOLL.h"
 
 /**
@@ -58,6 +56,22 @@ const uint8_t olls[NUM_OLL_TYPES] = {
 	0	// O1/2
 };
 
+/**
+* Names of every OLL case, in the same order as OLL_CASE.
+*/
+const char* const ollNames[NUM_OLLS] = {
+	"OCLL1", "OCLL2", "OCLL3", "OCLL4", "OCLL5", "OCLL6", "OCLL7", "E1", "E2",
+	"T1", "T2", "C1", "C2", "W1", "W2", "P1", "P2", "P3", "P4", "F1", "F2", "F3", "F4",
+	"A1", "A2", "A3", "A4", "B1", "B2", "B3", "B4", "B5", "B6", "S1", "S2", "K1", "K2", "K3", "K4",
+	"I1", "I2", "I3", "I4", "L1", "L2", "L3", "L4", "L5", "L6",
+	"O1", "O2", "O3", "O4", "O5", "O6", "O7", "O8"
+};
+
+/**
+* Clockwise quarter turns of the up face for each move type.
+*/
+const uint8_t aufTurns[3] = { 1, 3, 2 };
+
 /**
 * Generate a bit mask of the top face of a cube
 * selecting every location as indicated by the given OLL.
@@ -169,7 +183,7 @@ std::pair<uint8_t, uint8_t> findOLLType(Cube& cube, COLOR topColor)
 /**
 * Solve OLL cases OCLL3 and OCLL4
 */
-void solveOCLL34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveOCLL34(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 3 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, false, true);
@@ -186,8 +200,8 @@ void solveOCLL34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: R2 D (R' U2 R) D' (R' U2 R')
-		std::vector<Move> moves = cube.readMoves("R2 D R' U2 R D' R' U2 R'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R2 D R' U2 R D' R' U2 R'", solution);
+		return OLL_CASE::OCLL3;
 	}
 	// OCLL4
 	else
@@ -201,15 +215,15 @@ void solveOCLL34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: (r U R' U') (r' F R F')
-		std::vector<Move> moves = cube.readMoves("(r U R' U') (r' F R F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r U R' U') (r' F R F')", solution);
+		return OLL_CASE::OCLL4;
 	}
 }
 
 /**
 * Solve OLL case OCLL5
 */
-void solveOCLL5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveOCLL5(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, false, false);
@@ -227,14 +241,14 @@ void solveOCLL5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 			solution.push_back(cube.move(FACE::UP));
 	}
 	// perform OLL: y F' (r U R' U') r' F R
-	std::vector<Move> moves = cube.readMoves("y F' (r U R' U') r' F R");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("y F' (r U R' U') r' F R", solution);
+	return OLL_CASE::OCLL5;
 }
 
 /**
 * Solve OLL case E1
 */
-void solveE1(Cube& cube, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveE1(Cube& cube, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	if (shifts == 1)
@@ -245,28 +259,28 @@ void solveE1(Cube& cube, uint8_t shifts, std::vector<Move>& solution)
 		solution.push_back(cube.move(FACE::UP));
 
 	// perform OLL: (r U R' U') M (U R U' R')
-	std::vector<Move> moves = cube.readMoves("(r U R' U') M (U R U' R')");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("(r U R' U') M (U R U' R')", solution);
+	return OLL_CASE::E1;
 }
 
 /**
 * Solve OLL case E2
 */
-void solveE2(Cube& cube, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveE2(Cube& cube, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	if (shifts == 1)
 		solution.push_back(cube.move(FACE::UP));
 
 	// perform OLL: (R U R' U') M' (U R U' r')
-	std::vector<Move> moves = cube.readMoves("(R U R' U') M' (U R U' r')");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("(R U R' U') M' (U R U' r')", solution);
+	return OLL_CASE::E2;
 }
 
 /**
 * Solve OLL cases OCLL6 and OCLL7
 */
-void solveOCLL67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveOCLL67(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 6 or 7
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, false, false);
@@ -283,8 +297,8 @@ void solveOCLL67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: R U2 R' U' R U' R'
-		std::vector<Move> moves = cube.readMoves("R U2 R' U' R U' R'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R U2 R' U' R U' R'", solution);
+		return OLL_CASE::OCLL6;
 	}
 	// OCLL7
 	else
@@ -298,15 +312,15 @@ void solveOCLL67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: R U R' U R U2 R'
-		std::vector<Move> moves = cube.readMoves("R U R' U R U2 R'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R U R' U R U2 R'", solution);
+		return OLL_CASE::OCLL7;
 	}
 }
 
 /**
 * Solve OLL cases OCLL1 and OCLL2
 */
-void solveOCLL12(Cube& cube, COLOR topColor, std::vector<Move>& solution)
+OLL_CASE solveOCLL12(Cube& cube, COLOR topColor, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, false, true);
@@ -328,8 +342,8 @@ void solveOCLL12(Cube& cube, COLOR topColor, std::vector<Move>& solution)
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R U2 R') (U' R U R') (U' R U' R')
-		std::vector<Move> moves = cube.readMoves("(R U2 R') (U' R U R') (U' R U' R')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U2 R') (U' R U R') (U' R U' R')", solution);
+		return OLL_CASE::OCLL1;
 	}
 	// OCLL2
 	else
@@ -343,15 +357,15 @@ void solveOCLL12(Cube& cube, COLOR topColor, std::vector<Move>& solution)
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: R U2 R2 U' R2 U' R2 U2 R
-		std::vector<Move> moves = cube.readMoves("R U2 R2 U' R2 U' R2 U2 R");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R U2 R2 U' R2 U' R2 U2 R", solution);
+		return OLL_CASE::OCLL2;
 	}
 }
 
 /**
 * Solve OLL cases T1 and T2
 */
-void solveT12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveT12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face (same for both cases)
 	if (shifts == 1)
@@ -367,22 +381,22 @@ void solveT12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 	if ((cube.getFace(FACE::FRONT) & rowMask.first) == rowMask.second)
 	{
 		// perform OLL: (R U R' U') (R' F R F')
-		std::vector<Move> moves = cube.readMoves("(R U R' U') (R' F R F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U') (R' F R F')", solution);
+		return OLL_CASE::T1;
 	}
 	// T2
 	else
 	{
 		// perform OLL: F (R U R' U') F'
-		std::vector<Move> moves = cube.readMoves("F (R U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("F (R U R' U') F'", solution);
+		return OLL_CASE::T2;
 	}
 }
 
 /**
 * Solve OLL cases C1 and C2
 */
-void solveC12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveC12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, true);
@@ -399,8 +413,8 @@ void solveC12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 		// perform OLL: (R U R2' U') (R' F R U) R U' F'
-		std::vector<Move> moves = cube.readMoves("(R U R2' U') (R' F R U) R U' F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R2' U') (R' F R U) R U' F'", solution);
+		return OLL_CASE::C1;
 	}
 	// C2
 	else
@@ -414,15 +428,15 @@ void solveC12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: R' U' (R' F R F') U R
-		std::vector<Move> moves = cube.readMoves("R' U' (R' F R F') U R");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R' U' (R' F R F') U R", solution);
+		return OLL_CASE::C2;
 	}
 }
 
 /**
 * Solve OLL cases W1 and W2
 */
-void solveW12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveW12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, true, true);
@@ -439,8 +453,8 @@ void solveW12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R' U' R U') (R' U R U) l U' R' U x
-		std::vector<Move> moves = cube.readMoves("(R' U' R U') (R' U R U) l U' R' U x");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R' U' R U') (R' U R U) l U' R' U x", solution);
+		return OLL_CASE::W1;
 	}
 	// W2
 	else
@@ -454,15 +468,15 @@ void solveW12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: (R U R' U) (R U' R' U') (R' F R F')
-		std::vector<Move> moves = cube.readMoves("(R U R' U) (R U' R' U') (R' F R F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U) (R U' R' U') (R' F R F')", solution);
+		return OLL_CASE::W2;
 	}
 }
 
 /**
 * Solve OLL cases P1 and P3
 */
-void solveP13(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveP13(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 3
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -479,8 +493,8 @@ void solveP13(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R' U' F) (U R U' R') F' R
-		std::vector<Move> moves = cube.readMoves("(R' U' F) (U R U' R') F' R");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R' U' F) (U R U' R') F' R", solution);
+		return OLL_CASE::P1;
 	}
 	// P3
 	else
@@ -494,15 +508,15 @@ void solveP13(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: R' U' F' U F R
-		std::vector<Move> moves = cube.readMoves("R' U' F' U F R");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R' U' F' U F R", solution);
+		return OLL_CASE::P3;
 	}
 }
 
 /**
 * Solve OLL cases P2 and P4
 */
-void solveP24(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveP24(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face (same for both cases)
 	if (shifts == 1)
@@ -518,22 +532,22 @@ void solveP24(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 	if ((cube.getFace(FACE::FRONT) & rowMask.first) == rowMask.second)
 	{
 		// perform OLL: R U B' (U' R' U) (R B R')
-		std::vector<Move> moves = cube.readMoves("R U B' (U' R' U) (R B R')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R U B' (U' R' U) (R B R')", solution);
+		return OLL_CASE::P2;
 	}
 	// P4
 	else
 	{
 		// perform OLL: f (R U R' U') f'
-		std::vector<Move> moves = cube.readMoves("f (R U R' U') f'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("f (R U R' U') f'", solution);
+		return OLL_CASE::P4;
 	}
 }
 
 /**
 * Solve OLL cases F3 and F4
 */
-void solveF34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveF34(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 3 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -550,8 +564,8 @@ void solveF34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 		// perform OLL: (R U2') (R2' F R F') (R U2' R')
-		std::vector<Move> moves = cube.readMoves("(R U2') (R2' F R F') (R U2' R')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U2') (R2' F R F') (R U2' R')", solution);
+		return OLL_CASE::F3;
 	}
 	// F4
 	else
@@ -565,15 +579,15 @@ void solveF34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: F (R U' R' U') (R U R' F')
-		std::vector<Move> moves = cube.readMoves("F (R U' R' U') (R U R' F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("F (R U' R' U') (R U R' F')", solution);
+		return OLL_CASE::F4;
 	}
 }
 
 /**
 * Solve OLL cases A1 and A4
 */
-void solveA14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveA14(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, false, true);
@@ -590,8 +604,8 @@ void solveA14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: (R U R' U') (R U' R') (F' U' F) (R U R')
-		std::vector<Move> moves = cube.readMoves("(R U R' U') (R U' R') (F' U' F) (R U R')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U') (R U' R') (F' U' F) (R U R')", solution);
+		return OLL_CASE::A1;
 	}
 	// A4
 	else
@@ -605,15 +619,15 @@ void solveA14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R' U' R U' R' U2R) F (R U R' U') F'
-		std::vector<Move> moves = cube.readMoves("(R' U' R U' R' U2R) F (R U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R' U' R U' R' U2R) F (R U R' U') F'", solution);
+		return OLL_CASE::A4;
 	}
 }
 
 /**
 * Solve OLL cases A2 and A3
 */
-void solveA23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveA23(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face (same for both cases)
 	if (shifts == 1)
@@ -629,22 +643,22 @@ void solveA23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 	if ((cube.getFace(FACE::BACK) & rowMask.first) != rowMask.second)
 	{
 		// perform OLL: F U (R U2 R' U') (R U2 R' U') F'
-		std::vector<Move> moves = cube.readMoves("F U (R U2 R' U') (R U2 R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("F U (R U2 R' U') (R U2 R' U') F'", solution);
+		return OLL_CASE::A2;
 	}
 	// A3
 	else
 	{
 		// perform OLL: (R U R' U R U2' R') F (R U R' U') F'
-		std::vector<Move> moves = cube.readMoves("(R U R' U R U2' R') F (R U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U R U2' R') F (R U R' U') F'", solution);
+		return OLL_CASE::A3;
 	}
 }
 
 /**
 * Solve OLL case B5
 */
-void solveB5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveB5(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, true, true);
@@ -663,14 +677,14 @@ void solveB5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solu
 	}
 
 	// perform OLL: (L F') (L' U' L U) F U' L'
-	std::vector<Move> moves = cube.readMoves("(L F') (L' U' L U) F U' L'");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("(L F') (L' U' L U) F U' L'", solution);
+	return OLL_CASE::B5;
 }
 
 /**
 * Solve OLL case B6
 */
-void solveB6(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveB6(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -689,24 +703,24 @@ void solveB6(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solu
 	}
 
 	// perform OLL: (R' F) (R U R' U') F' U R
-	std::vector<Move> moves = cube.readMoves("(R' F) (R U R' U') F' U R");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("(R' F) (R U R' U') F' U R", solution);
+	return OLL_CASE::B6;
 }
 
 /**
 * Solve OLL case O8
 */
-void solveO8(Cube& cube, std::vector<Move>& solution)
+OLL_CASE solveO8(Cube& cube, MoveBuffer& solution)
 {
 	// perform OLL: M U (R U R' U') M2' (U R U' r')
-	std::vector<Move> moves = cube.readMoves("M U (R U R' U') M2' (U R U' r')");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("M U (R U R' U') M2' (U R U' r')", solution);
+	return OLL_CASE::O8;
 }
 
 /**
 * Solve OLL cases S1 and S2
 */
-void solveS12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveS12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, false, true);
@@ -723,8 +737,8 @@ void solveS12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: (r' U2' R U R' U r)
-		std::vector<Move> moves = cube.readMoves("(r' U2' R U R' U r)");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r' U2' R U R' U r)", solution);
+		return OLL_CASE::S1;
 	}
 	// S2
 	else
@@ -738,15 +752,15 @@ void solveS12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (r U2 R' U' R U' r')
-		std::vector<Move> moves = cube.readMoves("(r U2 R' U' R U' r')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r U2 R' U' R U' r')", solution);
+		return OLL_CASE::S2;
 	}
 }
 
 /**
 * Solve OLL cases F1 and F2
 */
-void solveF12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveF12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -763,8 +777,8 @@ void solveF12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R U R' U') R' F (R2 U R' U') F'
-		std::vector<Move> moves = cube.readMoves("(R U R' U') R' F (R2 U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U') R' F (R2 U R' U') F'", solution);
+		return OLL_CASE::F1;
 	}
 	// F2
 	else
@@ -778,15 +792,15 @@ void solveF12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R U R' U) (R' F R F') (R U2' R')
-		std::vector<Move> moves = cube.readMoves("(R U R' U) (R' F R F') (R U2' R')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U R' U) (R' F R F') (R U2' R')", solution);
+		return OLL_CASE::F2;
 	}
 }
 
 /**
 * Solve OLL cases K1 and K4
 */
-void solveK14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveK14(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, true, true);
@@ -803,8 +817,8 @@ void solveK14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (r U' r') (U' r U r') y' (R'U R)
-		std::vector<Move> moves = cube.readMoves("(r U' r') (U' r U r') y' (R'U R)");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r U' r') (U' r U r') y' (R'U R)", solution);
+		return OLL_CASE::K1;
 	}
 	// K4
 	else
@@ -818,15 +832,15 @@ void solveK14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 		// perform OLL: (r U r') (R U R' U') (r U' r')
-		std::vector<Move> moves = cube.readMoves("(r U r') (R U R' U') (r U' r')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r U r') (R U R' U') (r U' r')", solution);
+		return OLL_CASE::K4;
 	}
 }
 
 /**
 * Solve OLL cases K2 and K3
 */
-void solveK23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveK23(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face (same for both cases)
 	if (shifts == 1)
@@ -842,22 +856,22 @@ void solveK23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 	if ((cube.getFace(FACE::FRONT) & rowMask.first) == rowMask.second)
 	{
 		// perform OLL: (R' F R) (U R' F' R) (F U' F')
-		std::vector<Move> moves = cube.readMoves("(R' F R) (U R' F' R) (F U' F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R' F R) (U R' F' R) (F U' F')", solution);
+		return OLL_CASE::K2;
 	}
 	// K3
 	else
 	{
 		// perform OLL: (r' U' r) (R' U' R U) (r' U r)
-		std::vector<Move> moves = cube.readMoves("(r' U' r) (R' U' R U) (r' U r)");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r' U' r) (R' U' R U) (r' U r)", solution);
+		return OLL_CASE::K3;
 	}
 }
 
 /**
 * Solve OLL cases B1 and B4
 */
-void solveB14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveB14(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, true, true);
@@ -874,8 +888,8 @@ void solveB14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (r U R' U R U2' r')
-		std::vector<Move> moves = cube.readMoves("(r U R' U R U2' r')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r U R' U R U2' r')", solution);
+		return OLL_CASE::B1;
 	}
 	// B4
 	else
@@ -889,15 +903,15 @@ void solveB14(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: M' (R' U' R U' R' U2 R) U' M
-		std::vector<Move> moves = cube.readMoves("M' (R' U' R U' R' U2 R) U' M");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("M' (R' U' R U' R' U2 R) U' M", solution);
+		return OLL_CASE::B4;
 	}
 }
 
 /**
 * Solve OLL cases B2 and B3
 */
-void solveB23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveB23(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 2 or 3
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -914,8 +928,8 @@ void solveB23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (r' U' R U' R' U2 r)
-		std::vector<Move> moves = cube.readMoves("(r' U' R U' R' U2 r)");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(r' U' R U' R' U2 r)", solution);
+		return OLL_CASE::B2;
 	}
 	// B3
 	else
@@ -929,15 +943,15 @@ void solveB23(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: r' (R2 U R' U R U2 R') U M'
-		std::vector<Move> moves = cube.readMoves("r' (R2 U R' U R U2 R') U M'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("r' (R2 U R' U R U2 R') U M'", solution);
+		return OLL_CASE::B3;
 	}
 }
 
 /**
 * Solve OLL cases I1, I2, I3, and I4
 */
-void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1, 2, 3, or 4
 	// search for a continuous bar
@@ -969,8 +983,8 @@ void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 				solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 			// perform OLL: (R' U' R U' R' U) y' (R' U R) B
-			std::vector<Move> moves = cube.readMoves("(R' U' R U' R' U) y' (R' U R) B");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("(R' U' R U' R' U) y' (R' U R) B", solution);
+			return OLL_CASE::I2;
 		}
 		// I3
 		else
@@ -980,8 +994,8 @@ void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 				solution.push_back(cube.move(FACE::UP));
 
 			// perform OLL: (R' F R U) (R U' R2' F') R2 U' R' (U R U R')
-			std::vector<Move> moves = cube.readMoves("(R' F R U) (R U' R2' F') R2 U' R' (U R U R')");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("(R' F R U) (R U' R2' F') R2 U' R' (U R U R')", solution);
+			return OLL_CASE::I3;
 		}
 	}
 	// I1 or I4
@@ -1007,8 +1021,8 @@ void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 				solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 			// perform OLL: f (R U R' U') (R U R' U') f'
-			std::vector<Move> moves = cube.readMoves("f (R U R' U') (R U R' U') f'");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("f (R U R' U') (R U R' U') f'", solution);
+			return OLL_CASE::I1;
 		}
 		// I4
 		else
@@ -1018,8 +1032,8 @@ void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 				solution.push_back(cube.move(FACE::UP));
 
 			// perform OLL: r' U' r (U' R' U R) (U' R' U R) r' U r
-			std::vector<Move> moves = cube.readMoves("r' U' r (U' R' U R) (U' R' U R) r' U r");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("r' U' r (U' R' U R) (U' R' U R) r' U r", solution);
+			return OLL_CASE::I4;
 		}
 	}
 }
@@ -1027,7 +1041,7 @@ void solveI1234(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& s
 /**
 * Solve OLL cases L1, L2, L3, L4, L5, and L6
 */
-void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1, 2, 3, 4, 5, or 6
 	// search for a continuous bar
@@ -1069,8 +1083,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 				solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 			// perform OLL: F' (L' U' L U) (L' U' L U) F
-			std::vector<Move> moves = cube.readMoves("F' (L' U' L U) (L' U' L U) F");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("F' (L' U' L U) (L' U' L U) F", solution);
+			return OLL_CASE::L1;
 		}
 		// L2
 		else
@@ -1084,8 +1098,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 				solution.push_back(cube.move(FACE::UP));
 
 			// perform OLL: F (R U R' U') (R U R' U') F'
-			std::vector<Move> moves = cube.readMoves("F (R U R' U') (R U R' U') F'");
-			solution.insert(solution.end(), moves.begin(), moves.end());
+			cube.readMoves("F (R U R' U') (R U R' U') F'", solution);
+			return OLL_CASE::L2;
 		}
 	}
 	// L3, L4, L5, or L6
@@ -1110,8 +1124,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 					solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 				// perform OLL: r U' r2' U r2 U r2' U' r
-				std::vector<Move> moves = cube.readMoves("r U' r2' U r2 U r2' U' r");
-				solution.insert(solution.end(), moves.begin(), moves.end());
+				cube.readMoves("r U' r2' U r2 U r2' U' r", solution);
+				return OLL_CASE::L3;
 			}
 			// L4
 			else
@@ -1125,8 +1139,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 					solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 				// perform OLL: r' U r2 U' r2' U' r2 U r'
-				std::vector<Move> moves = cube.readMoves("r' U r2 U' r2' U' r2 U r'");
-				solution.insert(solution.end(), moves.begin(), moves.end());
+				cube.readMoves("r' U r2 U' r2' U' r2 U r'", solution);
+				return OLL_CASE::L4;
 			}
 		}
 		// L5 and L6
@@ -1146,8 +1160,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 					solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 				// perform OLL: (r' U' R U') (R' U R U') R' U2 r 
-				std::vector<Move> moves = cube.readMoves("(r' U' R U') (R' U R U') R' U2 r");
-				solution.insert(solution.end(), moves.begin(), moves.end());
+				cube.readMoves("(r' U' R U') (R' U R U') R' U2 r", solution);
+				return OLL_CASE::L5;
 			}
 			// L6
 			else
@@ -1161,8 +1175,8 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 					solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 				// perform OLL: (r U R' U) (R U' R' U) R U2' r' 
-				std::vector<Move> moves = cube.readMoves("(r U R' U) (R U' R' U) R U2' r'");
-				solution.insert(solution.end(), moves.begin(), moves.end());
+				cube.readMoves("(r U R' U) (R U' R' U) R U2' r'", solution);
+				return OLL_CASE::L6;
 			}
 		}
 	}
@@ -1171,7 +1185,7 @@ void solveL123456(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>&
 /**
 * Solve OLL cases O6 and O7
 */
-void solveO67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveO67(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 6 or 7
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, true);
@@ -1188,8 +1202,8 @@ void solveO67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: R U2' (R2' F R F') U2' M' (U R U' r') 
-		std::vector<Move> moves = cube.readMoves("R U2' (R2' F R F') U2' M' (U R U' r') ");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("R U2' (R2' F R F') U2' M' (U R U' r') ", solution);
+		return OLL_CASE::O6;
 	}
 	// O7
 	else
@@ -1203,15 +1217,15 @@ void solveO67(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: M U (R U R' U') M' (R' F R F')
-		std::vector<Move> moves = cube.readMoves("M U (R U R' U') M' (R' F R F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("M U (R U R' U') M' (R' F R F')", solution);
+		return OLL_CASE::O7;
 	}
 }
 
 /**
 * Solve OLL case O5
 */
-void solveO5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveO5(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// adjust up face
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, false);
@@ -1230,14 +1244,14 @@ void solveO5(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solu
 	}
 
 	// perform OLL: (R U R' U) (R' F R F') U2' (R' F R F')
-	std::vector<Move> moves = cube.readMoves("(R U R' U) (R' F R F') U2' (R' F R F')");
-	solution.insert(solution.end(), moves.begin(), moves.end());
+	cube.readMoves("(R U R' U) (R' F R F') U2' (R' F R F')", solution);
+	return OLL_CASE::O5;
 }
 
 /**
 * Solve OLL cases O3 and O4
 */
-void solveO34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveO34(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 3 or 4
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, false, true, true);
@@ -1254,8 +1268,8 @@ void solveO34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::PRIME));
 
 		// perform OLL: f (R U R' U') f' U' F (R U R' U') F' 
-		std::vector<Move> moves = cube.readMoves("f (R U R' U') f' U' F (R U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("f (R U R' U') f' U' F (R U R' U') F'", solution);
+		return OLL_CASE::O3;
 	}
 	// O4
 	else
@@ -1269,15 +1283,15 @@ void solveO34(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: f (R U R' U') f' U F (R U R' U') F'
-		std::vector<Move> moves = cube.readMoves("f (R U R' U') f' U F (R U R' U') F'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("f (R U R' U') f' U F (R U R' U') F'", solution);
+		return OLL_CASE::O4;
 	}
 }
 
 /**
 * Solve OLL cases O1 and O2
 */
-void solveO12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& solution)
+OLL_CASE solveO12(Cube& cube, COLOR topColor, uint8_t shifts, MoveBuffer& solution)
 {
 	// determine if it's case 1 or 2
 	std::pair<uint64_t, uint64_t> rowMask = generateRowMask(topColor, true, true, true);
@@ -1296,8 +1310,8 @@ void solveO12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP));
 
 		// perform OLL: (R U2') (R2' F R F') U2' (R' F R F')
-		std::vector<Move> moves = cube.readMoves("(R U2') (R2' F R F') U2' (R' F R F')");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("(R U2') (R2' F R F') U2' (R' F R F')", solution);
+		return OLL_CASE::O1;
 	}
 	// O2
 	else
@@ -1311,8 +1325,8 @@ void solveO12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 			solution.push_back(cube.move(FACE::UP, Move::TYPE::DOUBLE));
 
 		// perform OLL: F (R U R' U') F' f (R U R' U') f'
-		std::vector<Move> moves = cube.readMoves("F (R U R' U') F' f (R U R' U') f'");
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves("F (R U R' U') F' f (R U R' U') f'", solution);
+		return OLL_CASE::O2;
 	}
 }
 
@@ -1321,8 +1335,11 @@ void solveO12(Cube& cube, COLOR topColor, uint8_t shifts, std::vector<Move>& sol
 *
 * Assumes the first two layers are solved and that
 * the cross color is oriented down.
+*
+* Returns which case it was (NO_CASE if it was already
+* oriented) and how the up face was adjusted first.
 */
-void solveOLL(Cube& cube, std::vector<Move>& solution)
+LastLayerCase solveOLL(Cube& cube, MoveBuffer& solution)
 {
 	// get the color of the top face
 	COLOR topColor = cube.getCenter(FACE::UP);
@@ -1338,71 +1355,77 @@ void solveOLL(Cube& cube, std::vector<Move>& solution)
 		}
 	}
 
+	LastLayerCase ollCase = { NO_CASE, 0, 0 };
 	if (solved)
-		return;
+		return ollCase;
+	size_t start = solution.size();
 
 	// find the OLL type
 	std::pair<uint8_t, uint8_t> ollType = findOLLType(cube, topColor);
 
 	// solve OLL based on the type
 	if (ollType.first == olls[0])
-		solveOCLL34(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveOCLL34(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[1])
-		solveOCLL5(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveOCLL5(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[2])
-		solveE1(cube, ollType.second, solution);
+		ollCase.id = (uint8_t)solveE1(cube, ollType.second, solution);
 	else if (ollType.first == olls[3])
-		solveE2(cube, ollType.second, solution);
+		ollCase.id = (uint8_t)solveE2(cube, ollType.second, solution);
 	else if (ollType.first == olls[4])
-		solveOCLL67(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveOCLL67(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[5])
-		solveOCLL12(cube, topColor, solution);
+		ollCase.id = (uint8_t)solveOCLL12(cube, topColor, solution);
 	else if (ollType.first == olls[6])
-		solveT12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveT12(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[7])
-		solveC12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveC12(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[8])
-		solveW12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveW12(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[9])
-		solveP13(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveP13(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[10])
-		solveP24(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveP24(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[11])
-		solveF34(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveF34(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[12])
-		solveA14(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveA14(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[13])
-		solveA23(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveA23(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[14])
-		solveB5(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveB5(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[15])
-		solveB6(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveB6(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[16])
-		solveO8(cube, solution);
+		ollCase.id = (uint8_t)solveO8(cube, solution);
 	else if (ollType.first == olls[17])
-		solveS12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveS12(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[18])
-		solveF12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveF12(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[19])
-		solveK14(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveK14(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[20])
-		solveK23(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveK23(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[21])
-		solveB14(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveB14(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[22])
-		solveB23(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveB23(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[23])
-		solveI1234(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveI1234(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[24])
-		solveL123456(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveL123456(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[25])
-		solveO67(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveO67(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[26])
-		solveO5(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveO5(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[27])
-		solveO34(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveO34(cube, topColor, ollType.second, solution);
 	else if (ollType.first == olls[28])
-		solveO12(cube, topColor, ollType.second, solution);
+		ollCase.id = (uint8_t)solveO12(cube, topColor, ollType.second, solution);
 
-	solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
+	// no algorithm starts with a U turn, so one at the start
+	// is the adjustment of the up face
+	if (solution.size() > start && solution[start].pieces == Move::PIECES::UP)
+		ollCase.preAUF = aufTurns[(uint8_t)solution[start].type];
+	return ollCase;
 }
@@ -8,8 +8,31 @@ typedef Cube::COLOR COLOR;
 typedef Cube::FACE FACE;
 
 /**
-* Orient the last layer on the given cube.
+* Total number of OLLs.
 */
-void solveOLL(Cube& cube, std::vector<Move>& solution);
+const uint8_t NUM_OLLS = 57;
+
+/**
+* Every OLL case, named as in the resource the algorithms come from.
+*/
+enum class OLL_CASE : uint8_t
+{
+	OCLL1, OCLL2, OCLL3, OCLL4, OCLL5, OCLL6, OCLL7, E1, E2,
+	T1, T2, C1, C2, W1, W2, P1, P2, P3, P4, F1, F2, F3, F4,
+	A1, A2, A3, A4, B1, B2, B3, B4, B5, B6, S1, S2, K1, K2, K3, K4,
+	I1, I2, I3, I4, L1, L2, L3, L4, L5, L6,
+	O1, O2, O3, O4, O5, O6, O7, O8
+};
+
+/**
+* Name of each OLL case, indexed by OLL_CASE.
+*/
+extern const char* const ollNames[NUM_OLLS];
+
+/**
+* Orient the last layer on the given cube, returning
+* which case it was.
+*/
+LastLayerCase solveOLL(Cube& cube, MoveBuffer& solution);
 
 #endif
@@ -1,13 +1,6 @@
-#include <iostream>
-
 #include "SolverPLL.h"
 #include "Util.h"
 
-/**
-* Total number of PLLs.
-*/
-const uint8_t NUM_PLLS = 21;
-
 /**
 * Values corresponding to every single PLL case.
 *
@@ -23,7 +16,7 @@ const uint8_t NUM_PLLS = 21;
 * The algorithms used in this solver come from this resource:
 * https://www.cubeskills.com/uploads/pdf/tutorials/pll-algorithms.pdf
 */
-uint64_t plls[NUM_PLLS] = {
+const uint64_t plls[NUM_PLLS] = {
 	((uint64_t)0 << 56) | ((uint64_t)1 << 48) | ((uint64_t)2 << 40) | ((uint64_t)7 << 32) | ((uint64_t)4 << 24) | ((uint64_t)3 << 16) | ((uint64_t)6 << 8) | ((uint64_t)5 << 0), // Ua
 	((uint64_t)0 << 56) | ((uint64_t)1 << 48) | ((uint64_t)2 << 40) | ((uint64_t)5 << 32) | ((uint64_t)4 << 24) | ((uint64_t)7 << 16) | ((uint64_t)6 << 8) | ((uint64_t)3 << 0), // Ub
 	((uint64_t)0 << 56) | ((uint64_t)7 << 48) | ((uint64_t)2 << 40) | ((uint64_t)5 << 32) | ((uint64_t)4 << 24) | ((uint64_t)3 << 16) | ((uint64_t)6 << 8) | ((uint64_t)1 << 0), // Z
@@ -53,7 +46,7 @@ uint64_t plls[NUM_PLLS] = {
 * The name of each algorithm is commented on each line, and the
 * order matches the plls array above.
 */
-std::string pllAlgs[NUM_PLLS] = {
+const char* const pllAlgs[NUM_PLLS] = {
 	"(R U' R U) R U (R U' R' U') R2",								   // Ua
 	"R2 U (R U R' U') R' U' (R' U R')",								   // Ub
 	"(M2' U M2' U) (M' U2) (M2' U2 M')",							   // Z
@@ -77,6 +70,14 @@ std::string pllAlgs[NUM_PLLS] = {
 	"D' (R U R' U') D (R2 U' R U') (R' U R' U) R2"					   // Gd
 };
 
+/**
+* Names of every PLL, in the same order as the arrays above.
+*/
+const char* const pllNames[NUM_PLLS] = {
+	"Ua", "Ub", "Z", "H", "Aa", "Ab", "E", "Ra", "Rb", "Ja", "Jb",
+	"T", "F", "V", "Y", "Na", "Nb", "Ga", "Gb", "Gc", "Gd"
+};
+
 /**
 * Return the index into the faces array for the given face.
 *
@@ -300,10 +301,15 @@ std::pair<uint8_t, uint8_t> findPLLType(Cube& cube)
 *
 * Assumes that first two layers are solved and that
 * the last layer has been oriented.
+*
+* Returns which case it was (NO_CASE if it was already
+* permuted) and how the up face was adjusted before and
+* after it.
 */
-void solvePLL(Cube& cube, std::vector<Move>& solution)
+LastLayerCase solvePLL(Cube& cube, MoveBuffer& solution)
 {
 	std::pair<uint8_t, uint8_t> pll = findPLLType(cube);
+	LastLayerCase pllCase = { pll.first != NUM_PLLS ? pll.first : NO_CASE, (uint8_t)((4 - pll.second) & 3), 0 };
 
 	// adjust up face
 	if (pll.second == 1)
@@ -316,8 +322,7 @@ void solvePLL(Cube& cube, std::vector<Move>& solution)
 	// perform PLL (if needed)
 	if (pll.first != NUM_PLLS)
 	{
-		std::vector<Move> moves = cube.readMoves(pllAlgs[pll.first]);
-		solution.insert(solution.end(), moves.begin(), moves.end());
+		cube.readMoves(pllAlgs[pll.first], solution);
 	}
 
 	// adjust up face
@@ -334,5 +339,6 @@ void solvePLL(Cube& cube, std::vector<Move>& solution)
 	else if (numTurns == 3)
 		solution.push_back(Move(Move::PIECES::UP, Move::TYPE::PRIME));
 
-	solution.push_back(Move(Move::PIECES::Y, Move::TYPE::NO_MOVE));
+	pllCase.postAUF = numTurns;
+	return pllCase;
 }
@@ -8,8 +8,19 @@ typedef Cube::COLOR COLOR;
 typedef Cube::FACE FACE;
 
 /**
-* Permute the last layer on the given cube.
+* Total number of PLLs.
 */
-void solvePLL(Cube& cube, std::vector<Move>& solution);
+const uint8_t NUM_PLLS = 21;
+
+/**
+* Name of each PLL, indexed by its case id.
+*/
+extern const char* const pllNames[NUM_PLLS];
+
+/**
+* Permute the last layer on the given cube, returning
+* which case it was.
+*/
+LastLayerCase solvePLL(Cube& cube, MoveBuffer& solution);
 
 #endif
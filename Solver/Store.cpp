@@ -0,0 +1,323 @@
+#include <atomic>
+#include <string.h>
+#include <vector>
+
+#include "Store.h"
+#include "Symmetry.h"
+
+/**
+ * The start of a store file. Counts are atomic, since processes
+ * reading the file see them change as the writer adds solutions.
+ */
+struct SolutionStore::Header
+{
+	char magic[4];
+	uint32_t symmetric;
+	uint64_t optionsHash;
+	uint64_t numSlots;
+	uint64_t heapStart;
+	uint64_t heapEnd;
+	std::atomic<uint64_t> heapUsed;
+	std::atomic<uint64_t> count;
+	uint64_t reserved;
+};
+
+/**
+ * One slot of the table: a packed cube, and the offset of its solution
+ * from the start of the file, which is 0 while the slot is empty.
+ */
+struct SolutionStore::Slot
+{
+	uint64_t key[Cube::PACKED_WORDS];
+	std::atomic<uint64_t> offset;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "atomic counts must match the file layout");
+
+/**
+ * Room for solutions in a new store, for each one it can hold. An
+ * optimized solution takes about 60 bytes with its phases.
+ */
+const size_t STORE_BYTES_PER_SOLUTION = 96;
+
+/**
+ * Hash the options a store's solutions are found with, so a store isn't
+ * opened with different ones (the same goes for batch checkpoints).
+ */
+uint64_t hashOptions(const SolveOptions& options)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 0x100000001b3; };
+	mix(options.optimize);
+	mix((uint64_t)options.metric);
+	mix((uint64_t)options.moveSet);
+	mix(options.restriction.allowed);
+	for (float cost : options.restriction.costs)
+	{
+		uint32_t bits;
+		memcpy(&bits, &cost, sizeof(bits));
+		mix(bits);
+	}
+	mix(options.minimizeTime);
+	// only mixed in when set, so stores made before it still open
+	if (options.fast)
+		mix(options.fast);
+	if (options.budget > 0)
+		mix((uint64_t)(options.budget * 1e6));
+	if (options.minimizeTime)
+	{
+		mix(options.timing.quarterTurn);
+		mix(options.timing.halfTurn);
+		mix(options.timing.settle);
+	}
+	return hash;
+}
+
+/**
+ * Append a stored solution to the given bytes: the packed solution,
+ * followed by its number of phases, each phase and where it ends, and
+ * its last layer cases.
+ */
+void packStoredSolution(const Solution& solution, std::vector<uint8_t>& bytes)
+{
+	packSolution(solution, bytes);
+	uint8_t varint[MAX_VARINT_BYTES];
+	bytes.push_back(solution.numPhases);
+	for (uint8_t i = 0; i < solution.numPhases; i++)
+	{
+		bytes.push_back((uint8_t)solution.phases[i].phase);
+		bytes.insert(bytes.end(), varint, varint + writeVarint(solution.phases[i].end, varint));
+	}
+	for (const LastLayerCase* llCase : { &solution.oll, &solution.pll })
+		bytes.insert(bytes.end(), { llCase->id, llCase->preAUF, llCase->postAUF });
+}
+
+/**
+ * Unpack a stored solution, returning false if the bytes don't hold a
+ * valid one. Each phase begins where the last one ended.
+ */
+bool unpackStoredSolution(const uint8_t* bytes, size_t size, Solution& solution)
+{
+	size_t read = unpackSolution(bytes, size, solution);
+	if (read == 0 || read >= size || bytes[read] > MAX_PHASES)
+		return false;
+	solution.numPhases = bytes[read++];
+	uint16_t begin = 0;
+	for (uint8_t i = 0; i < solution.numPhases; i++)
+	{
+		uint64_t end;
+		if (read >= size || bytes[read] > (uint8_t)PHASE::PLL)
+			return false;
+		PHASE phase = (PHASE)bytes[read++];
+		size_t length = readVarint(bytes + read, size - read, end);
+		if (length == 0 || end < begin || end > solution.size())
+			return false;
+		read += length;
+		solution.phases[i] = { phase, begin, (uint16_t)end };
+		begin = (uint16_t)end;
+	}
+	if (size - read < 6)
+		return false;
+	solution.oll = { bytes[read], bytes[read + 1], bytes[read + 2] };
+	solution.pll = { bytes[read + 3], bytes[read + 4], bytes[read + 5] };
+	return true;
+}
+
+SolutionStore::SolutionStore() : writable(false), header(nullptr), slots(nullptr) {}
+
+/**
+ * Open the store at the given path for reading.
+ */
+bool SolutionStore::open(const std::string& path, const SolveOptions& options)
+{
+	close();
+	if (!file.open(path) || !attach(options))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Open the store at the given path for writing, creating it if it
+ * doesn't exist.
+ *
+ * The table has a power of two slots, at least a third more than the
+ * capacity. The file is grown to fit that much, which only leaves a
+ * hole if it already exists. A new file is filled in before its magic
+ * bytes are written, so a reader never opens one half made.
+ */
+bool SolutionStore::openForWriting(const std::string& path, const SolveOptions& options, size_t capacity, bool symmetric)
+{
+	close();
+	uint64_t numSlots = 1;
+	while (numSlots * 3 / 4 < capacity)
+		numSlots *= 2;
+	uint64_t heapStart = sizeof(Header) + numSlots * sizeof(Slot);
+	uint64_t heapEnd = heapStart + (capacity > 0 ? capacity : 1) * STORE_BYTES_PER_SOLUTION;
+	if (!file.openWritable(path, (size_t)heapEnd))
+		return false;
+
+	Header* created = (Header*)file.writableData();
+	if (memcmp(created->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0)
+	{
+		// a new file, or one whose creator was cut short before any slot
+		// was filled in, so only the header needs clearing (which keeps
+		// the table's pages from being touched)
+		memset(file.writableData(), 0, sizeof(Header));
+		created->symmetric = symmetric && options.restriction.isDefault() && !options.minimizeTime;
+		created->optionsHash = hashOptions(options);
+		created->numSlots = numSlots;
+		created->heapStart = heapStart;
+		created->heapEnd = heapEnd;
+		created->heapUsed.store(heapStart);
+		created->count.store(0);
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(created->magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+	}
+
+	writable = true;
+	if (!attach(options))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Check the mapped file is a store made with the given options, and
+ * find its table.
+ */
+bool SolutionStore::attach(const SolveOptions& options)
+{
+	const Header* mapped = (const Header*)file.data();
+	if (file.size() < sizeof(Header) || memcmp(mapped->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 ||
+		mapped->optionsHash != hashOptions(options) || mapped->numSlots == 0 ||
+		(mapped->numSlots & (mapped->numSlots - 1)) != 0 ||
+		mapped->heapStart != sizeof(Header) + mapped->numSlots * sizeof(Slot) || mapped->heapEnd > file.size())
+		return false;
+
+	solveOptions = options;
+	header = (Header*)mapped;
+	slots = (Slot*)(file.data() + sizeof(Header));
+	return true;
+}
+
+void SolutionStore::close()
+{
+	file.close();
+	writable = false;
+	header = nullptr;
+	slots = nullptr;
+}
+
+/**
+ * Replace the given cube with its key, returning the symmetry that was
+ * applied to it.
+ */
+uint8_t SolutionStore::canonicalKey(Cube& cube) const
+{
+	return canonicalize(cube, header->symmetric != 0, header->symmetric != 0);
+}
+
+/**
+ * Find the slot holding the given key, or the empty slot where it
+ * belongs. The table is never full, so an empty slot is always found.
+ */
+const SolutionStore::Slot* SolutionStore::findSlot(const uint64_t key[Cube::PACKED_WORDS], uint64_t hash) const
+{
+	uint64_t mask = header->numSlots - 1;
+	for (uint64_t i = hash & mask;; i = (i + 1) & mask)
+	{
+		const Slot& slot = slots[i];
+		if (slot.offset.load(std::memory_order_acquire) == 0 ||
+			memcmp(slot.key, key, sizeof(slot.key)) == 0)
+			return &slot;
+	}
+}
+
+/**
+ * Find the stored solution for the given cube, conjugated back to it.
+ */
+bool SolutionStore::find(const Cube& cube, Solution& solution) const
+{
+	if (header == nullptr)
+		return false;
+	Cube key = cube;
+	uint8_t symmetry = canonicalKey(key);
+	uint64_t packed[Cube::PACKED_WORDS];
+	key.pack(packed);
+
+	const Slot* slot = findSlot(packed, key.hash());
+	uint64_t offset = slot->offset.load(std::memory_order_acquire);
+	if (offset < header->heapStart || offset >= header->heapEnd ||
+		!unpackStoredSolution(file.data() + offset, (size_t)(header->heapEnd - offset), solution))
+		return false;
+	if (symmetry != 0)
+		conjugateSolution(solution, symmetry);
+	return true;
+}
+
+/**
+ * Store a solution for the given cube, as the solution for its
+ * canonical form.
+ *
+ * Room for the solution is claimed before it's written, and its slot
+ * is filled in last, so a writer cut short at any point leaves at worst
+ * some unused bytes.
+ */
+bool SolutionStore::insert(const Cube& cube, const Solution& solution)
+{
+	if (!writable)
+		return false;
+	Cube key = cube;
+	uint8_t symmetry = canonicalKey(key);
+	uint64_t packed[Cube::PACKED_WORDS];
+	key.pack(packed);
+
+	Slot* slot = (Slot*)findSlot(packed, key.hash());
+	if (slot->offset.load(std::memory_order_relaxed) != 0)
+		return true;
+	uint64_t count = header->count.load(std::memory_order_relaxed);
+	if (count + 1 > header->numSlots * 3 / 4)
+		return false;
+
+	std::vector<uint8_t> bytes;
+	if (symmetry == 0)
+		packStoredSolution(solution, bytes);
+	else
+	{
+		Solution canonical = solution;
+		conjugateSolution(canonical, symmetry, true);
+		packStoredSolution(canonical, bytes);
+	}
+	uint64_t offset = header->heapUsed.load(std::memory_order_relaxed);
+	if (offset + bytes.size() > header->heapEnd)
+		return false;
+	header->heapUsed.store(offset + bytes.size(), std::memory_order_release);
+
+	memcpy(file.writableData() + offset, bytes.data(), bytes.size());
+	memcpy(slot->key, packed, sizeof(packed));
+	slot->offset.store(offset, std::memory_order_release);
+	header->count.store(count + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * Solve the given cube, using the stored solution if there is one.
+ */
+Solution SolutionStore::solve(const Cube& cube)
+{
+	Solution solution;
+	if (find(cube, solution))
+		return solution;
+	solution = ::solve(cube, solveOptions);
+	insert(cube, solution);
+	return solution;
+}
+
+size_t SolutionStore::size() const { return header != nullptr ? (size_t)header->count.load(std::memory_order_acquire) : 0; }
+
+size_t SolutionStore::capacity() const { return header != nullptr ? (size_t)(header->numSlots * 3 / 4) : 0; }
@@ -0,0 +1,114 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "MappedFile.h"
+#include "Solver.h"
+
+/**
+ * Magic bytes at the start of a solution store file.
+ */
+const char STORE_MAGIC[4] = { 'C', 'S', 'S', '1' };
+
+/**
+ * Hash the given options, so files of solutions found with one set of
+ * options (stores, and batch checkpoints) aren't used with another.
+ */
+uint64_t hashOptions(const SolveOptions& options);
+
+class SolutionStore
+{
+	/**
+	 * This class keeps solutions in a file that lasts between runs and is
+	 * shared by every process that opens it.
+	 *
+	 * The file is an open addressing hash table, probed linearly, of
+	 * cubes (in their canonical form, see canonicalize) and where each
+	 * one's solution is kept, followed by the solutions themselves. Both
+	 * are sized when the file is created and never move, so opening it
+	 * only maps it into memory, and a lookup touches the slot's page and
+	 * the solution's page.
+	 *
+	 * One process at a time can open the file for writing, appending
+	 * solutions as it goes. Each solution is written before its slot is
+	 * filled in, so processes reading the file never see one half
+	 * written, and one that was cut short is never seen at all. Entries
+	 * are never changed or removed, and the file is full once its table
+	 * is three quarters full or it runs out of room for solutions.
+	 *
+	 * A store only holds solutions found with the options it was created
+	 * with, and opening it with any others fails.
+	 */
+
+public:
+	SolutionStore();
+
+	/**
+	 * Open the store at the given path for reading, returning false if it
+	 * doesn't exist or was made with different options.
+	 */
+	bool open(const std::string& path, const SolveOptions& options);
+
+	/**
+	 * Open the store at the given path for writing, creating it with room
+	 * for the given number of solutions if it doesn't exist. Return false
+	 * if it was made with different options, or another process is
+	 * writing to it.
+	 *
+	 * A symmetric store keys cubes by the least of their symmetries, like
+	 * a symmetric SolutionCache. Capacity and symmetry are only used when
+	 * creating the store.
+	 */
+	bool openForWriting(const std::string& path, const SolveOptions& options, size_t capacity, bool symmetric = false);
+
+	void close();
+	bool isOpen() const { return file.isOpen(); }
+	bool isWritable() const { return writable; }
+
+	/**
+	 * Find the stored solution for the given cube, returning false if
+	 * there isn't one.
+	 */
+	bool find(const Cube& cube, Solution& solution) const;
+
+	/**
+	 * Store a solution for the given cube, returning false if the store
+	 * is full or isn't open for writing. A cube that's already stored
+	 * keeps its solution.
+	 */
+	bool insert(const Cube& cube, const Solution& solution);
+
+	/**
+	 * Solve the given cube, using the stored solution if there is one,
+	 * and storing the new one otherwise if the store is writable.
+	 */
+	Solution solve(const Cube& cube);
+
+	/**
+	 * Number of solutions stored, and the most the store can hold.
+	 */
+	size_t size() const;
+	size_t capacity() const;
+
+private:
+	SolutionStore(const SolutionStore&);
+	SolutionStore& operator=(const SolutionStore&);
+
+	struct Header;
+	struct Slot;
+
+	bool attach(const SolveOptions& options);
+	uint8_t canonicalKey(Cube& cube) const;
+	const Slot* findSlot(const uint64_t key[Cube::PACKED_WORDS], uint64_t hash) const;
+
+	MappedFile file;
+	bool writable;
+	SolveOptions solveOptions;
+	Header* header;
+	Slot* slots;
+};
+
+#endif
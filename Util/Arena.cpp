@@ -0,0 +1,93 @@
+#include <stdlib.h>
+
+#include "Arena.h"
+
+/**
+ * Bytes at the start of each block holding its header, keeping the
+ * memory after it suitably aligned.
+ */
+const size_t BLOCK_HEADER = 64;
+
+Arena::Arena(size_t size) : first(nullptr), current(nullptr), used(0), blockSize(size) {}
+
+Arena::~Arena()
+{
+	while (first != nullptr)
+	{
+		Block* next = first->next;
+		free(first);
+		first = next;
+	}
+}
+
+/**
+ * Allocate the given number of bytes with the given alignment.
+ *
+ * If the current block is full, move on to the next one, adding a
+ * new block after it if there isn't one with enough room.
+ */
+void* Arena::allocate(size_t size, size_t alignment)
+{
+	if (current != nullptr)
+	{
+		size_t start = (used + alignment - 1) & ~(alignment - 1);
+		if (start + size <= current->size)
+		{
+			used = start + size;
+			return (char*)current + BLOCK_HEADER + start;
+		}
+	}
+
+	// blocks are aligned well past anything stored in them, so a fresh one always fits
+	Block* next = current != nullptr ? current->next : first;
+	if (next == nullptr || next->size < size)
+	{
+		size_t nextSize = size > blockSize ? size : blockSize;
+		Block* block = (Block*)malloc(BLOCK_HEADER + nextSize);
+		if (block == nullptr)
+			throw std::bad_alloc();
+		block->size = nextSize;
+		block->next = next;
+		if (current != nullptr)
+			current->next = block;
+		else
+			first = block;
+		next = block;
+	}
+
+	current = next;
+	used = size;
+	return (char*)current + BLOCK_HEADER;
+}
+
+/**
+ * Get the current position in the arena.
+ */
+Arena::Marker Arena::mark() const { return { current, used }; }
+
+/**
+ * Free everything allocated since the given position.
+ */
+void Arena::rewind(const Marker& marker)
+{
+	current = (Block*)marker.block;
+	used = marker.used;
+}
+
+/**
+ * Free everything in the arena (keeping its blocks).
+ */
+void Arena::reset()
+{
+	current = nullptr;
+	used = 0;
+}
+
+/**
+ * The calling thread's arena.
+ */
+Arena& Arena::local()
+{
+	static thread_local Arena arena;
+	return arena;
+}
@@ -0,0 +1,100 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <new>
+
+class Arena
+{
+	/**
+	 * This class hands out scratch memory by bumping a pointer through
+	 * large blocks, which are kept for reuse when the arena is rewound
+	 * rather than freed. Once its blocks are big enough for the work it
+	 * does, an arena never allocates again.
+	 *
+	 * Objects in an arena are never destroyed, so they should be
+	 * trivially destructible.
+	 */
+
+public:
+	explicit Arena(size_t blockSize = 64 * 1024);
+	~Arena();
+
+	/**
+	 * A position in the arena to rewind to.
+	 */
+	struct Marker
+	{
+		void* block;
+		size_t used;
+	};
+
+	/**
+	 * Allocate the given number of bytes with the given alignment.
+	 */
+	void* allocate(size_t size, size_t alignment);
+
+	/**
+	 * Allocate and default construct the given number of objects.
+	 */
+	template <typename T>
+	T* allocate(size_t count)
+	{
+		T* objects = (T*)allocate(sizeof(T) * count, alignof(T));
+		for (size_t i = 0; i < count; i++)
+			new (objects + i) T();
+		return objects;
+	}
+
+	/**
+	 * Get the current position, and free everything allocated since
+	 * the given position.
+	 */
+	Marker mark() const;
+	void rewind(const Marker& marker);
+
+	/**
+	 * Free everything in the arena (keeping its blocks).
+	 */
+	void reset();
+
+	/**
+	 * The calling thread's arena.
+	 */
+	static Arena& local();
+
+private:
+	Arena(const Arena&);
+	Arena& operator=(const Arena&);
+
+	struct Block
+	{
+		Block* next;
+		size_t size;
+	};
+
+	Block* first;
+	Block* current;
+	size_t used;
+	size_t blockSize;
+};
+
+/**
+ * Rewinds the given arena to where it was when this was created, once
+ * this goes out of scope.
+ */
+class ArenaScope
+{
+public:
+	explicit ArenaScope(Arena& scopeArena) : arena(scopeArena), marker(scopeArena.mark()) {}
+	~ArenaScope() { arena.rewind(marker); }
+
+private:
+	ArenaScope(const ArenaScope&);
+	ArenaScope& operator=(const ArenaScope&);
+
+	Arena& arena;
+	Arena::Marker marker;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+template <typename T>
+class BoundedQueue
+{
+	/**
+	 * This class is a fixed-size queue that any number of threads can
+	 * push to and pop from without locks.
+	 *
+	 * Each cell has a sequence number saying whose turn it is: a pusher
+	 * may fill the cell once its sequence reaches the pusher's position,
+	 * and a popper may empty it once it's one past. Claiming a position
+	 * is a single compare-and-swap, and the cell's sequence is only
+	 * written by the thread that claimed it, so threads only contend on
+	 * the two positions.
+	 *
+	 * Push and pop wait while the queue is full or empty, which is what
+	 * holds back a faster stage of a pipeline. They yield the thread at
+	 * first, then sleep briefly between tries, so a stage that's waiting
+	 * on a slower one doesn't take its time.
+	 */
+
+public:
+	/**
+	 * Create a queue holding up to the given number of items, rounded
+	 * up to a power of two.
+	 */
+	explicit BoundedQueue(size_t capacity) : head(0), tail(0)
+	{
+		size = 2;
+		while (size < capacity)
+			size *= 2;
+		cells.reset(new Cell[size]);
+		for (size_t i = 0; i < size; i++)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Add the given item to the back of the queue, returning false if
+	 * it's full.
+	 */
+	bool tryPush(const T& item)
+	{
+		size_t position = tail.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell& cell = cells[position & (size - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if (sequence == position)
+			{
+				if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.item = item;
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if ((ptrdiff_t)(sequence - position) < 0)
+				return false;
+			else
+				position = tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Take the item at the front of the queue, returning false if it's
+	 * empty.
+	 */
+	bool tryPop(T& item)
+	{
+		size_t position = head.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell& cell = cells[position & (size - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if (sequence == position + 1)
+			{
+				if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					item = cell.item;
+					cell.sequence.store(position + size, std::memory_order_release);
+					return true;
+				}
+			}
+			else if ((ptrdiff_t)(sequence - position - 1) < 0)
+				return false;
+			else
+				position = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Add an item, or take one, waiting until there's room or an item.
+	 */
+	void push(const T& item)
+	{
+		for (uint32_t tries = 0; !tryPush(item); tries++)
+			wait(tries);
+	}
+	T pop()
+	{
+		T item;
+		for (uint32_t tries = 0; !tryPop(item); tries++)
+			wait(tries);
+		return item;
+	}
+
+private:
+	BoundedQueue(const BoundedQueue&);
+	BoundedQueue& operator=(const BoundedQueue&);
+
+	static void wait(uint32_t tries)
+	{
+		if (tries < 64)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T item;
+	};
+
+	size_t size;
+	std::unique_ptr<Cell[]> cells;
+	// padded so pushers and poppers don't share a cache line
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LANES_H
+#define LANES_H
+
+#include <stdint.h>
+
+/**
+ * Two 64-bit lanes worked on at once, for the turns that move rows
+ * around all four side faces together (see Cube::turnSideRows).
+ *
+ * Built on WASM SIMD128 when compiling for the web with -msimd128, on
+ * SSE2 on x86, and on a pair of integers anywhere else, so every build
+ * runs the same kernels. selectLanes takes the bits of b where the mask
+ * is set and of a everywhere else, and swapLanes swaps the two lanes.
+ */
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+
+typedef v128_t Lanes;
+
+inline Lanes loadLanes(const uint64_t* words) { return wasm_v128_load(words); }
+inline void storeLanes(uint64_t* words, Lanes lanes) { wasm_v128_store(words, lanes); }
+inline Lanes splatLanes(uint64_t word) { return wasm_i64x2_splat((int64_t)word); }
+inline Lanes selectLanes(Lanes a, Lanes b, Lanes mask) { return wasm_v128_bitselect(b, a, mask); }
+inline Lanes swapLanes(Lanes lanes) { return wasm_i64x2_shuffle(lanes, lanes, 1, 0); }
+
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+typedef __m128i Lanes;
+
+inline Lanes loadLanes(const uint64_t* words) { return _mm_loadu_si128((const __m128i*)words); }
+inline void storeLanes(uint64_t* words, Lanes lanes) { _mm_storeu_si128((__m128i*)words, lanes); }
+inline Lanes splatLanes(uint64_t word) { return _mm_set1_epi64x((long long)word); }
+inline Lanes selectLanes(Lanes a, Lanes b, Lanes mask)
+{
+	return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+inline Lanes swapLanes(Lanes lanes) { return _mm_shuffle_epi32(lanes, _MM_SHUFFLE(1, 0, 3, 2)); }
+
+#else
+
+struct Lanes
+{
+	uint64_t low;
+	uint64_t high;
+};
+
+inline Lanes loadLanes(const uint64_t* words) { return { words[0], words[1] }; }
+inline void storeLanes(uint64_t* words, Lanes lanes)
+{
+	words[0] = lanes.low;
+	words[1] = lanes.high;
+}
+inline Lanes splatLanes(uint64_t word) { return { word, word }; }
+inline Lanes selectLanes(Lanes a, Lanes b, Lanes mask)
+{
+	return { (a.low & ~mask.low) | (b.low & mask.low), (a.high & ~mask.high) | (b.high & mask.high) };
+}
+inline Lanes swapLanes(Lanes lanes) { return { lanes.high, lanes.low }; }
+
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), mapped(false), descriptor(-1) {}
+
+MappedFile::~MappedFile() { close(); }
+
+/**
+ * Map the file at the given path, returning false if it
+ * can't be opened. An empty file can't be mapped.
+ */
+bool MappedFile::open(const std::string& path)
+{
+	close();
+#ifndef _WIN32
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* addr = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+	if (addr == MAP_FAILED)
+		return false;
+
+	bytes = (const uint8_t*)addr;
+	length = (size_t)info.st_size;
+	mapped = true;
+	return true;
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (fileSize <= 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	uint8_t* buffer = (uint8_t*)malloc((size_t)fileSize);
+	if (buffer == nullptr || fread(buffer, 1, (size_t)fileSize, file) != (size_t)fileSize)
+	{
+		free(buffer);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	bytes = buffer;
+	length = (size_t)fileSize;
+	mapped = false;
+	return true;
+#endif
+}
+
+/**
+ * Map the file at the given path for reading and writing, creating it
+ * or growing it to at least the given size.
+ *
+ * The file is locked with flock, which is released when the descriptor
+ * is closed, so a writer that crashes doesn't leave it locked. Growing
+ * the file leaves a hole, so untouched pages take no disk space.
+ */
+bool MappedFile::openWritable(const std::string& path, size_t minSize)
+{
+	close();
+#ifndef _WIN32
+	int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &info) != 0 ||
+		((size_t)info.st_size < minSize && ftruncate(fd, (off_t)minSize) != 0))
+	{
+		::close(fd);
+		return false;
+	}
+	size_t fileSize = (size_t)info.st_size < minSize ? minSize : (size_t)info.st_size;
+	if (fileSize == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* addr = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED)
+	{
+		::close(fd);
+		return false;
+	}
+
+	bytes = (const uint8_t*)addr;
+	length = fileSize;
+	mapped = true;
+	descriptor = fd;
+	return true;
+#else
+	(void)path;
+	(void)minSize;
+	return false;
+#endif
+}
+
+/**
+ * Unmap the file, if one is mapped.
+ */
+void MappedFile::close()
+{
+	if (bytes == nullptr)
+		return;
+#ifndef _WIN32
+	if (mapped)
+		munmap((void*)bytes, length);
+	else
+		free((void*)bytes);
+	if (descriptor >= 0)
+		::close(descriptor);
+#else
+	free((void*)bytes);
+#endif
+	bytes = nullptr;
+	length = 0;
+	mapped = false;
+	descriptor = -1;
+}
+
+bool MappedFile::isOpen() const { return bytes != nullptr; }
+
+const uint8_t* MappedFile::data() const { return bytes; }
+
+size_t MappedFile::size() const { return length; }
+
+uint8_t* MappedFile::writableData() { return descriptor >= 0 ? (uint8_t*)bytes : nullptr; }
@@ -0,0 +1,69 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class MappedFile
+{
+	/**
+	 * This class maps a file read-only into memory.
+	 *
+	 * On POSIX systems the file is memory-mapped, so opening it
+	 * costs nothing up front and the pages are shared between every
+	 * process mapping the same file. Elsewhere the file is simply
+	 * read into a buffer.
+	 */
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	/**
+	 * Map the file at the given path, returning false if it
+	 * can't be opened.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * Map the file at the given path for reading and writing, creating
+	 * it or growing it to at least the given size (filled with zeros).
+	 * Return false if it can't be opened, or another process has it
+	 * open for writing.
+	 */
+	bool openWritable(const std::string& path, size_t minSize);
+
+	/**
+	 * Unmap the file, if one is mapped.
+	 */
+	void close();
+
+	/**
+	 * Check if a file is currently mapped.
+	 */
+	bool isOpen() const;
+
+	/**
+	 * The mapped bytes and how many there are.
+	 */
+	const uint8_t* data() const;
+	size_t size() const;
+
+	/**
+	 * The mapped bytes, or null if the file isn't open for writing.
+	 */
+	uint8_t* writableData();
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const uint8_t* bytes;
+	size_t length;
+	bool mapped;
+	// held open while writable, to keep the file locked
+	int descriptor;
+};
+
+#endif
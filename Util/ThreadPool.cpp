@@ -0,0 +1,176 @@
+#include "ThreadPool.h"
+
+/**
+ * Pack a range of indices into a single word, and unpack it.
+ */
+uint64_t packRange(uint32_t begin, uint32_t end) { return ((uint64_t)begin << 32) | end; }
+uint32_t rangeBegin(uint64_t bounds) { return (uint32_t)(bounds >> 32); }
+uint32_t rangeEnd(uint64_t bounds) { return (uint32_t)bounds; }
+
+/**
+ * Create a pool of the given number of threads, counting the thread
+ * that calls parallelFor. Zero uses one per hardware thread.
+ */
+ThreadPool::ThreadPool(size_t threads) :
+	numThreads(threads != 0 ? threads : std::thread::hardware_concurrency()),
+	task(nullptr), context(nullptr), offset(0), remaining(0), generation(0), active(0), stopping(false)
+{
+	if (numThreads == 0)
+		numThreads = 1;
+
+	ranges.reset(new Range[numThreads]);
+	for (size_t i = 0; i < numThreads; i++)
+		ranges[i].bounds.store(0);
+
+	// the calling thread is thread 0
+	for (size_t i = 1; i < numThreads; i++)
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	startCondition.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+/**
+ * Number of threads running each loop, including the caller.
+ */
+size_t ThreadPool::size() const { return numThreads; }
+
+/**
+ * Call task(context, i) for every i in [0, count), spread across the
+ * pool, and return once every call has finished.
+ */
+void ThreadPool::parallelFor(size_t count, void (*loopTask)(void*, size_t), void* loopContext)
+{
+	std::lock_guard<std::mutex> loopLock(loopMutex);
+	for (size_t start = 0; start < count;)
+	{
+		// ranges hold 32-bit indices, so very long loops run in blocks
+		size_t blockSize = count - start < UINT32_MAX ? count - start : UINT32_MAX;
+		for (size_t i = 0; i < numThreads; i++)
+		{
+			uint32_t begin = (uint32_t)(blockSize * i / numThreads);
+			uint32_t end = (uint32_t)(blockSize * (i + 1) / numThreads);
+			ranges[i].bounds.store(packRange(begin, end), std::memory_order_relaxed);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			task = loopTask;
+			context = loopContext;
+			offset = start;
+			remaining.store(blockSize);
+			generation++;
+		}
+		startCondition.notify_all();
+
+		runLoop(0);
+
+		// wait for the last calls to finish and every worker to leave the
+		// loop, since the ranges are reused by the next one
+		std::unique_lock<std::mutex> lock(mutex);
+		doneCondition.wait(lock, [this]() { return remaining.load() == 0 && active == 0; });
+		start += blockSize;
+	}
+}
+
+/**
+ * Wait for each loop to start and help run it, until the pool is
+ * destroyed.
+ */
+void ThreadPool::workerLoop(size_t id)
+{
+	uint64_t seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+			// a loop that's already finished may be replaced at any time
+			if (remaining.load() == 0)
+				continue;
+			active++;
+		}
+
+		runLoop(id);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			active--;
+		}
+		doneCondition.notify_all();
+	}
+}
+
+/**
+ * Run the current loop's indices from the given thread's range, then
+ * from other threads' ranges, until none are left.
+ */
+void ThreadPool::runLoop(size_t id)
+{
+	uint32_t index;
+	while (takeIndex(id, index) || stealIndex(id, index))
+	{
+		task(context, offset + index);
+		if (remaining.fetch_sub(1) == 1)
+		{
+			// take the lock so the caller can't miss the notification
+			std::lock_guard<std::mutex> lock(mutex);
+			doneCondition.notify_all();
+		}
+	}
+}
+
+/**
+ * Take the first index from the given thread's range.
+ */
+bool ThreadPool::takeIndex(size_t id, uint32_t& index)
+{
+	std::atomic<uint64_t>& bounds = ranges[id].bounds;
+	uint64_t current = bounds.load(std::memory_order_relaxed);
+	while (rangeBegin(current) < rangeEnd(current))
+	{
+		if (bounds.compare_exchange_weak(current, packRange(rangeBegin(current) + 1, rangeEnd(current))))
+		{
+			index = rangeBegin(current);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Steal the back half of another thread's range, keeping its first
+ * index to run now and the rest in the given thread's (empty) range.
+ */
+bool ThreadPool::stealIndex(size_t id, uint32_t& index)
+{
+	for (size_t i = 1; i < numThreads; i++)
+	{
+		std::atomic<uint64_t>& bounds = ranges[(id + i) % numThreads].bounds;
+		uint64_t current = bounds.load(std::memory_order_relaxed);
+		while (rangeBegin(current) < rangeEnd(current))
+		{
+			uint32_t begin = rangeBegin(current);
+			uint32_t end = rangeEnd(current);
+			uint32_t middle = begin + (end - begin) / 2;
+			if (bounds.compare_exchange_weak(current, packRange(begin, middle)))
+			{
+				index = middle;
+				ranges[id].bounds.store(packRange(middle + 1, end));
+				return true;
+			}
+		}
+	}
+	return false;
+}
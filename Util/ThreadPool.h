@@ -0,0 +1,98 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+	/**
+	 * This class runs loops across a fixed set of threads.
+	 *
+	 * Each loop's indices are split evenly between the threads (the
+	 * calling thread included). A thread takes indices from the front of
+	 * its own range, and once that's empty, steals the back half of
+	 * another thread's range, so uneven work evens itself out. Taking
+	 * and stealing are single compare-and-swaps on each range, so no
+	 * locks are held while the loop runs.
+	 */
+
+public:
+	/**
+	 * Create a pool of the given number of threads, counting the thread
+	 * that calls parallelFor. Zero uses one per hardware thread.
+	 */
+	explicit ThreadPool(size_t numThreads = 0);
+	~ThreadPool();
+
+	/**
+	 * Number of threads running each loop, including the caller.
+	 */
+	size_t size() const;
+
+	/**
+	 * Call task(context, i) for every i in [0, count), spread across the
+	 * pool, and return once every call has finished.
+	 *
+	 * Only one loop runs at a time; other callers wait their turn.
+	 */
+	void parallelFor(size_t count, void (*task)(void*, size_t), void* context);
+
+	/**
+	 * Call function(i) for every i in [0, count), spread across the pool.
+	 */
+	template <typename Function>
+	void parallelFor(size_t count, const Function& function)
+	{
+		parallelFor(count, &callFunction<Function>, (void*)&function);
+	}
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	template <typename Function>
+	static void callFunction(void* function, size_t i) { (*(const Function*)function)(i); }
+
+	/**
+	 * The indices left in one thread's range, packed as the first
+	 * index in the high 32 bits and one past the last in the low 32,
+	 * padded so each range is on its own cache line.
+	 */
+	struct Range
+	{
+		std::atomic<uint64_t> bounds;
+		char padding[64 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	void workerLoop(size_t id);
+	void runLoop(size_t id);
+	bool takeIndex(size_t id, uint32_t& index);
+	bool stealIndex(size_t id, uint32_t& index);
+
+	size_t numThreads;
+	std::vector<std::thread> workers;
+	std::unique_ptr<Range[]> ranges;
+
+	// the loop being run, offset to allow more than 2^32 indices
+	void (*task)(void*, size_t);
+	void* context;
+	size_t offset;
+	std::atomic<size_t> remaining;
+
+	std::mutex loopMutex;
+	std::mutex mutex;
+	std::condition_variable startCondition;
+	std::condition_variable doneCondition;
+	uint64_t generation;
+	size_t active;
+	bool stopping;
+};
+
+#endif
@@ -2,18 +2,32 @@
 #define UTIL_H
 
 #include <stdint.h>
-#include <cmath>
 
 /**
 * Right shift source by the specified number of bits
 * with wrap around.
+*
+* Defined here so every turn inlines it (the web build has no link
+* time optimization to do that across files).
 */
-uint64_t rotateRight(uint64_t source, uint64_t bits);
+inline uint64_t rotateRight(uint64_t source, uint64_t bits)
+{
+	bits &= 63;
+	if (bits == 0)
+		return source;
+	return (source >> bits) | (source << (64 - bits));
+}
 
 /**
 * Left shift source by the specified number of bits
 * with wrap around.
 */
-uint64_t rotateLeft(uint64_t source, uint64_t bits);
+inline uint64_t rotateLeft(uint64_t source, uint64_t bits)
+{
+	bits &= 63;
+	if (bits == 0)
+		return source;
+	return (source << bits) | (source >> (64 - bits));
+}
 
 #endif
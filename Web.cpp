@@ -2,31 +2,176 @@
  * Module to bind with embind, following this tutorial
  * https://emscripten.org/docs/porting/connecting_cpp_and_javascript/embind.html
 */
-#include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 #include <emscripten/bind.h>
+#include <emscripten/val.h>
 
+#include "Batch.h"
+#include "Oracle.h"
+#include "Session.h"
 #include "Solver.h"
 
 using namespace emscripten;
 
-Cube c;
-std::vector<Move> solution;
-
 /**
  * Function to compile to web assembly for use by web-based Rubik's Cube.
- * 
+ *
  * Takes in a string representation of a cube and returns a move sequence
  * that solves that cube state.
 */
 std::string getSolution(std::string state)
 {
-    c.copyState(state);
-    solution = solve(c);
-    solution = cleanSolution(solution, true);
-    return solutionToString(solution);
+    Cube cube;
+    cube.copyState(state);
+    Solution solution = solve(cube, SolveOptions());
+    return solutionToString(solution.toMoves());
+}
+
+/**
+ * Takes in a move sequence and returns the string representation of the
+ * cube it leaves, for setting up cubes to solve.
+*/
+std::string getScrambledState(std::string moves)
+{
+    Cube cube;
+    cube.readMoves(moves);
+    std::string state;
+    cube.writeState(state);
+    return state;
+}
+
+/**
+ * Takes in a string representation of a cube and returns its packed
+ * state (see packState) as a Uint8Array, to fill a batch with.
+*/
+val getPackedState(std::string state)
+{
+    Cube cube;
+    cube.copyState(state);
+    uint8_t bytes[PACKED_STATE_BYTES];
+    packState(cube, bytes);
+    return val::global("Uint8Array").new_(typed_memory_view(PACKED_STATE_BYTES, bytes));
 }
 
+class BatchSolver
+{
+    /**
+     * This class solves batches of cubes for web-based callers: solve
+     * takes a Uint8Array of packed states (PACKED_STATE_BYTES each, see
+     * packState) and returns a Uint8Array of their solutions in the
+     * batch wire format (see packBatch), so a whole batch crosses into
+     * and out of the module as one copy each way, with no strings.
+     *
+     * Built with pthreads (make web-threads), each batch is spread
+     * across a pool of web workers that lives as long as the solver.
+     * The calling thread joins in and waits for the others, so it's best
+     * called from a worker rather than the page's main thread.
+     */
+
+public:
+    BatchSolver()
+    {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        pool.reset(new ThreadPool());
+#endif
+    }
+
+    val solve(val states)
+    {
+        size_t size = states["length"].as<size_t>();
+        input.resize(size);
+        val(typed_memory_view(size, input.data())).call<void>("set", states);
+
+        output.clear();
+        solvePacked(input.data(), size / PACKED_STATE_BYTES, SolveOptions(), pool.get(), output);
+        return val::global("Uint8Array").new_(typed_memory_view(output.size(), output.data()));
+    }
+
+private:
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    std::unique_ptr<ThreadPool> pool;
+};
+
+class Session
+{
+    /**
+     * This class keeps a cube in sync with a web-based cube as it's
+     * turned (see SolverSession), so each move is sent as it's made
+     * rather than the whole state, and a solution or hint for a cube
+     * that's on or near the last solution's path is found without
+     * solving it again.
+     */
+
+public:
+    void apply(std::string moves) { session.apply(moves); }
+
+    void setState(std::string state)
+    {
+        Cube cube;
+        cube.copyState(state);
+        session.setState(cube);
+    }
+
+    std::string getSolution() { return solutionToString(session.solve().toMoves()); }
+
+    std::string getHint()
+    {
+        Move hint = session.hint();
+        return hint.type == Move::TYPE::NO_MOVE ? "" : hint.toString();
+    }
+
+private:
+    SolverSession session;
+};
+
+class Hints
+{
+    /**
+     * This class gives hints for a web-based cube as it's turned (see
+     * HintOracle), as an object with the phase's name, the cross
+     * distance, pairs left, lower bound, estimate of the moves left and
+     * the next move ("" once solved).
+     */
+
+public:
+    val hint(std::string state)
+    {
+        Cube cube;
+        cube.copyState(state);
+        Hint hint = oracle.hint(cube);
+        val result = val::object();
+        const char* phases[] = { "Cross", "F2L", "OLL", "PLL" };
+        result.set("phase", std::string(phases[(uint8_t)hint.phase]));
+        result.set("crossDistance", hint.crossDistance);
+        result.set("pairsLeft", hint.pairsLeft);
+        result.set("lowerBound", hint.lowerBound);
+        result.set("estimate", hint.estimate);
+        result.set("next", hint.next.type == Move::TYPE::NO_MOVE ? std::string() : hint.next.toString());
+        return result;
+    }
+
+private:
+    HintOracle oracle;
+};
+
 EMSCRIPTEN_BINDINGS(my_module) {
     function("getSolution", &getSolution);
+    function("getScrambledState", &getScrambledState);
+    function("getPackedState", &getPackedState);
+    constant("PACKED_STATE_BYTES", PACKED_STATE_BYTES);
+    class_<BatchSolver>("BatchSolver")
+        .constructor<>()
+        .function("solve", &BatchSolver::solve);
+    class_<Session>("Session")
+        .constructor<>()
+        .function("apply", &Session::apply)
+        .function("setState", &Session::setState)
+        .function("getSolution", &Session::getSolution)
+        .function("getHint", &Session::getHint);
+    class_<Hints>("HintOracle")
+        .constructor<>()
+        .function("hint", &Hints::hint);
 }
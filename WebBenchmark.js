@@ -0,0 +1,46 @@
+/**
+ * Headless benchmark of the web build: run `make web` (or `make web-threads`), then
+ * `node WebBenchmark.js [cubes]` from the same directory.
+ *
+ * Solves the same random cubes through getSolution, one state string at a time, and
+ * through a BatchSolver, as one typed array of packed states, and reports how many cubes
+ * each solves per second. `cube-solver --bench-web` runs the same comparison natively.
+ */
+const Module = require('./cube-solver.js');
+
+const MOVES = ['U', "U'", 'U2', 'D', "D'", 'D2', 'F', "F'", 'F2', 'B', "B'", 'B2', 'R', "R'", 'R2', 'L', "L'", 'L2'];
+
+function generateScramble() {
+    const moves = [];
+    for (let i = 0; i < 25; i++)
+        moves.push(MOVES[Math.floor(Math.random() * MOVES.length)]);
+    return moves.join(' ');
+}
+
+Module.onRuntimeInitialized = () => {
+    const numCubes = parseInt(process.argv[2] || '2000', 10);
+    const states = [];
+    const packed = new Uint8Array(numCubes * Module.PACKED_STATE_BYTES);
+    for (let i = 0; i < numCubes; i++) {
+        states.push(Module.getScrambledState(generateScramble()));
+        packed.set(Module.getPackedState(states[i]), i * Module.PACKED_STATE_BYTES);
+    }
+
+    // the first solve builds the solver's tables, so it isn't timed
+    Module.getSolution(states[0]);
+
+    let start = performance.now();
+    for (const state of states)
+        Module.getSolution(state);
+    const single = numCubes / ((performance.now() - start) / 1000);
+
+    const solver = new Module.BatchSolver();
+    start = performance.now();
+    const solutions = solver.solve(packed);
+    const batch = numCubes / ((performance.now() - start) / 1000);
+    solver.delete();
+
+    console.log(`getSolution: ${Math.round(single)} solves/s`);
+    console.log(`BatchSolver: ${Math.round(batch)} solves/s (${(batch / single).toFixed(2)}x, ` +
+        `${solutions.length} bytes of packed solutions)`);
+};